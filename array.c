@@ -4,21 +4,19 @@
 #include <assert.h>
 #include <memory.h>
 #include <stdlib.h>
+#include <windows.h>
 
 #include "memorypool.h"
 
 // structure for the array
 struct array
 {
-  int m_elemsize;             // the size of each element in the vector
-  int m_count;                // the number of elements in the vector
-  struct memorypool *m_pool;  // the memory allocator
-  void *m_data;               // a pointer to the array data
+  ARRAY_FIELDS(void)
 };
   
 
 // allocate a new array
-struct array *_array_alloc(int a_elemsize, int a_count, struct memorypool *a_pool, const char *a_file, int a_line)
+struct array *_array_alloc(size_t a_elemsize, size_t a_count, struct memorypool *a_pool, const char *a_file, int a_line)
 {
   // locals
   struct array *ptr;
@@ -35,11 +33,13 @@ struct array *_array_alloc(int a_elemsize, int a_count, struct memorypool *a_poo
   ptr->m_count = a_count;
   ptr->m_pool = a_pool;
   ptr->m_data = 0;
+  ptr->m_mapping = 0;
+  ptr->m_mapped = 0;
 
   // allocate the array data
-  if (a_elemsize * a_count > 0)
+  if (a_count > 0)
   {
-    ptr->m_data = _palloc(a_file, a_line, a_pool, a_elemsize * a_count);
+    ptr->m_data = _palloc(a_file, a_line, a_pool, psize(a_elemsize, a_count));
     assert(ptr->m_data);
   }
 
@@ -48,32 +48,133 @@ struct array *_array_alloc(int a_elemsize, int a_count, struct memorypool *a_poo
 }
 
 
+// map a file into memory as an array
+struct array *_array_map_file(const char *a_path, size_t a_elemsize, int a_flags, struct memorypool *a_pool, const char *a_file, int a_line)
+{
+  // locals
+  struct array *ptr;
+  HANDLE file, mapping;
+  LARGE_INTEGER size;
+  DWORD attributes, protect, access;
+  void *view;
+
+  // checks
+  assert(a_path);
+  assert(a_elemsize > 0);
+
+  // the access hints are given to the cache manager when the file is opened
+  attributes = FILE_ATTRIBUTE_NORMAL;
+  if (a_flags & ARRAY_MAP_SEQUENTIAL)
+  {
+    attributes |= FILE_FLAG_SEQUENTIAL_SCAN;
+  }
+  else if (a_flags & ARRAY_MAP_RANDOM)
+  {
+    attributes |= FILE_FLAG_RANDOM_ACCESS;
+  }
+
+  file = CreateFileA(a_path, GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, attributes, 0);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    return 0;
+  }
+
+  // the whole file must fit in the address space, and be a whole number of elements
+  if (!GetFileSizeEx(file, &size) || (uint64) size.QuadPart > (size_t) ~0 || (size_t) size.QuadPart % a_elemsize)
+  {
+    CloseHandle(file);
+    return 0;
+  }
+
+  mapping = 0;
+  view = 0;
+
+  // an empty file can not be mapped, so it is an empty array
+  if (size.QuadPart > 0)
+  {
+    protect = (a_flags & ARRAY_MAP_COPYONWRITE) ? PAGE_WRITECOPY : PAGE_READONLY;
+    access = (a_flags & ARRAY_MAP_COPYONWRITE) ? FILE_MAP_COPY : FILE_MAP_READ;
+
+    mapping = CreateFileMappingA(file, 0, protect, 0, 0, 0);
+    if (mapping)
+    {
+      view = MapViewOfFile(mapping, access, 0, 0, 0);
+    }
+
+    if (!view)
+    {
+      if (mapping)
+      {
+        CloseHandle(mapping);
+      }
+
+      CloseHandle(file);
+      return 0;
+    }
+  }
+
+  // the mapping keeps the file open
+  CloseHandle(file);
+
+  // allocate the array structure memory
+  ptr = (struct array *) _palloc(a_file, a_line, a_pool, sizeof(struct array));
+  assert(ptr);
+
+  ptr->m_elemsize = a_elemsize;
+  ptr->m_count = (size_t) size.QuadPart / a_elemsize;
+  ptr->m_pool = a_pool;
+  ptr->m_data = view;
+  ptr->m_mapping = mapping;
+  ptr->m_mapped = 1;
+
+  // return a pointer to the array
+  return ptr;
+}
+
+
 // free an array
 void array_free(struct array *a_array)
 {
   // checks
   assert(a_array);
 
-  // free the data and the array
-  pfree(a_array->m_pool, a_array->m_data);
+  // unmap the data if it is mapped from a file, otherwise free it. an empty file has no mapping.
+  if (a_array->m_mapped)
+  {
+    if (a_array->m_mapping)
+    {
+      UnmapViewOfFile(a_array->m_data);
+      CloseHandle((HANDLE) a_array->m_mapping);
+    }
+  }
+  else if (a_array->m_data)
+  {
+    pfree(a_array->m_pool, a_array->m_data);
+  }
+
+  // free the array
   pfree(a_array->m_pool, a_array);
 }
 
 
 // resize the array memory
-void _array_resize(struct array *a_array, int a_count, const char *a_file, int a_line)
+void _array_resize(struct array *a_array, size_t a_count, const char *a_file, int a_line)
 {
   // locals
   void *ptr;
   
   // checks
   assert(a_array);
+  assert(!a_array->m_mapped);
 
   // check the new size of the array
   if (a_count == 0)
   {
     // if the size is 0 then free the current data
-    pfree(a_array->m_pool, a_array->m_data);
+    if (a_array->m_data)
+    {
+      pfree(a_array->m_pool, a_array->m_data);
+    }
 
     // set the data and count to 0
     a_array->m_data = 0;
@@ -82,7 +183,7 @@ void _array_resize(struct array *a_array, int a_count, const char *a_file, int a
   else
   {
     // if the size is not 0 then reallocate the memory
-    ptr = _prealloc(a_file, a_line, a_array->m_pool, a_array->m_data, a_array->m_elemsize * a_count);
+    ptr = _prealloc(a_file, a_line, a_array->m_pool, a_array->m_data, psize(a_array->m_elemsize, a_count));
     assert(ptr);
 
     // store the count and a pointer to the new data
@@ -115,7 +216,7 @@ void *array_data(struct array *a_array)
 
 
 // get a pointer to an element in the array
-void *array_index(struct array *a_array, int a_index)
+void *array_index(struct array *a_array, size_t a_index)
 {
   // locals
   char *ptr;
@@ -131,7 +232,7 @@ void *array_index(struct array *a_array, int a_index)
 
 
 // get the number of elements in the array
-int array_count(struct array *a_array)
+size_t array_count(struct array *a_array)
 {
   // checks
   assert(a_array);
@@ -142,7 +243,7 @@ int array_count(struct array *a_array)
 
 
 // get the size of each element in the array
-int array_elemsize(struct array *a_array)
+size_t array_elemsize(struct array *a_array)
 {
   // checks
   assert(a_array);
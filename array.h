@@ -8,10 +8,90 @@ extern "C" {
 
 #include "config.h"
 
+#include <assert.h>
+
 // forward declarations
 typedef struct array;
 typedef struct memorypool;
 
+// the fields of an array, which are shared by struct array and the typed arrays from ARRAY_DEFINE
+// a_type the element type
+#define ARRAY_FIELDS(a_type) \
+  size_t m_elemsize;          /* the size of each element in the array */ \
+  size_t m_count;             /* the number of elements in the array */ \
+  struct memorypool *m_pool;  /* the memory allocator */ \
+  a_type *m_data;             /* a pointer to the array data */ \
+  void *m_mapping;            /* the file mapping if the data is mapped from a file, otherwise 0 */ \
+  int m_mapped;               /* set if the array was made by array_map_file, even for an empty file */
+
+// declare a typed array, with inline functions that access the elements with the size of the type
+// known at compile time. the typed array is a struct array and can be used with the array functions
+// through a_name_array. allocations made through a_name_alloc are tracked against this line.
+// a_name the name of the typed array struct, and the prefix for its functions
+// a_type the element type
+#define ARRAY_DEFINE(a_name, a_type) \
+  struct a_name { ARRAY_FIELDS(a_type) }; \
+  \
+  static inline struct a_name *a_name##_alloc(size_t a_count, struct memorypool *a_pool) \
+  { \
+    return (struct a_name *) _array_alloc(sizeof(a_type), a_count, a_pool, __FILE__, __LINE__); \
+  } \
+  \
+  static inline void a_name##_free(struct a_name *a_array) \
+  { \
+    _array_free((struct array *) a_array); \
+  } \
+  \
+  static inline void a_name##_resize(struct a_name *a_array, size_t a_count) \
+  { \
+    _array_resize((struct array *) a_array, a_count, __FILE__, __LINE__); \
+  } \
+  \
+  static inline struct a_name *a_name##_cast(struct array *a_array) \
+  { \
+    assert(_array_elemsize(a_array) == sizeof(a_type)); \
+    return (struct a_name *) a_array; \
+  } \
+  \
+  static inline struct array *a_name##_array(struct a_name *a_array) \
+  { \
+    return (struct array *) a_array; \
+  } \
+  \
+  static inline size_t a_name##_count(struct a_name *a_array) \
+  { \
+    return a_array->m_count; \
+  } \
+  \
+  static inline a_type *a_name##_data(struct a_name *a_array) \
+  { \
+    return a_array->m_data; \
+  } \
+  \
+  static inline a_type *a_name##_index(struct a_name *a_array, size_t a_index) \
+  { \
+    assert(a_index < a_array->m_count); \
+    return a_array->m_data + a_index; \
+  } \
+  \
+  static inline a_type a_name##_get(struct a_name *a_array, size_t a_index) \
+  { \
+    assert(a_index < a_array->m_count); \
+    return a_array->m_data[a_index]; \
+  } \
+  \
+  static inline void a_name##_set(struct a_name *a_array, size_t a_index, a_type a_value) \
+  { \
+    assert(a_index < a_array->m_count); \
+    a_array->m_data[a_index] = a_value; \
+  }
+
+// flags for array_map_file
+#define ARRAY_MAP_READONLY      0x00  // the data is read only, writing to it is an access violation
+#define ARRAY_MAP_COPYONWRITE   0x01  // the data can be written, but changes are private and not written to the file
+#define ARRAY_MAP_SEQUENTIAL    0x02  // the data will be read from start to end, so the system reads ahead
+#define ARRAY_MAP_RANDOM        0x04  // the data will be read in a random order, so the system does not read ahead
+
 // allocate a new array
 // a_elemsize the size of each element in the array
 // a_count the number of elements to allocate
@@ -19,6 +99,17 @@ typedef struct memorypool;
 // returns the newly allocated array
 #define array_alloc(a_elemsize, a_count, a_pool) _array_alloc(a_elemsize, a_count, a_pool, __FILE__, __LINE__)
 
+// map a file into memory as an array, so large read only tables can be used without reading them in.
+// the pages are loaded on first access and are shared with any other process that maps the same file.
+// the array can not be resized, and is unmapped by array_free.
+// a_path the path of the file to map
+// a_elemsize the size of each element in the array, the count is the file size divided by this
+// a_flags a combination of the ARRAY_MAP_ flags
+// a_pool the memory pool to allocate the array structure from
+// returns the newly allocated array, or 0 if the file could not be mapped or its size is not a whole
+// number of elements
+#define array_map_file(a_path, a_elemsize, a_flags, a_pool) _array_map_file(a_path, a_elemsize, a_flags, a_pool, __FILE__, __LINE__)
+
 // free the array and all allocated memory
 // a_array the array to operate on
 #define array_free(a_array) _array_free(a_array)
@@ -54,14 +145,15 @@ typedef struct memorypool;
 #define array_index(a_array, a_index) _array_index(a_array, a_index)
 
 // interface functions
-struct array *_array_alloc(int a_elemsize, int a_count, struct memorypool *a_pool, const char *a_file, int a_line);
+struct array *_array_alloc(size_t a_elemsize, size_t a_count, struct memorypool *a_pool, const char *a_file, int a_line);
+struct array *_array_map_file(const char *a_path, size_t a_elemsize, int a_flags, struct memorypool *a_pool, const char *a_file, int a_line);
 void _array_free(struct array *a_array);
-void _array_resize(struct array *a_array, int a_count, const char *a_file, int a_line);
-int _array_count(struct array *a_array);
-int _array_elemsize(struct array *a_array);
+void _array_resize(struct array *a_array, size_t a_count, const char *a_file, int a_line);
+size_t _array_count(struct array *a_array);
+size_t _array_elemsize(struct array *a_array);
 void _array_zero(struct array *a_array);
 void *_array_data(struct array *a_array);
-void *_array_index(struct array *a_array, int a_index);
+void *_array_index(struct array *a_array, size_t a_index);
 
 #ifdef  __cplusplus
 }
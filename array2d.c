@@ -0,0 +1,368 @@
+
+#include "array2d.h"
+
+#include <assert.h>
+#include <emmintrin.h>
+#include <memory.h>
+#include <stdlib.h>
+
+#include "cpu.h"
+#include "memorypool.h"
+#include "threadpool.h"
+
+// structure for the 2d array
+struct array2d
+{
+  int m_rows;                 // the number of rows
+  int m_cols;                 // the number of columns
+  int m_elemsize;             // the size of each element
+  int m_layout;               // the layout of the elements
+  int m_tilerows;             // the number of rows of tiles
+  int m_tilecols;             // the number of columns of tiles
+  char *m_data;               // the elements, which are padded to whole tiles in the tiled layout
+  struct memorypool *m_pool;  // the memory allocator
+};
+
+// the arrays for a tiled copy or transpose, which is split into a job for each row of tiles
+struct array2d_job
+{
+  struct array2d *m_dst;      // the array to write to
+  struct array2d *m_src;      // the array to read from
+};
+
+
+size_t __array2d_size(struct array2d *a_array);
+void __array2d_copy_row(void *a_context, int a_index);
+void __array2d_transpose_row(void *a_context, int a_index);
+void __array2d_transpose_tile(const struct array2d_tile *a_src, const struct array2d_tile *a_dst, int a_sse2);
+
+
+// allocate a new 2d array
+struct array2d *_array2d_alloc(int a_rows, int a_cols, int a_elemsize, int a_layout, struct memorypool *a_pool, const char *a_file, int a_line)
+{
+  // locals
+  struct array2d *ptr;
+  size_t size;
+
+  // checks
+  assert(a_rows >= 0 && a_cols >= 0);
+  assert(a_elemsize > 0);
+  assert(a_layout == ARRAY2D_ROWMAJOR || a_layout == ARRAY2D_TILED);
+
+  // allocate the 2d array structure memory
+  ptr = (struct array2d *) _palloc(a_file, a_line, a_pool, sizeof(struct array2d));
+  assert(ptr);
+
+  ptr->m_rows = a_rows;
+  ptr->m_cols = a_cols;
+  ptr->m_elemsize = a_elemsize;
+  ptr->m_layout = a_layout;
+  ptr->m_tilerows = (a_rows + ARRAY2D_TILE - 1) / ARRAY2D_TILE;
+  ptr->m_tilecols = (a_cols + ARRAY2D_TILE - 1) / ARRAY2D_TILE;
+  ptr->m_pool = a_pool;
+  ptr->m_data = 0;
+
+  size = __array2d_size(ptr);
+
+  if (size > 0)
+  {
+    ptr->m_data = (char *) _palloc(a_file, a_line, a_pool, size);
+    assert(ptr->m_data);
+
+    memset(ptr->m_data, 0, size);
+  }
+
+  // return a pointer to the 2d array
+  return ptr;
+}
+
+
+// free a 2d array
+void _array2d_free(struct array2d *a_array)
+{
+  // checks
+  assert(a_array);
+
+  if (a_array->m_data)
+  {
+    pfree(a_array->m_pool, a_array->m_data);
+  }
+
+  pfree(a_array->m_pool, a_array);
+}
+
+
+// get the number of rows
+int _array2d_rows(struct array2d *a_array)
+{
+  // checks
+  assert(a_array);
+
+  return a_array->m_rows;
+}
+
+
+// get the number of columns
+int _array2d_cols(struct array2d *a_array)
+{
+  // checks
+  assert(a_array);
+
+  return a_array->m_cols;
+}
+
+
+// get the size of each element
+int _array2d_elemsize(struct array2d *a_array)
+{
+  // checks
+  assert(a_array);
+
+  return a_array->m_elemsize;
+}
+
+
+// get the layout of the elements
+int _array2d_layout(struct array2d *a_array)
+{
+  // checks
+  assert(a_array);
+
+  return a_array->m_layout;
+}
+
+
+// get a pointer to an element
+void *_array2d_index(struct array2d *a_array, int a_row, int a_col)
+{
+  // locals
+  size_t tile;
+
+  // checks
+  assert(a_array);
+  assert(a_row >= 0 && a_row < a_array->m_rows);
+  assert(a_col >= 0 && a_col < a_array->m_cols);
+
+  if (a_array->m_layout == ARRAY2D_ROWMAJOR)
+  {
+    return a_array->m_data + ((size_t) a_row * a_array->m_cols + a_col) * a_array->m_elemsize;
+  }
+
+  tile = (size_t) (a_row / ARRAY2D_TILE) * a_array->m_tilecols + (a_col / ARRAY2D_TILE);
+  return a_array->m_data + ((tile * ARRAY2D_TILE + (a_row % ARRAY2D_TILE)) * ARRAY2D_TILE + (a_col % ARRAY2D_TILE)) * a_array->m_elemsize;
+}
+
+
+// get the number of rows of tiles
+int _array2d_tile_rows(struct array2d *a_array)
+{
+  // checks
+  assert(a_array);
+
+  return a_array->m_tilerows;
+}
+
+
+// get the number of columns of tiles
+int _array2d_tile_cols(struct array2d *a_array)
+{
+  // checks
+  assert(a_array);
+
+  return a_array->m_tilecols;
+}
+
+
+// get a tile
+void _array2d_tile(struct array2d *a_array, int a_tilerow, int a_tilecol, struct array2d_tile *a_tile)
+{
+  // checks
+  assert(a_array);
+  assert(a_tile);
+  assert(a_tilerow >= 0 && a_tilerow < a_array->m_tilerows);
+  assert(a_tilecol >= 0 && a_tilecol < a_array->m_tilecols);
+
+  a_tile->m_row = a_tilerow * ARRAY2D_TILE;
+  a_tile->m_col = a_tilecol * ARRAY2D_TILE;
+  a_tile->m_rows = min(ARRAY2D_TILE, a_array->m_rows - a_tile->m_row);
+  a_tile->m_cols = min(ARRAY2D_TILE, a_array->m_cols - a_tile->m_col);
+  a_tile->m_elemsize = a_array->m_elemsize;
+  a_tile->m_base = (char *) _array2d_index(a_array, a_tile->m_row, a_tile->m_col);
+  a_tile->m_stride = (size_t) a_array->m_elemsize * ((a_array->m_layout == ARRAY2D_ROWMAJOR) ? a_array->m_cols : ARRAY2D_TILE);
+}
+
+
+// copy the elements of a 2d array to another
+void _array2d_copy(struct array2d *a_dst, struct array2d *a_src)
+{
+  // locals
+  struct array2d_job job;
+
+  // checks
+  assert(a_dst);
+  assert(a_src);
+  assert(a_dst->m_rows == a_src->m_rows && a_dst->m_cols == a_src->m_cols);
+  assert(a_dst->m_elemsize == a_src->m_elemsize);
+
+  // the same layouts are the same bytes
+  if (a_dst->m_layout == a_src->m_layout)
+  {
+    if (a_src->m_data)
+    {
+      memcpy(a_dst->m_data, a_src->m_data, __array2d_size(a_src));
+    }
+
+    return;
+  }
+
+  // otherwise copy a tile at a time, with each row of tiles on a thread
+  job.m_dst = a_dst;
+  job.m_src = a_src;
+
+  threadpool_run(0, __array2d_copy_row, &job, a_src->m_tilerows);
+}
+
+
+// transpose a 2d array into another
+void _array2d_transpose(struct array2d *a_dst, struct array2d *a_src)
+{
+  // locals
+  struct array2d_job job;
+
+  // checks
+  assert(a_dst);
+  assert(a_src);
+  assert(a_dst != a_src);
+  assert(a_dst->m_rows == a_src->m_cols && a_dst->m_cols == a_src->m_rows);
+  assert(a_dst->m_elemsize == a_src->m_elemsize);
+
+  // each row of tiles of the source is a column of tiles of the destination
+  job.m_dst = a_dst;
+  job.m_src = a_src;
+
+  threadpool_run(0, __array2d_transpose_row, &job, a_src->m_tilerows);
+}
+
+
+// get the number of bytes of elements, where the tiled layout holds whole tiles at the edges
+size_t __array2d_size(struct array2d *a_array)
+{
+  if (a_array->m_layout == ARRAY2D_TILED)
+  {
+    return psize(psize(a_array->m_tilerows, a_array->m_tilecols), ARRAY2D_TILE * ARRAY2D_TILE * a_array->m_elemsize);
+  }
+
+  return psize(psize(a_array->m_rows, a_array->m_cols), a_array->m_elemsize);
+}
+
+
+// copy a row of tiles
+void __array2d_copy_row(void *a_context, int a_index)
+{
+  // locals
+  struct array2d_job *job;
+  struct array2d_tile src, dst;
+  int i, row;
+
+  job = (struct array2d_job *) a_context;
+
+  for (i = 0; i < job->m_src->m_tilecols; i++)
+  {
+    _array2d_tile(job->m_src, a_index, i, &src);
+    _array2d_tile(job->m_dst, a_index, i, &dst);
+
+    for (row = 0; row < src.m_rows; row++)
+    {
+      memcpy(array2d_tile_index(&dst, row, 0), array2d_tile_index(&src, row, 0), src.m_cols * src.m_elemsize);
+    }
+  }
+}
+
+
+// transpose a row of tiles into a column of tiles
+void __array2d_transpose_row(void *a_context, int a_index)
+{
+  // locals
+  struct array2d_job *job;
+  struct array2d_tile src, dst;
+  int i, sse2;
+
+  job = (struct array2d_job *) a_context;
+  sse2 = (cpu_features() & CPU_SSE2) != 0;
+
+  for (i = 0; i < job->m_src->m_tilecols; i++)
+  {
+    _array2d_tile(job->m_src, a_index, i, &src);
+    _array2d_tile(job->m_dst, i, a_index, &dst);
+
+    __array2d_transpose_tile(&src, &dst, sse2);
+  }
+}
+
+
+// transpose one tile into another. 4 byte elements are transposed in blocks of 4x4 and 8 byte elements
+// in blocks of 2x2 with sse2, the elements at the edges that do not fill a block are copied one at a time.
+void __array2d_transpose_tile(const struct array2d_tile *a_src, const struct array2d_tile *a_dst, int a_sse2)
+{
+  // locals
+  __m128 row0, row1, row2, row3;
+  __m128d left, right;
+  int row, col, rows, cols;
+
+  rows = 0;
+  cols = 0;
+
+  if (a_sse2 && a_src->m_elemsize == 4)
+  {
+    rows = a_src->m_rows & ~3;
+    cols = a_src->m_cols & ~3;
+
+    for (row = 0; row < rows; row += 4)
+    {
+      for (col = 0; col < cols; col += 4)
+      {
+        row0 = _mm_loadu_ps((const float *) array2d_tile_index(a_src, row, col));
+        row1 = _mm_loadu_ps((const float *) array2d_tile_index(a_src, row + 1, col));
+        row2 = _mm_loadu_ps((const float *) array2d_tile_index(a_src, row + 2, col));
+        row3 = _mm_loadu_ps((const float *) array2d_tile_index(a_src, row + 3, col));
+
+        _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+
+        _mm_storeu_ps((float *) array2d_tile_index(a_dst, col, row), row0);
+        _mm_storeu_ps((float *) array2d_tile_index(a_dst, col + 1, row), row1);
+        _mm_storeu_ps((float *) array2d_tile_index(a_dst, col + 2, row), row2);
+        _mm_storeu_ps((float *) array2d_tile_index(a_dst, col + 3, row), row3);
+      }
+    }
+  }
+  else if (a_sse2 && a_src->m_elemsize == 8)
+  {
+    rows = a_src->m_rows & ~1;
+    cols = a_src->m_cols & ~1;
+
+    for (row = 0; row < rows; row += 2)
+    {
+      for (col = 0; col < cols; col += 2)
+      {
+        left = _mm_loadu_pd((const double *) array2d_tile_index(a_src, row, col));
+        right = _mm_loadu_pd((const double *) array2d_tile_index(a_src, row + 1, col));
+
+        _mm_storeu_pd((double *) array2d_tile_index(a_dst, col, row), _mm_unpacklo_pd(left, right));
+        _mm_storeu_pd((double *) array2d_tile_index(a_dst, col + 1, row), _mm_unpackhi_pd(left, right));
+      }
+    }
+  }
+
+  // the elements that were not in a whole block
+  for (row = 0; row < a_src->m_rows; row++)
+  {
+    for (col = (row < rows) ? cols : 0; col < a_src->m_cols; col++)
+    {
+      memcpy(array2d_tile_index(a_dst, col, row), array2d_tile_index(a_src, row, col), a_src->m_elemsize);
+    }
+  }
+}
+
+
+// -- EOF
+
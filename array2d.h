@@ -0,0 +1,132 @@
+
+#ifndef __h_array2d
+#define __h_array2d
+
+#ifdef  __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "config.h"
+
+// forward declarations
+typedef struct array2d;
+typedef struct memorypool;
+
+// the layouts of the elements in a 2d array
+#define ARRAY2D_ROWMAJOR  0   // each row follows the previous row
+#define ARRAY2D_TILED     1   // each square tile of elements is stored row major, and the tiles follow each other row major
+
+// the number of rows and columns in a tile
+#define ARRAY2D_TILE      16
+
+// a tile of a 2d array, which is the same block of elements for either layout. the rows of a tile in
+// the row major layout are a row of the array apart, while in the tiled layout they are contiguous.
+struct array2d_tile
+{
+  char *m_base;       // a pointer to the first element of the tile
+  int m_row;          // the row of the array that the tile starts at
+  int m_col;          // the column of the array that the tile starts at
+  int m_rows;         // the number of rows in the tile, which is less at the bottom edge of the array
+  int m_cols;         // the number of columns in the tile, which is less at the right edge of the array
+  int m_elemsize;     // the size of each element
+  size_t m_stride;    // the number of bytes between the start of each row
+};
+
+// allocate a new 2d array with all elements zeroed
+// a_rows the number of rows
+// a_cols the number of columns
+// a_elemsize the size of each element
+// a_layout the layout of the elements, ARRAY2D_ROWMAJOR or ARRAY2D_TILED
+// a_pool the memory pool to allocate from
+// returns the newly allocated 2d array
+#define array2d_alloc(a_rows, a_cols, a_elemsize, a_layout, a_pool) _array2d_alloc(a_rows, a_cols, a_elemsize, a_layout, a_pool, __FILE__, __LINE__)
+
+// free the 2d array and all allocated memory
+// a_array the 2d array to operate on
+#define array2d_free(a_array) _array2d_free(a_array)
+
+// get the number of rows
+// a_array the 2d array to operate on
+// returns the number of rows
+#define array2d_rows(a_array) _array2d_rows(a_array)
+
+// get the number of columns
+// a_array the 2d array to operate on
+// returns the number of columns
+#define array2d_cols(a_array) _array2d_cols(a_array)
+
+// get the size of each element
+// a_array the 2d array to operate on
+// returns the element size
+#define array2d_elemsize(a_array) _array2d_elemsize(a_array)
+
+// get the layout of the elements
+// a_array the 2d array to operate on
+// returns ARRAY2D_ROWMAJOR or ARRAY2D_TILED
+#define array2d_layout(a_array) _array2d_layout(a_array)
+
+// gets a pointer to an element
+// a_array the 2d array to operate on
+// a_row the row of the element
+// a_col the column of the element
+// returns a pointer to the element
+#define array2d_index(a_array, a_row, a_col) _array2d_index(a_array, a_row, a_col)
+
+// get the number of rows of tiles
+// a_array the 2d array to operate on
+// returns the number of rows of tiles
+#define array2d_tile_rows(a_array) _array2d_tile_rows(a_array)
+
+// get the number of columns of tiles
+// a_array the 2d array to operate on
+// returns the number of columns of tiles
+#define array2d_tile_cols(a_array) _array2d_tile_cols(a_array)
+
+// get a tile, so a pass over the array can work on one cache sized block at a time. passes that visit
+// the tiles in order read the memory in order for the tiled layout.
+// a_array the 2d array to operate on
+// a_tilerow the row of the tile
+// a_tilecol the column of the tile
+// a_tile the tile to set
+#define array2d_tile(a_array, a_tilerow, a_tilecol, a_tile) _array2d_tile(a_array, a_tilerow, a_tilecol, a_tile)
+
+// gets a pointer to an element in a tile
+// a_tile the tile to operate on
+// a_row the row of the element in the tile
+// a_col the column of the element in the tile
+// returns a pointer to the element
+#define array2d_tile_index(a_tile, a_row, a_col) ((a_tile)->m_base + (a_row) * (a_tile)->m_stride + (a_col) * (a_tile)->m_elemsize)
+
+// copy the elements of a 2d array to another of the same size, which may have a different layout
+// a_dst the 2d array to copy to
+// a_src the 2d array to copy from
+#define array2d_copy(a_dst, a_src) _array2d_copy(a_dst, a_src)
+
+// transpose a 2d array into another, a tile at a time so both arrays are read and written in cache
+// sized blocks. 4 and 8 byte elements are transposed in sse2 registers.
+// a_dst the 2d array to write to, which must have as many rows as a_src has columns and the other way around
+// a_src the 2d array to transpose
+#define array2d_transpose(a_dst, a_src) _array2d_transpose(a_dst, a_src)
+
+// interface functions
+struct array2d *_array2d_alloc(int a_rows, int a_cols, int a_elemsize, int a_layout, struct memorypool *a_pool, const char *a_file, int a_line);
+void _array2d_free(struct array2d *a_array);
+int _array2d_rows(struct array2d *a_array);
+int _array2d_cols(struct array2d *a_array);
+int _array2d_elemsize(struct array2d *a_array);
+int _array2d_layout(struct array2d *a_array);
+void *_array2d_index(struct array2d *a_array, int a_row, int a_col);
+int _array2d_tile_rows(struct array2d *a_array);
+int _array2d_tile_cols(struct array2d *a_array);
+void _array2d_tile(struct array2d *a_array, int a_tilerow, int a_tilecol, struct array2d_tile *a_tile);
+void _array2d_copy(struct array2d *a_dst, struct array2d *a_src);
+void _array2d_transpose(struct array2d *a_dst, struct array2d *a_src);
+
+#ifdef  __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __h_array2d
+
+// -- EOF
+
@@ -0,0 +1,1746 @@
+
+#include "arrayops.h"
+
+#include <assert.h>
+#include <emmintrin.h>
+#include <intrin.h>
+#include <memory.h>
+#include <stdlib.h>
+#include <windows.h>
+
+#include "array.h"
+#include "arrayview.h"
+#include "cpu.h"
+
+// avx2 intrinsics are only available from visual studio 2012
+#if defined(_MSC_VER) && (_MSC_VER >= 1700)
+#include <immintrin.h>
+#define ARRAYOPS_AVX2 1
+#else
+#define ARRAYOPS_AVX2 0
+#endif
+
+// the kernels for the bulk operations, selected for the cpu on first use
+struct arrayops
+{
+  void (*m_fill32)(uint32 *a_data, size_t a_count, uint32 a_value);
+  void (*m_fill64)(uint64 *a_data, size_t a_count, uint64 a_value);
+
+  size_t (*m_find_i32)(const int32 *a_data, size_t a_count, int32 a_value);
+  size_t (*m_find_i64)(const int64 *a_data, size_t a_count, int64 a_value);
+  size_t (*m_find_f32)(const float *a_data, size_t a_count, float a_value);
+  size_t (*m_find_f64)(const double *a_data, size_t a_count, double a_value);
+
+  size_t (*m_count_i32)(const int32 *a_data, size_t a_count, int32 a_value);
+  size_t (*m_count_i64)(const int64 *a_data, size_t a_count, int64 a_value);
+  size_t (*m_count_f32)(const float *a_data, size_t a_count, float a_value);
+  size_t (*m_count_f64)(const double *a_data, size_t a_count, double a_value);
+
+  int32 (*m_min_i32)(const int32 *a_data, size_t a_count);
+  int64 (*m_min_i64)(const int64 *a_data, size_t a_count);
+  float (*m_min_f32)(const float *a_data, size_t a_count);
+  double (*m_min_f64)(const double *a_data, size_t a_count);
+
+  int32 (*m_max_i32)(const int32 *a_data, size_t a_count);
+  int64 (*m_max_i64)(const int64 *a_data, size_t a_count);
+  float (*m_max_f32)(const float *a_data, size_t a_count);
+  double (*m_max_f64)(const double *a_data, size_t a_count);
+
+  int64 (*m_sum_i32)(const int32 *a_data, size_t a_count);
+  int64 (*m_sum_i64)(const int64 *a_data, size_t a_count);
+  double (*m_sum_f32)(const float *a_data, size_t a_count);
+  double (*m_sum_f64)(const double *a_data, size_t a_count);
+
+  size_t (*m_compare_i32)(const int32 *a_data, const int32 *a_other, size_t a_count);
+  size_t (*m_compare_i64)(const int64 *a_data, const int64 *a_other, size_t a_count);
+  size_t (*m_compare_f32)(const float *a_data, const float *a_other, size_t a_count);
+  size_t (*m_compare_f64)(const double *a_data, const double *a_other, size_t a_count);
+};
+
+// the number of elements gathered from a view with a stride for each call to a kernel
+#define ARRAYOPS_BLOCK 256
+
+// the number of elements counted by each call to a kernel, as the simd kernels count matches in 32 bit
+// lanes that would wrap on a larger array
+#define ARRAYOPS_COUNT_BLOCK 0x40000000
+
+static struct arrayops g_arrayops;
+static volatile int g_arrayops_ready = 0;
+
+
+const struct arrayops *__arrayops();
+int __lowest_bit(int a_mask);
+
+
+// the scalar kernels, which are used when the cpu has no simd support and for the elements left over
+// at the end of the simd kernels
+#define ARRAYOPS_SCALAR(a_suffix, a_type, a_sumtype) \
+  static size_t __find_##a_suffix##_scalar(const a_type *a_data, size_t a_count, a_type a_value) \
+  { \
+    size_t i; \
+    for (i = 0; i < a_count; i++) \
+    { \
+      if (a_data[i] == a_value) \
+      { \
+        return i; \
+      } \
+    } \
+    return ARRAY_NOT_FOUND; \
+  } \
+  \
+  static size_t __count_##a_suffix##_scalar(const a_type *a_data, size_t a_count, a_type a_value) \
+  { \
+    size_t i, count; \
+    for (i = 0, count = 0; i < a_count; i++) \
+    { \
+      count += (a_data[i] == a_value); \
+    } \
+    return count; \
+  } \
+  \
+  static a_type __min_##a_suffix##_scalar(const a_type *a_data, size_t a_count) \
+  { \
+    a_type value; \
+    size_t i; \
+    for (i = 1, value = a_data[0]; i < a_count; i++) \
+    { \
+      if (a_data[i] < value) \
+      { \
+        value = a_data[i]; \
+      } \
+    } \
+    return value; \
+  } \
+  \
+  static a_type __max_##a_suffix##_scalar(const a_type *a_data, size_t a_count) \
+  { \
+    a_type value; \
+    size_t i; \
+    for (i = 1, value = a_data[0]; i < a_count; i++) \
+    { \
+      if (a_data[i] > value) \
+      { \
+        value = a_data[i]; \
+      } \
+    } \
+    return value; \
+  } \
+  \
+  static a_sumtype __sum_##a_suffix##_scalar(const a_type *a_data, size_t a_count) \
+  { \
+    a_sumtype sum; \
+    size_t i; \
+    for (i = 0, sum = 0; i < a_count; i++) \
+    { \
+      sum += a_data[i]; \
+    } \
+    return sum; \
+  } \
+  \
+  static size_t __compare_##a_suffix##_scalar(const a_type *a_data, const a_type *a_other, size_t a_count) \
+  { \
+    size_t i; \
+    for (i = 0; i < a_count; i++) \
+    { \
+      if (a_data[i] != a_other[i]) \
+      { \
+        return i; \
+      } \
+    } \
+    return ARRAY_NOT_FOUND; \
+  }
+
+ARRAYOPS_SCALAR(i32, int32, int64)
+ARRAYOPS_SCALAR(i64, int64, int64)
+ARRAYOPS_SCALAR(f32, float, double)
+ARRAYOPS_SCALAR(f64, double, double)
+
+
+// offset the result of a scalar find or compare on the tail of the data
+#define ARRAYOPS_TAIL(a_index, a_start) ((a_index) == ARRAY_NOT_FOUND ? ARRAY_NOT_FOUND : (a_start) + (a_index))
+
+
+static void __fill32_scalar(uint32 *a_data, size_t a_count, uint32 a_value)
+{
+  size_t i;
+
+  for (i = 0; i < a_count; i++)
+  {
+    a_data[i] = a_value;
+  }
+}
+
+
+static void __fill64_scalar(uint64 *a_data, size_t a_count, uint64 a_value)
+{
+  size_t i;
+
+  for (i = 0; i < a_count; i++)
+  {
+    a_data[i] = a_value;
+  }
+}
+
+
+// sse2 kernels
+
+static void __fill32_sse2(uint32 *a_data, size_t a_count, uint32 a_value)
+{
+  __m128i value;
+  size_t i;
+
+  value = _mm_set1_epi32((int) a_value);
+
+  for (i = 0; i + 4 <= a_count; i += 4)
+  {
+    _mm_storeu_si128((__m128i *) (a_data + i), value);
+  }
+
+  __fill32_scalar(a_data + i, a_count - i, a_value);
+}
+
+
+static void __fill64_sse2(uint64 *a_data, size_t a_count, uint64 a_value)
+{
+  __m128i value;
+  size_t i;
+
+  value = _mm_loadl_epi64((const __m128i *) &a_value);
+  value = _mm_unpacklo_epi64(value, value);
+
+  for (i = 0; i + 2 <= a_count; i += 2)
+  {
+    _mm_storeu_si128((__m128i *) (a_data + i), value);
+  }
+
+  __fill64_scalar(a_data + i, a_count - i, a_value);
+}
+
+
+// compare two 64 bit ints in each half of the registers, as sse2 only compares 32 bit ints
+static __m128i __cmpeq_epi64_sse2(__m128i a_data, __m128i a_value)
+{
+  __m128i cmp;
+
+  cmp = _mm_cmpeq_epi32(a_data, a_value);
+  return _mm_and_si128(cmp, _mm_shuffle_epi32(cmp, _MM_SHUFFLE(2, 3, 0, 1)));
+}
+
+
+static size_t __find_i32_sse2(const int32 *a_data, size_t a_count, int32 a_value)
+{
+  __m128i value, cmp;
+  size_t i;
+  int mask;
+
+  value = _mm_set1_epi32(a_value);
+
+  for (i = 0; i + 4 <= a_count; i += 4)
+  {
+    cmp = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (a_data + i)), value);
+    mask = _mm_movemask_ps(_mm_castsi128_ps(cmp));
+
+    if (mask)
+    {
+      return i + __lowest_bit(mask);
+    }
+  }
+
+  return ARRAYOPS_TAIL(__find_i32_scalar(a_data + i, a_count - i, a_value), i);
+}
+
+
+static size_t __find_i64_sse2(const int64 *a_data, size_t a_count, int64 a_value)
+{
+  __m128i value, cmp;
+  size_t i;
+  int mask;
+
+  value = _mm_loadl_epi64((const __m128i *) &a_value);
+  value = _mm_unpacklo_epi64(value, value);
+
+  for (i = 0; i + 2 <= a_count; i += 2)
+  {
+    cmp = __cmpeq_epi64_sse2(_mm_loadu_si128((const __m128i *) (a_data + i)), value);
+    mask = _mm_movemask_pd(_mm_castsi128_pd(cmp));
+
+    if (mask)
+    {
+      return i + __lowest_bit(mask);
+    }
+  }
+
+  return ARRAYOPS_TAIL(__find_i64_scalar(a_data + i, a_count - i, a_value), i);
+}
+
+
+static size_t __find_f32_sse2(const float *a_data, size_t a_count, float a_value)
+{
+  __m128 value;
+  size_t i;
+  int mask;
+
+  value = _mm_set1_ps(a_value);
+
+  for (i = 0; i + 4 <= a_count; i += 4)
+  {
+    mask = _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(a_data + i), value));
+
+    if (mask)
+    {
+      return i + __lowest_bit(mask);
+    }
+  }
+
+  return ARRAYOPS_TAIL(__find_f32_scalar(a_data + i, a_count - i, a_value), i);
+}
+
+
+static size_t __find_f64_sse2(const double *a_data, size_t a_count, double a_value)
+{
+  __m128d value;
+  size_t i;
+  int mask;
+
+  value = _mm_set1_pd(a_value);
+
+  for (i = 0; i + 2 <= a_count; i += 2)
+  {
+    mask = _mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(a_data + i), value));
+
+    if (mask)
+    {
+      return i + __lowest_bit(mask);
+    }
+  }
+
+  return ARRAYOPS_TAIL(__find_f64_scalar(a_data + i, a_count - i, a_value), i);
+}
+
+
+// the matches are counted by subtracting the compare results, which are -1 for each match
+static size_t __count_i32_sse2(const int32 *a_data, size_t a_count, int32 a_value)
+{
+  __m128i value, count;
+  int32 lanes[4];
+  size_t i;
+
+  value = _mm_set1_epi32(a_value);
+  count = _mm_setzero_si128();
+
+  for (i = 0; i + 4 <= a_count; i += 4)
+  {
+    count = _mm_sub_epi32(count, _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (a_data + i)), value));
+  }
+
+  _mm_storeu_si128((__m128i *) lanes, count);
+  return (size_t) (lanes[0] + lanes[1] + lanes[2] + lanes[3]) + __count_i32_scalar(a_data + i, a_count - i, a_value);
+}
+
+
+static size_t __count_i64_sse2(const int64 *a_data, size_t a_count, int64 a_value)
+{
+  __m128i value, count;
+  int64 lanes[2];
+  size_t i;
+
+  value = _mm_loadl_epi64((const __m128i *) &a_value);
+  value = _mm_unpacklo_epi64(value, value);
+  count = _mm_setzero_si128();
+
+  for (i = 0; i + 2 <= a_count; i += 2)
+  {
+    count = _mm_sub_epi64(count, __cmpeq_epi64_sse2(_mm_loadu_si128((const __m128i *) (a_data + i)), value));
+  }
+
+  _mm_storeu_si128((__m128i *) lanes, count);
+  return (size_t) (lanes[0] + lanes[1]) + __count_i64_scalar(a_data + i, a_count - i, a_value);
+}
+
+
+static size_t __count_f32_sse2(const float *a_data, size_t a_count, float a_value)
+{
+  __m128 value;
+  __m128i count;
+  int32 lanes[4];
+  size_t i;
+
+  value = _mm_set1_ps(a_value);
+  count = _mm_setzero_si128();
+
+  for (i = 0; i + 4 <= a_count; i += 4)
+  {
+    count = _mm_sub_epi32(count, _mm_castps_si128(_mm_cmpeq_ps(_mm_loadu_ps(a_data + i), value)));
+  }
+
+  _mm_storeu_si128((__m128i *) lanes, count);
+  return (size_t) (lanes[0] + lanes[1] + lanes[2] + lanes[3]) + __count_f32_scalar(a_data + i, a_count - i, a_value);
+}
+
+
+static size_t __count_f64_sse2(const double *a_data, size_t a_count, double a_value)
+{
+  __m128d value;
+  __m128i count;
+  int64 lanes[2];
+  size_t i;
+
+  value = _mm_set1_pd(a_value);
+  count = _mm_setzero_si128();
+
+  for (i = 0; i + 2 <= a_count; i += 2)
+  {
+    count = _mm_sub_epi64(count, _mm_castpd_si128(_mm_cmpeq_pd(_mm_loadu_pd(a_data + i), value)));
+  }
+
+  _mm_storeu_si128((__m128i *) lanes, count);
+  return (size_t) (lanes[0] + lanes[1]) + __count_f64_scalar(a_data + i, a_count - i, a_value);
+}
+
+
+// sse2 has no 32 bit int min or max, so the lanes are selected with the compare mask
+static int32 __min_i32_sse2(const int32 *a_data, size_t a_count)
+{
+  __m128i value, data, mask;
+  int32 lanes[4], tail;
+  size_t i;
+
+  if (a_count < 4)
+  {
+    return __min_i32_scalar(a_data, a_count);
+  }
+
+  value = _mm_loadu_si128((const __m128i *) a_data);
+
+  for (i = 4; i + 4 <= a_count; i += 4)
+  {
+    data = _mm_loadu_si128((const __m128i *) (a_data + i));
+    mask = _mm_cmplt_epi32(data, value);
+    value = _mm_or_si128(_mm_and_si128(mask, data), _mm_andnot_si128(mask, value));
+  }
+
+  _mm_storeu_si128((__m128i *) lanes, value);
+  lanes[0] = __min_i32_scalar(lanes, 4);
+
+  if (i < a_count)
+  {
+    tail = __min_i32_scalar(a_data + i, a_count - i);
+    return min(lanes[0], tail);
+  }
+
+  return lanes[0];
+}
+
+
+static int32 __max_i32_sse2(const int32 *a_data, size_t a_count)
+{
+  __m128i value, data, mask;
+  int32 lanes[4], tail;
+  size_t i;
+
+  if (a_count < 4)
+  {
+    return __max_i32_scalar(a_data, a_count);
+  }
+
+  value = _mm_loadu_si128((const __m128i *) a_data);
+
+  for (i = 4; i + 4 <= a_count; i += 4)
+  {
+    data = _mm_loadu_si128((const __m128i *) (a_data + i));
+    mask = _mm_cmpgt_epi32(data, value);
+    value = _mm_or_si128(_mm_and_si128(mask, data), _mm_andnot_si128(mask, value));
+  }
+
+  _mm_storeu_si128((__m128i *) lanes, value);
+  lanes[0] = __max_i32_scalar(lanes, 4);
+
+  if (i < a_count)
+  {
+    tail = __max_i32_scalar(a_data + i, a_count - i);
+    return max(lanes[0], tail);
+  }
+
+  return lanes[0];
+}
+
+
+static float __min_f32_sse2(const float *a_data, size_t a_count)
+{
+  __m128 value;
+  float lanes[4], tail;
+  size_t i;
+
+  if (a_count < 4)
+  {
+    return __min_f32_scalar(a_data, a_count);
+  }
+
+  value = _mm_loadu_ps(a_data);
+
+  for (i = 4; i + 4 <= a_count; i += 4)
+  {
+    value = _mm_min_ps(value, _mm_loadu_ps(a_data + i));
+  }
+
+  _mm_storeu_ps(lanes, value);
+  lanes[0] = __min_f32_scalar(lanes, 4);
+
+  if (i < a_count)
+  {
+    tail = __min_f32_scalar(a_data + i, a_count - i);
+    return min(lanes[0], tail);
+  }
+
+  return lanes[0];
+}
+
+
+static float __max_f32_sse2(const float *a_data, size_t a_count)
+{
+  __m128 value;
+  float lanes[4], tail;
+  size_t i;
+
+  if (a_count < 4)
+  {
+    return __max_f32_scalar(a_data, a_count);
+  }
+
+  value = _mm_loadu_ps(a_data);
+
+  for (i = 4; i + 4 <= a_count; i += 4)
+  {
+    value = _mm_max_ps(value, _mm_loadu_ps(a_data + i));
+  }
+
+  _mm_storeu_ps(lanes, value);
+  lanes[0] = __max_f32_scalar(lanes, 4);
+
+  if (i < a_count)
+  {
+    tail = __max_f32_scalar(a_data + i, a_count - i);
+    return max(lanes[0], tail);
+  }
+
+  return lanes[0];
+}
+
+
+static double __min_f64_sse2(const double *a_data, size_t a_count)
+{
+  __m128d value;
+  double lanes[2];
+  size_t i;
+
+  if (a_count < 2)
+  {
+    return __min_f64_scalar(a_data, a_count);
+  }
+
+  value = _mm_loadu_pd(a_data);
+
+  for (i = 2; i + 2 <= a_count; i += 2)
+  {
+    value = _mm_min_pd(value, _mm_loadu_pd(a_data + i));
+  }
+
+  _mm_storeu_pd(lanes, value);
+  lanes[0] = min(lanes[0], lanes[1]);
+
+  return (i < a_count) ? min(lanes[0], a_data[i]) : lanes[0];
+}
+
+
+static double __max_f64_sse2(const double *a_data, size_t a_count)
+{
+  __m128d value;
+  double lanes[2];
+  size_t i;
+
+  if (a_count < 2)
+  {
+    return __max_f64_scalar(a_data, a_count);
+  }
+
+  value = _mm_loadu_pd(a_data);
+
+  for (i = 2; i + 2 <= a_count; i += 2)
+  {
+    value = _mm_max_pd(value, _mm_loadu_pd(a_data + i));
+  }
+
+  _mm_storeu_pd(lanes, value);
+  lanes[0] = max(lanes[0], lanes[1]);
+
+  return (i < a_count) ? max(lanes[0], a_data[i]) : lanes[0];
+}
+
+
+// the 32 bit ints are sign extended to 64 bits before they are added, so the sum can not overflow
+static int64 __sum_i32_sse2(const int32 *a_data, size_t a_count)
+{
+  __m128i sum, data, sign;
+  int64 lanes[2];
+  size_t i;
+
+  sum = _mm_setzero_si128();
+
+  for (i = 0; i + 4 <= a_count; i += 4)
+  {
+    data = _mm_loadu_si128((const __m128i *) (a_data + i));
+    sign = _mm_srai_epi32(data, 31);
+    sum = _mm_add_epi64(sum, _mm_unpacklo_epi32(data, sign));
+    sum = _mm_add_epi64(sum, _mm_unpackhi_epi32(data, sign));
+  }
+
+  _mm_storeu_si128((__m128i *) lanes, sum);
+  return lanes[0] + lanes[1] + __sum_i32_scalar(a_data + i, a_count - i);
+}
+
+
+static int64 __sum_i64_sse2(const int64 *a_data, size_t a_count)
+{
+  __m128i sum;
+  int64 lanes[2];
+  size_t i;
+
+  sum = _mm_setzero_si128();
+
+  for (i = 0; i + 2 <= a_count; i += 2)
+  {
+    sum = _mm_add_epi64(sum, _mm_loadu_si128((const __m128i *) (a_data + i)));
+  }
+
+  _mm_storeu_si128((__m128i *) lanes, sum);
+  return lanes[0] + lanes[1] + __sum_i64_scalar(a_data + i, a_count - i);
+}
+
+
+// the floats are converted to doubles before they are added, the same as the scalar sum
+static double __sum_f32_sse2(const float *a_data, size_t a_count)
+{
+  __m128d sum;
+  __m128 data;
+  double lanes[2];
+  size_t i;
+
+  sum = _mm_setzero_pd();
+
+  for (i = 0; i + 4 <= a_count; i += 4)
+  {
+    data = _mm_loadu_ps(a_data + i);
+    sum = _mm_add_pd(sum, _mm_cvtps_pd(data));
+    sum = _mm_add_pd(sum, _mm_cvtps_pd(_mm_movehl_ps(data, data)));
+  }
+
+  _mm_storeu_pd(lanes, sum);
+  return lanes[0] + lanes[1] + __sum_f32_scalar(a_data + i, a_count - i);
+}
+
+
+static double __sum_f64_sse2(const double *a_data, size_t a_count)
+{
+  __m128d sum;
+  double lanes[2];
+  size_t i;
+
+  sum = _mm_setzero_pd();
+
+  for (i = 0; i + 2 <= a_count; i += 2)
+  {
+    sum = _mm_add_pd(sum, _mm_loadu_pd(a_data + i));
+  }
+
+  _mm_storeu_pd(lanes, sum);
+  return lanes[0] + lanes[1] + __sum_f64_scalar(a_data + i, a_count - i);
+}
+
+
+static size_t __compare_i32_sse2(const int32 *a_data, const int32 *a_other, size_t a_count)
+{
+  __m128i cmp;
+  size_t i;
+  int mask;
+
+  for (i = 0; i + 4 <= a_count; i += 4)
+  {
+    cmp = _mm_cmpeq_epi32(_mm_loadu_si128((const __m128i *) (a_data + i)), _mm_loadu_si128((const __m128i *) (a_other + i)));
+    mask = _mm_movemask_ps(_mm_castsi128_ps(cmp)) ^ 0xf;
+
+    if (mask)
+    {
+      return i + __lowest_bit(mask);
+    }
+  }
+
+  return ARRAYOPS_TAIL(__compare_i32_scalar(a_data + i, a_other + i, a_count - i), i);
+}
+
+
+static size_t __compare_i64_sse2(const int64 *a_data, const int64 *a_other, size_t a_count)
+{
+  __m128i cmp;
+  size_t i;
+  int mask;
+
+  for (i = 0; i + 2 <= a_count; i += 2)
+  {
+    cmp = __cmpeq_epi64_sse2(_mm_loadu_si128((const __m128i *) (a_data + i)), _mm_loadu_si128((const __m128i *) (a_other + i)));
+    mask = _mm_movemask_pd(_mm_castsi128_pd(cmp)) ^ 0x3;
+
+    if (mask)
+    {
+      return i + __lowest_bit(mask);
+    }
+  }
+
+  return ARRAYOPS_TAIL(__compare_i64_scalar(a_data + i, a_other + i, a_count - i), i);
+}
+
+
+static size_t __compare_f32_sse2(const float *a_data, const float *a_other, size_t a_count)
+{
+  size_t i;
+  int mask;
+
+  for (i = 0; i + 4 <= a_count; i += 4)
+  {
+    mask = _mm_movemask_ps(_mm_cmpeq_ps(_mm_loadu_ps(a_data + i), _mm_loadu_ps(a_other + i))) ^ 0xf;
+
+    if (mask)
+    {
+      return i + __lowest_bit(mask);
+    }
+  }
+
+  return ARRAYOPS_TAIL(__compare_f32_scalar(a_data + i, a_other + i, a_count - i), i);
+}
+
+
+static size_t __compare_f64_sse2(const double *a_data, const double *a_other, size_t a_count)
+{
+  size_t i;
+  int mask;
+
+  for (i = 0; i + 2 <= a_count; i += 2)
+  {
+    mask = _mm_movemask_pd(_mm_cmpeq_pd(_mm_loadu_pd(a_data + i), _mm_loadu_pd(a_other + i))) ^ 0x3;
+
+    if (mask)
+    {
+      return i + __lowest_bit(mask);
+    }
+  }
+
+  return ARRAYOPS_TAIL(__compare_f64_scalar(a_data + i, a_other + i, a_count - i), i);
+}
+
+
+#if ARRAYOPS_AVX2
+
+// avx2 kernels
+
+static void __fill32_avx2(uint32 *a_data, size_t a_count, uint32 a_value)
+{
+  __m256i value;
+  size_t i;
+
+  value = _mm256_set1_epi32((int) a_value);
+
+  for (i = 0; i + 8 <= a_count; i += 8)
+  {
+    _mm256_storeu_si256((__m256i *) (a_data + i), value);
+  }
+
+  __fill32_scalar(a_data + i, a_count - i, a_value);
+}
+
+
+static void __fill64_avx2(uint64 *a_data, size_t a_count, uint64 a_value)
+{
+  __m256i value;
+  size_t i;
+
+  value = _mm256_broadcastq_epi64(_mm_loadl_epi64((const __m128i *) &a_value));
+
+  for (i = 0; i + 4 <= a_count; i += 4)
+  {
+    _mm256_storeu_si256((__m256i *) (a_data + i), value);
+  }
+
+  __fill64_scalar(a_data + i, a_count - i, a_value);
+}
+
+
+static size_t __find_i32_avx2(const int32 *a_data, size_t a_count, int32 a_value)
+{
+  __m256i value, cmp;
+  size_t i;
+  int mask;
+
+  value = _mm256_set1_epi32(a_value);
+
+  for (i = 0; i + 8 <= a_count; i += 8)
+  {
+    cmp = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *) (a_data + i)), value);
+    mask = _mm256_movemask_ps(_mm256_castsi256_ps(cmp));
+
+    if (mask)
+    {
+      return i + __lowest_bit(mask);
+    }
+  }
+
+  return ARRAYOPS_TAIL(__find_i32_scalar(a_data + i, a_count - i, a_value), i);
+}
+
+
+static size_t __find_i64_avx2(const int64 *a_data, size_t a_count, int64 a_value)
+{
+  __m256i value, cmp;
+  size_t i;
+  int mask;
+
+  value = _mm256_broadcastq_epi64(_mm_loadl_epi64((const __m128i *) &a_value));
+
+  for (i = 0; i + 4 <= a_count; i += 4)
+  {
+    cmp = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *) (a_data + i)), value);
+    mask = _mm256_movemask_pd(_mm256_castsi256_pd(cmp));
+
+    if (mask)
+    {
+      return i + __lowest_bit(mask);
+    }
+  }
+
+  return ARRAYOPS_TAIL(__find_i64_scalar(a_data + i, a_count - i, a_value), i);
+}
+
+
+static size_t __find_f32_avx2(const float *a_data, size_t a_count, float a_value)
+{
+  __m256 value;
+  size_t i;
+  int mask;
+
+  value = _mm256_set1_ps(a_value);
+
+  for (i = 0; i + 8 <= a_count; i += 8)
+  {
+    mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(a_data + i), value, _CMP_EQ_OQ));
+
+    if (mask)
+    {
+      return i + __lowest_bit(mask);
+    }
+  }
+
+  return ARRAYOPS_TAIL(__find_f32_scalar(a_data + i, a_count - i, a_value), i);
+}
+
+
+static size_t __find_f64_avx2(const double *a_data, size_t a_count, double a_value)
+{
+  __m256d value;
+  size_t i;
+  int mask;
+
+  value = _mm256_set1_pd(a_value);
+
+  for (i = 0; i + 4 <= a_count; i += 4)
+  {
+    mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(a_data + i), value, _CMP_EQ_OQ));
+
+    if (mask)
+    {
+      return i + __lowest_bit(mask);
+    }
+  }
+
+  return ARRAYOPS_TAIL(__find_f64_scalar(a_data + i, a_count - i, a_value), i);
+}
+
+
+static size_t __count_i32_avx2(const int32 *a_data, size_t a_count, int32 a_value)
+{
+  __m256i value, count;
+  int32 lanes[8];
+  size_t i;
+
+  value = _mm256_set1_epi32(a_value);
+  count = _mm256_setzero_si256();
+
+  for (i = 0; i + 8 <= a_count; i += 8)
+  {
+    count = _mm256_sub_epi32(count, _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *) (a_data + i)), value));
+  }
+
+  _mm256_storeu_si256((__m256i *) lanes, count);
+  return (size_t) __sum_i32_scalar(lanes, 8) + __count_i32_scalar(a_data + i, a_count - i, a_value);
+}
+
+
+static size_t __count_i64_avx2(const int64 *a_data, size_t a_count, int64 a_value)
+{
+  __m256i value, count;
+  int64 lanes[4];
+  size_t i;
+
+  value = _mm256_broadcastq_epi64(_mm_loadl_epi64((const __m128i *) &a_value));
+  count = _mm256_setzero_si256();
+
+  for (i = 0; i + 4 <= a_count; i += 4)
+  {
+    count = _mm256_sub_epi64(count, _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *) (a_data + i)), value));
+  }
+
+  _mm256_storeu_si256((__m256i *) lanes, count);
+  return (size_t) __sum_i64_scalar(lanes, 4) + __count_i64_scalar(a_data + i, a_count - i, a_value);
+}
+
+
+static size_t __count_f32_avx2(const float *a_data, size_t a_count, float a_value)
+{
+  __m256 value;
+  __m256i count;
+  int32 lanes[8];
+  size_t i;
+
+  value = _mm256_set1_ps(a_value);
+  count = _mm256_setzero_si256();
+
+  for (i = 0; i + 8 <= a_count; i += 8)
+  {
+    count = _mm256_sub_epi32(count, _mm256_castps_si256(_mm256_cmp_ps(_mm256_loadu_ps(a_data + i), value, _CMP_EQ_OQ)));
+  }
+
+  _mm256_storeu_si256((__m256i *) lanes, count);
+  return (size_t) __sum_i32_scalar(lanes, 8) + __count_f32_scalar(a_data + i, a_count - i, a_value);
+}
+
+
+static size_t __count_f64_avx2(const double *a_data, size_t a_count, double a_value)
+{
+  __m256d value;
+  __m256i count;
+  int64 lanes[4];
+  size_t i;
+
+  value = _mm256_set1_pd(a_value);
+  count = _mm256_setzero_si256();
+
+  for (i = 0; i + 4 <= a_count; i += 4)
+  {
+    count = _mm256_sub_epi64(count, _mm256_castpd_si256(_mm256_cmp_pd(_mm256_loadu_pd(a_data + i), value, _CMP_EQ_OQ)));
+  }
+
+  _mm256_storeu_si256((__m256i *) lanes, count);
+  return (size_t) __sum_i64_scalar(lanes, 4) + __count_f64_scalar(a_data + i, a_count - i, a_value);
+}
+
+
+static int32 __min_i32_avx2(const int32 *a_data, size_t a_count)
+{
+  __m256i value;
+  int32 lanes[8], tail;
+  size_t i;
+
+  if (a_count < 8)
+  {
+    return __min_i32_scalar(a_data, a_count);
+  }
+
+  value = _mm256_loadu_si256((const __m256i *) a_data);
+
+  for (i = 8; i + 8 <= a_count; i += 8)
+  {
+    value = _mm256_min_epi32(value, _mm256_loadu_si256((const __m256i *) (a_data + i)));
+  }
+
+  _mm256_storeu_si256((__m256i *) lanes, value);
+  lanes[0] = __min_i32_scalar(lanes, 8);
+
+  if (i < a_count)
+  {
+    tail = __min_i32_scalar(a_data + i, a_count - i);
+    return min(lanes[0], tail);
+  }
+
+  return lanes[0];
+}
+
+
+static int32 __max_i32_avx2(const int32 *a_data, size_t a_count)
+{
+  __m256i value;
+  int32 lanes[8], tail;
+  size_t i;
+
+  if (a_count < 8)
+  {
+    return __max_i32_scalar(a_data, a_count);
+  }
+
+  value = _mm256_loadu_si256((const __m256i *) a_data);
+
+  for (i = 8; i + 8 <= a_count; i += 8)
+  {
+    value = _mm256_max_epi32(value, _mm256_loadu_si256((const __m256i *) (a_data + i)));
+  }
+
+  _mm256_storeu_si256((__m256i *) lanes, value);
+  lanes[0] = __max_i32_scalar(lanes, 8);
+
+  if (i < a_count)
+  {
+    tail = __max_i32_scalar(a_data + i, a_count - i);
+    return max(lanes[0], tail);
+  }
+
+  return lanes[0];
+}
+
+
+// avx2 has no 64 bit int min or max, so the lanes are selected with the compare mask
+static int64 __min_i64_avx2(const int64 *a_data, size_t a_count)
+{
+  __m256i value, data;
+  int64 lanes[4], tail;
+  size_t i;
+
+  if (a_count < 4)
+  {
+    return __min_i64_scalar(a_data, a_count);
+  }
+
+  value = _mm256_loadu_si256((const __m256i *) a_data);
+
+  for (i = 4; i + 4 <= a_count; i += 4)
+  {
+    data = _mm256_loadu_si256((const __m256i *) (a_data + i));
+    value = _mm256_blendv_epi8(value, data, _mm256_cmpgt_epi64(value, data));
+  }
+
+  _mm256_storeu_si256((__m256i *) lanes, value);
+  lanes[0] = __min_i64_scalar(lanes, 4);
+
+  if (i < a_count)
+  {
+    tail = __min_i64_scalar(a_data + i, a_count - i);
+    return min(lanes[0], tail);
+  }
+
+  return lanes[0];
+}
+
+
+static int64 __max_i64_avx2(const int64 *a_data, size_t a_count)
+{
+  __m256i value, data;
+  int64 lanes[4], tail;
+  size_t i;
+
+  if (a_count < 4)
+  {
+    return __max_i64_scalar(a_data, a_count);
+  }
+
+  value = _mm256_loadu_si256((const __m256i *) a_data);
+
+  for (i = 4; i + 4 <= a_count; i += 4)
+  {
+    data = _mm256_loadu_si256((const __m256i *) (a_data + i));
+    value = _mm256_blendv_epi8(value, data, _mm256_cmpgt_epi64(data, value));
+  }
+
+  _mm256_storeu_si256((__m256i *) lanes, value);
+  lanes[0] = __max_i64_scalar(lanes, 4);
+
+  if (i < a_count)
+  {
+    tail = __max_i64_scalar(a_data + i, a_count - i);
+    return max(lanes[0], tail);
+  }
+
+  return lanes[0];
+}
+
+
+static float __min_f32_avx2(const float *a_data, size_t a_count)
+{
+  __m256 value;
+  float lanes[8], tail;
+  size_t i;
+
+  if (a_count < 8)
+  {
+    return __min_f32_scalar(a_data, a_count);
+  }
+
+  value = _mm256_loadu_ps(a_data);
+
+  for (i = 8; i + 8 <= a_count; i += 8)
+  {
+    value = _mm256_min_ps(value, _mm256_loadu_ps(a_data + i));
+  }
+
+  _mm256_storeu_ps(lanes, value);
+  lanes[0] = __min_f32_scalar(lanes, 8);
+
+  if (i < a_count)
+  {
+    tail = __min_f32_scalar(a_data + i, a_count - i);
+    return min(lanes[0], tail);
+  }
+
+  return lanes[0];
+}
+
+
+static float __max_f32_avx2(const float *a_data, size_t a_count)
+{
+  __m256 value;
+  float lanes[8], tail;
+  size_t i;
+
+  if (a_count < 8)
+  {
+    return __max_f32_scalar(a_data, a_count);
+  }
+
+  value = _mm256_loadu_ps(a_data);
+
+  for (i = 8; i + 8 <= a_count; i += 8)
+  {
+    value = _mm256_max_ps(value, _mm256_loadu_ps(a_data + i));
+  }
+
+  _mm256_storeu_ps(lanes, value);
+  lanes[0] = __max_f32_scalar(lanes, 8);
+
+  if (i < a_count)
+  {
+    tail = __max_f32_scalar(a_data + i, a_count - i);
+    return max(lanes[0], tail);
+  }
+
+  return lanes[0];
+}
+
+
+static double __min_f64_avx2(const double *a_data, size_t a_count)
+{
+  __m256d value;
+  double lanes[4], tail;
+  size_t i;
+
+  if (a_count < 4)
+  {
+    return __min_f64_scalar(a_data, a_count);
+  }
+
+  value = _mm256_loadu_pd(a_data);
+
+  for (i = 4; i + 4 <= a_count; i += 4)
+  {
+    value = _mm256_min_pd(value, _mm256_loadu_pd(a_data + i));
+  }
+
+  _mm256_storeu_pd(lanes, value);
+  lanes[0] = __min_f64_scalar(lanes, 4);
+
+  if (i < a_count)
+  {
+    tail = __min_f64_scalar(a_data + i, a_count - i);
+    return min(lanes[0], tail);
+  }
+
+  return lanes[0];
+}
+
+
+static double __max_f64_avx2(const double *a_data, size_t a_count)
+{
+  __m256d value;
+  double lanes[4], tail;
+  size_t i;
+
+  if (a_count < 4)
+  {
+    return __max_f64_scalar(a_data, a_count);
+  }
+
+  value = _mm256_loadu_pd(a_data);
+
+  for (i = 4; i + 4 <= a_count; i += 4)
+  {
+    value = _mm256_max_pd(value, _mm256_loadu_pd(a_data + i));
+  }
+
+  _mm256_storeu_pd(lanes, value);
+  lanes[0] = __max_f64_scalar(lanes, 4);
+
+  if (i < a_count)
+  {
+    tail = __max_f64_scalar(a_data + i, a_count - i);
+    return max(lanes[0], tail);
+  }
+
+  return lanes[0];
+}
+
+
+static int64 __sum_i32_avx2(const int32 *a_data, size_t a_count)
+{
+  __m256i sum;
+  int64 lanes[4];
+  size_t i;
+
+  sum = _mm256_setzero_si256();
+
+  for (i = 0; i + 8 <= a_count; i += 8)
+  {
+    sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *) (a_data + i))));
+    sum = _mm256_add_epi64(sum, _mm256_cvtepi32_epi64(_mm_loadu_si128((const __m128i *) (a_data + i + 4))));
+  }
+
+  _mm256_storeu_si256((__m256i *) lanes, sum);
+  return __sum_i64_scalar(lanes, 4) + __sum_i32_scalar(a_data + i, a_count - i);
+}
+
+
+static int64 __sum_i64_avx2(const int64 *a_data, size_t a_count)
+{
+  __m256i sum;
+  int64 lanes[4];
+  size_t i;
+
+  sum = _mm256_setzero_si256();
+
+  for (i = 0; i + 4 <= a_count; i += 4)
+  {
+    sum = _mm256_add_epi64(sum, _mm256_loadu_si256((const __m256i *) (a_data + i)));
+  }
+
+  _mm256_storeu_si256((__m256i *) lanes, sum);
+  return __sum_i64_scalar(lanes, 4) + __sum_i64_scalar(a_data + i, a_count - i);
+}
+
+
+static double __sum_f32_avx2(const float *a_data, size_t a_count)
+{
+  __m256d sum;
+  double lanes[4];
+  size_t i;
+
+  sum = _mm256_setzero_pd();
+
+  for (i = 0; i + 8 <= a_count; i += 8)
+  {
+    sum = _mm256_add_pd(sum, _mm256_cvtps_pd(_mm_loadu_ps(a_data + i)));
+    sum = _mm256_add_pd(sum, _mm256_cvtps_pd(_mm_loadu_ps(a_data + i + 4)));
+  }
+
+  _mm256_storeu_pd(lanes, sum);
+  return __sum_f64_scalar(lanes, 4) + __sum_f32_scalar(a_data + i, a_count - i);
+}
+
+
+static double __sum_f64_avx2(const double *a_data, size_t a_count)
+{
+  __m256d sum;
+  double lanes[4];
+  size_t i;
+
+  sum = _mm256_setzero_pd();
+
+  for (i = 0; i + 4 <= a_count; i += 4)
+  {
+    sum = _mm256_add_pd(sum, _mm256_loadu_pd(a_data + i));
+  }
+
+  _mm256_storeu_pd(lanes, sum);
+  return __sum_f64_scalar(lanes, 4) + __sum_f64_scalar(a_data + i, a_count - i);
+}
+
+
+static size_t __compare_i32_avx2(const int32 *a_data, const int32 *a_other, size_t a_count)
+{
+  __m256i cmp;
+  size_t i;
+  int mask;
+
+  for (i = 0; i + 8 <= a_count; i += 8)
+  {
+    cmp = _mm256_cmpeq_epi32(_mm256_loadu_si256((const __m256i *) (a_data + i)), _mm256_loadu_si256((const __m256i *) (a_other + i)));
+    mask = _mm256_movemask_ps(_mm256_castsi256_ps(cmp)) ^ 0xff;
+
+    if (mask)
+    {
+      return i + __lowest_bit(mask);
+    }
+  }
+
+  return ARRAYOPS_TAIL(__compare_i32_scalar(a_data + i, a_other + i, a_count - i), i);
+}
+
+
+static size_t __compare_i64_avx2(const int64 *a_data, const int64 *a_other, size_t a_count)
+{
+  __m256i cmp;
+  size_t i;
+  int mask;
+
+  for (i = 0; i + 4 <= a_count; i += 4)
+  {
+    cmp = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *) (a_data + i)), _mm256_loadu_si256((const __m256i *) (a_other + i)));
+    mask = _mm256_movemask_pd(_mm256_castsi256_pd(cmp)) ^ 0xf;
+
+    if (mask)
+    {
+      return i + __lowest_bit(mask);
+    }
+  }
+
+  return ARRAYOPS_TAIL(__compare_i64_scalar(a_data + i, a_other + i, a_count - i), i);
+}
+
+
+static size_t __compare_f32_avx2(const float *a_data, const float *a_other, size_t a_count)
+{
+  size_t i;
+  int mask;
+
+  for (i = 0; i + 8 <= a_count; i += 8)
+  {
+    mask = _mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(a_data + i), _mm256_loadu_ps(a_other + i), _CMP_EQ_OQ)) ^ 0xff;
+
+    if (mask)
+    {
+      return i + __lowest_bit(mask);
+    }
+  }
+
+  return ARRAYOPS_TAIL(__compare_f32_scalar(a_data + i, a_other + i, a_count - i), i);
+}
+
+
+static size_t __compare_f64_avx2(const double *a_data, const double *a_other, size_t a_count)
+{
+  size_t i;
+  int mask;
+
+  for (i = 0; i + 4 <= a_count; i += 4)
+  {
+    mask = _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(a_data + i), _mm256_loadu_pd(a_other + i), _CMP_EQ_OQ)) ^ 0xf;
+
+    if (mask)
+    {
+      return i + __lowest_bit(mask);
+    }
+  }
+
+  return ARRAYOPS_TAIL(__compare_f64_scalar(a_data + i, a_other + i, a_count - i), i);
+}
+
+#endif // ARRAYOPS_AVX2
+
+
+// select the kernels for the cpu
+const struct arrayops *__arrayops()
+{
+  // locals
+  struct arrayops ops;
+  int features;
+
+  // the kernels are selected on the first call. this is safe to race as every thread selects the same kernels.
+  if (g_arrayops_ready)
+  {
+    return &g_arrayops;
+  }
+
+  features = cpu_features();
+
+  // the scalar kernels work on any cpu
+  ops.m_fill32 = __fill32_scalar;
+  ops.m_fill64 = __fill64_scalar;
+  ops.m_find_i32 = __find_i32_scalar;
+  ops.m_find_i64 = __find_i64_scalar;
+  ops.m_find_f32 = __find_f32_scalar;
+  ops.m_find_f64 = __find_f64_scalar;
+  ops.m_count_i32 = __count_i32_scalar;
+  ops.m_count_i64 = __count_i64_scalar;
+  ops.m_count_f32 = __count_f32_scalar;
+  ops.m_count_f64 = __count_f64_scalar;
+  ops.m_min_i32 = __min_i32_scalar;
+  ops.m_min_i64 = __min_i64_scalar;
+  ops.m_min_f32 = __min_f32_scalar;
+  ops.m_min_f64 = __min_f64_scalar;
+  ops.m_max_i32 = __max_i32_scalar;
+  ops.m_max_i64 = __max_i64_scalar;
+  ops.m_max_f32 = __max_f32_scalar;
+  ops.m_max_f64 = __max_f64_scalar;
+  ops.m_sum_i32 = __sum_i32_scalar;
+  ops.m_sum_i64 = __sum_i64_scalar;
+  ops.m_sum_f32 = __sum_f32_scalar;
+  ops.m_sum_f64 = __sum_f64_scalar;
+  ops.m_compare_i32 = __compare_i32_scalar;
+  ops.m_compare_i64 = __compare_i64_scalar;
+  ops.m_compare_f32 = __compare_f32_scalar;
+  ops.m_compare_f64 = __compare_f64_scalar;
+
+  // sse2 has no 64 bit int min or max, so those stay scalar
+  if (features & CPU_SSE2)
+  {
+    ops.m_fill32 = __fill32_sse2;
+    ops.m_fill64 = __fill64_sse2;
+    ops.m_find_i32 = __find_i32_sse2;
+    ops.m_find_i64 = __find_i64_sse2;
+    ops.m_find_f32 = __find_f32_sse2;
+    ops.m_find_f64 = __find_f64_sse2;
+    ops.m_count_i32 = __count_i32_sse2;
+    ops.m_count_i64 = __count_i64_sse2;
+    ops.m_count_f32 = __count_f32_sse2;
+    ops.m_count_f64 = __count_f64_sse2;
+    ops.m_min_i32 = __min_i32_sse2;
+    ops.m_min_f32 = __min_f32_sse2;
+    ops.m_min_f64 = __min_f64_sse2;
+    ops.m_max_i32 = __max_i32_sse2;
+    ops.m_max_f32 = __max_f32_sse2;
+    ops.m_max_f64 = __max_f64_sse2;
+    ops.m_sum_i32 = __sum_i32_sse2;
+    ops.m_sum_i64 = __sum_i64_sse2;
+    ops.m_sum_f32 = __sum_f32_sse2;
+    ops.m_sum_f64 = __sum_f64_sse2;
+    ops.m_compare_i32 = __compare_i32_sse2;
+    ops.m_compare_i64 = __compare_i64_sse2;
+    ops.m_compare_f32 = __compare_f32_sse2;
+    ops.m_compare_f64 = __compare_f64_sse2;
+  }
+
+#if ARRAYOPS_AVX2
+  if (features & CPU_AVX2)
+  {
+    ops.m_fill32 = __fill32_avx2;
+    ops.m_fill64 = __fill64_avx2;
+    ops.m_find_i32 = __find_i32_avx2;
+    ops.m_find_i64 = __find_i64_avx2;
+    ops.m_find_f32 = __find_f32_avx2;
+    ops.m_find_f64 = __find_f64_avx2;
+    ops.m_count_i32 = __count_i32_avx2;
+    ops.m_count_i64 = __count_i64_avx2;
+    ops.m_count_f32 = __count_f32_avx2;
+    ops.m_count_f64 = __count_f64_avx2;
+    ops.m_min_i32 = __min_i32_avx2;
+    ops.m_min_i64 = __min_i64_avx2;
+    ops.m_min_f32 = __min_f32_avx2;
+    ops.m_min_f64 = __min_f64_avx2;
+    ops.m_max_i32 = __max_i32_avx2;
+    ops.m_max_i64 = __max_i64_avx2;
+    ops.m_max_f32 = __max_f32_avx2;
+    ops.m_max_f64 = __max_f64_avx2;
+    ops.m_sum_i32 = __sum_i32_avx2;
+    ops.m_sum_i64 = __sum_i64_avx2;
+    ops.m_sum_f32 = __sum_f32_avx2;
+    ops.m_sum_f64 = __sum_f64_avx2;
+    ops.m_compare_i32 = __compare_i32_avx2;
+    ops.m_compare_i64 = __compare_i64_avx2;
+    ops.m_compare_f32 = __compare_f32_avx2;
+    ops.m_compare_f64 = __compare_f64_avx2;
+  }
+#endif
+
+  // the kernels must be visible before the flag, as other threads read them without taking a lock
+  g_arrayops = ops;
+  MemoryBarrier();
+  g_arrayops_ready = 1;
+
+  return &g_arrayops;
+}
+
+
+// get the index of the lowest set bit in a compare mask
+int __lowest_bit(int a_mask)
+{
+  // locals
+  unsigned long index;
+
+  // checks
+  assert(a_mask);
+
+  _BitScanForward(&index, (unsigned long) a_mask);
+  return (int) index;
+}
+
+
+// gather a block of elements from a view with a stride into a buffer
+static void __view_gather(const struct array_view *a_view, size_t a_start, size_t a_count, void *a_buffer)
+{
+  // locals
+  const char *src;
+  size_t i;
+
+  src = a_view->m_base + a_start * a_view->m_stride;
+
+  if (a_view->m_elemsize == 4)
+  {
+    for (i = 0; i < a_count; i++, src += a_view->m_stride)
+    {
+      ((uint32 *) a_buffer)[i] = *(const uint32 *) src;
+    }
+  }
+  else
+  {
+    for (i = 0; i < a_count; i++, src += a_view->m_stride)
+    {
+      ((uint64 *) a_buffer)[i] = *(const uint64 *) src;
+    }
+  }
+}
+
+
+// the interface functions for each element type. contiguous views are passed straight to the kernels,
+// while views with a stride are gathered into a buffer a block at a time. the array functions work on a
+// view of the whole array.
+#define ARRAYOPS_INTERFACE(a_suffix, a_type, a_sumtype, a_filltype, a_fill) \
+  void _array_view_fill_##a_suffix(struct array_view *a_view, a_type a_value) \
+  { \
+    a_filltype value; \
+    char *dst; \
+    size_t i; \
+    assert(a_view); \
+    assert(a_view->m_elemsize == sizeof(a_type)); \
+    memcpy(&value, &a_value, sizeof(a_type)); \
+    if (array_view_contiguous(a_view)) \
+    { \
+      __arrayops()->a_fill((a_filltype *) a_view->m_base, a_view->m_count, value); \
+      return; \
+    } \
+    for (i = 0, dst = a_view->m_base; i < a_view->m_count; i++, dst += a_view->m_stride) \
+    { \
+      *(a_filltype *) dst = value; \
+    } \
+  } \
+  \
+  size_t _array_view_find_##a_suffix(const struct array_view *a_view, a_type a_value) \
+  { \
+    a_type buffer[ARRAYOPS_BLOCK]; \
+    size_t start, count, index; \
+    assert(a_view); \
+    assert(a_view->m_elemsize == sizeof(a_type)); \
+    if (array_view_contiguous(a_view)) \
+    { \
+      return __arrayops()->m_find_##a_suffix((const a_type *) a_view->m_base, a_view->m_count, a_value); \
+    } \
+    for (start = 0; start < a_view->m_count; start += count) \
+    { \
+      count = min(a_view->m_count - start, ARRAYOPS_BLOCK); \
+      __view_gather(a_view, start, count, buffer); \
+      index = __arrayops()->m_find_##a_suffix(buffer, count, a_value); \
+      if (index != ARRAY_NOT_FOUND) \
+      { \
+        return start + index; \
+      } \
+    } \
+    return ARRAY_NOT_FOUND; \
+  } \
+  \
+  size_t _array_view_count_##a_suffix(const struct array_view *a_view, a_type a_value) \
+  { \
+    a_type buffer[ARRAYOPS_BLOCK]; \
+    size_t start, count, total; \
+    assert(a_view); \
+    assert(a_view->m_elemsize == sizeof(a_type)); \
+    if (array_view_contiguous(a_view)) \
+    { \
+      for (start = 0, total = 0; start < a_view->m_count; start += count) \
+      { \
+        count = min(a_view->m_count - start, ARRAYOPS_COUNT_BLOCK); \
+        total += __arrayops()->m_count_##a_suffix((const a_type *) a_view->m_base + start, count, a_value); \
+      } \
+      return total; \
+    } \
+    for (start = 0, total = 0; start < a_view->m_count; start += count) \
+    { \
+      count = min(a_view->m_count - start, ARRAYOPS_BLOCK); \
+      __view_gather(a_view, start, count, buffer); \
+      total += __arrayops()->m_count_##a_suffix(buffer, count, a_value); \
+    } \
+    return total; \
+  } \
+  \
+  size_t _array_view_min_##a_suffix(const struct array_view *a_view, a_type *a_value) \
+  { \
+    a_type buffer[ARRAYOPS_BLOCK]; \
+    a_type value; \
+    size_t start, count; \
+    assert(a_view); \
+    assert(a_view->m_elemsize == sizeof(a_type)); \
+    if (a_view->m_count == 0) \
+    { \
+      return ARRAY_NOT_FOUND; \
+    } \
+    if (array_view_contiguous(a_view)) \
+    { \
+      value = __arrayops()->m_min_##a_suffix((const a_type *) a_view->m_base, a_view->m_count); \
+    } \
+    else \
+    { \
+      for (start = 0; start < a_view->m_count; start += count) \
+      { \
+        count = min(a_view->m_count - start, ARRAYOPS_BLOCK); \
+        __view_gather(a_view, start, count, buffer); \
+        buffer[0] = __arrayops()->m_min_##a_suffix(buffer, count); \
+        value = (start == 0) ? buffer[0] : min(value, buffer[0]); \
+      } \
+    } \
+    if (a_value) \
+    { \
+      *a_value = value; \
+    } \
+    return _array_view_find_##a_suffix(a_view, value); \
+  } \
+  \
+  size_t _array_view_max_##a_suffix(const struct array_view *a_view, a_type *a_value) \
+  { \
+    a_type buffer[ARRAYOPS_BLOCK]; \
+    a_type value; \
+    size_t start, count; \
+    assert(a_view); \
+    assert(a_view->m_elemsize == sizeof(a_type)); \
+    if (a_view->m_count == 0) \
+    { \
+      return ARRAY_NOT_FOUND; \
+    } \
+    if (array_view_contiguous(a_view)) \
+    { \
+      value = __arrayops()->m_max_##a_suffix((const a_type *) a_view->m_base, a_view->m_count); \
+    } \
+    else \
+    { \
+      for (start = 0; start < a_view->m_count; start += count) \
+      { \
+        count = min(a_view->m_count - start, ARRAYOPS_BLOCK); \
+        __view_gather(a_view, start, count, buffer); \
+        buffer[0] = __arrayops()->m_max_##a_suffix(buffer, count); \
+        value = (start == 0) ? buffer[0] : max(value, buffer[0]); \
+      } \
+    } \
+    if (a_value) \
+    { \
+      *a_value = value; \
+    } \
+    return _array_view_find_##a_suffix(a_view, value); \
+  } \
+  \
+  a_sumtype _array_view_sum_##a_suffix(const struct array_view *a_view) \
+  { \
+    a_type buffer[ARRAYOPS_BLOCK]; \
+    a_sumtype sum; \
+    size_t start, count; \
+    assert(a_view); \
+    assert(a_view->m_elemsize == sizeof(a_type)); \
+    if (array_view_contiguous(a_view)) \
+    { \
+      return __arrayops()->m_sum_##a_suffix((const a_type *) a_view->m_base, a_view->m_count); \
+    } \
+    for (start = 0, sum = 0; start < a_view->m_count; start += count) \
+    { \
+      count = min(a_view->m_count - start, ARRAYOPS_BLOCK); \
+      __view_gather(a_view, start, count, buffer); \
+      sum += __arrayops()->m_sum_##a_suffix(buffer, count); \
+    } \
+    return sum; \
+  } \
+  \
+  size_t _array_view_compare_##a_suffix(const struct array_view *a_view, const struct array_view *a_other) \
+  { \
+    a_type buffer[ARRAYOPS_BLOCK], other[ARRAYOPS_BLOCK]; \
+    size_t start, count, total, index; \
+    assert(a_view); \
+    assert(a_other); \
+    assert(a_view->m_elemsize == sizeof(a_type)); \
+    assert(a_other->m_elemsize == sizeof(a_type)); \
+    total = min(a_view->m_count, a_other->m_count); \
+    index = ARRAY_NOT_FOUND; \
+    if (array_view_contiguous(a_view) && array_view_contiguous(a_other)) \
+    { \
+      index = __arrayops()->m_compare_##a_suffix((const a_type *) a_view->m_base, (const a_type *) a_other->m_base, total); \
+    } \
+    else \
+    { \
+      for (start = 0; start < total && index == ARRAY_NOT_FOUND; start += count) \
+      { \
+        count = min(total - start, ARRAYOPS_BLOCK); \
+        __view_gather(a_view, start, count, buffer); \
+        __view_gather(a_other, start, count, other); \
+        index = ARRAYOPS_TAIL(__arrayops()->m_compare_##a_suffix(buffer, other, count), start); \
+      } \
+    } \
+    if (index == ARRAY_NOT_FOUND && a_view->m_count != a_other->m_count) \
+    { \
+      return total; \
+    } \
+    return index; \
+  } \
+  \
+  void _array_fill_##a_suffix(struct array *a_array, a_type a_value) \
+  { \
+    struct array_view view; \
+    array_view_array(&view, a_array, 0, array_count(a_array)); \
+    _array_view_fill_##a_suffix(&view, a_value); \
+  } \
+  \
+  size_t _array_find_##a_suffix(struct array *a_array, a_type a_value) \
+  { \
+    struct array_view view; \
+    array_view_array(&view, a_array, 0, array_count(a_array)); \
+    return _array_view_find_##a_suffix(&view, a_value); \
+  } \
+  \
+  size_t _array_count_##a_suffix(struct array *a_array, a_type a_value) \
+  { \
+    struct array_view view; \
+    array_view_array(&view, a_array, 0, array_count(a_array)); \
+    return _array_view_count_##a_suffix(&view, a_value); \
+  } \
+  \
+  size_t _array_min_##a_suffix(struct array *a_array, a_type *a_value) \
+  { \
+    struct array_view view; \
+    array_view_array(&view, a_array, 0, array_count(a_array)); \
+    return _array_view_min_##a_suffix(&view, a_value); \
+  } \
+  \
+  size_t _array_max_##a_suffix(struct array *a_array, a_type *a_value) \
+  { \
+    struct array_view view; \
+    array_view_array(&view, a_array, 0, array_count(a_array)); \
+    return _array_view_max_##a_suffix(&view, a_value); \
+  } \
+  \
+  a_sumtype _array_sum_##a_suffix(struct array *a_array) \
+  { \
+    struct array_view view; \
+    array_view_array(&view, a_array, 0, array_count(a_array)); \
+    return _array_view_sum_##a_suffix(&view); \
+  } \
+  \
+  size_t _array_compare_##a_suffix(struct array *a_array, struct array *a_other) \
+  { \
+    struct array_view view, other; \
+    array_view_array(&view, a_array, 0, array_count(a_array)); \
+    array_view_array(&other, a_other, 0, array_count(a_other)); \
+    return _array_view_compare_##a_suffix(&view, &other); \
+  }
+
+ARRAYOPS_INTERFACE(i32, int32, int64, uint32, m_fill32)
+ARRAYOPS_INTERFACE(i64, int64, int64, uint64, m_fill64)
+ARRAYOPS_INTERFACE(f32, float, double, uint32, m_fill32)
+ARRAYOPS_INTERFACE(f64, double, double, uint64, m_fill64)
+
+
+// -- EOF
+
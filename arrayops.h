@@ -0,0 +1,416 @@
+
+#ifndef __h_arrayops
+#define __h_arrayops
+
+#ifdef  __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "config.h"
+
+// forward declarations
+typedef struct array;
+typedef struct array_view;
+
+// the bulk operations work on arrays and array views of 32 and 64 bit ints and floats, using avx2 or
+// sse2 when the cpu supports them. the element size of the array must match the type of the operation.
+// views with a stride are copied a block at a time into a buffer for the simd kernels. the result of
+// min, max and sum is not specified for float arrays that contain nans.
+
+// the index returned by find, min, max and compare when there is no element to return
+#define ARRAY_NOT_FOUND ((size_t) -1)
+
+// set every element in an array of 32 bit ints to a value
+// a_array the array to operate on
+// a_value the value to set
+#define array_fill_i32(a_array, a_value) _array_fill_i32(a_array, a_value)
+
+// find the first element in an array of 32 bit ints that is equal to a value
+// a_array the array to operate on
+// a_value the value to find
+// returns the index of the element, or ARRAY_NOT_FOUND if no elements match
+#define array_find_i32(a_array, a_value) _array_find_i32(a_array, a_value)
+
+// count the elements in an array of 32 bit ints that are equal to a value
+// a_array the array to operate on
+// a_value the value to count
+// returns the number of elements that match
+#define array_count_i32(a_array, a_value) _array_count_i32(a_array, a_value)
+
+// find the smallest element in an array of 32 bit ints
+// a_array the array to operate on
+// a_value set to the smallest value if not 0
+// returns the index of the first smallest element, or ARRAY_NOT_FOUND if the array is empty
+#define array_min_i32(a_array, a_value) _array_min_i32(a_array, a_value)
+
+// find the largest element in an array of 32 bit ints
+// a_array the array to operate on
+// a_value set to the largest value if not 0
+// returns the index of the first largest element, or ARRAY_NOT_FOUND if the array is empty
+#define array_max_i32(a_array, a_value) _array_max_i32(a_array, a_value)
+
+// add all elements in an array of 32 bit ints
+// a_array the array to operate on
+// returns the sum of the elements
+#define array_sum_i32(a_array) _array_sum_i32(a_array)
+
+// compare the elements of two arrays of 32 bit ints
+// a_array the array to compare
+// a_other the array to compare with
+// returns the index of the first element that differs, or ARRAY_NOT_FOUND if the arrays are equal. if one array is
+// shorter and all of its elements match, the shorter count is returned.
+#define array_compare_i32(a_array, a_other) _array_compare_i32(a_array, a_other)
+
+// set every element in an array of 64 bit ints to a value
+// a_array the array to operate on
+// a_value the value to set
+#define array_fill_i64(a_array, a_value) _array_fill_i64(a_array, a_value)
+
+// find the first element in an array of 64 bit ints that is equal to a value
+// a_array the array to operate on
+// a_value the value to find
+// returns the index of the element, or ARRAY_NOT_FOUND if no elements match
+#define array_find_i64(a_array, a_value) _array_find_i64(a_array, a_value)
+
+// count the elements in an array of 64 bit ints that are equal to a value
+// a_array the array to operate on
+// a_value the value to count
+// returns the number of elements that match
+#define array_count_i64(a_array, a_value) _array_count_i64(a_array, a_value)
+
+// find the smallest element in an array of 64 bit ints
+// a_array the array to operate on
+// a_value set to the smallest value if not 0
+// returns the index of the first smallest element, or ARRAY_NOT_FOUND if the array is empty
+#define array_min_i64(a_array, a_value) _array_min_i64(a_array, a_value)
+
+// find the largest element in an array of 64 bit ints
+// a_array the array to operate on
+// a_value set to the largest value if not 0
+// returns the index of the first largest element, or ARRAY_NOT_FOUND if the array is empty
+#define array_max_i64(a_array, a_value) _array_max_i64(a_array, a_value)
+
+// add all elements in an array of 64 bit ints
+// a_array the array to operate on
+// returns the sum of the elements
+#define array_sum_i64(a_array) _array_sum_i64(a_array)
+
+// compare the elements of two arrays of 64 bit ints
+// a_array the array to compare
+// a_other the array to compare with
+// returns the index of the first element that differs, or ARRAY_NOT_FOUND if the arrays are equal. if one array is
+// shorter and all of its elements match, the shorter count is returned.
+#define array_compare_i64(a_array, a_other) _array_compare_i64(a_array, a_other)
+
+// set every element in an array of floats to a value
+// a_array the array to operate on
+// a_value the value to set
+#define array_fill_f32(a_array, a_value) _array_fill_f32(a_array, a_value)
+
+// find the first element in an array of floats that is equal to a value
+// a_array the array to operate on
+// a_value the value to find
+// returns the index of the element, or ARRAY_NOT_FOUND if no elements match
+#define array_find_f32(a_array, a_value) _array_find_f32(a_array, a_value)
+
+// count the elements in an array of floats that are equal to a value
+// a_array the array to operate on
+// a_value the value to count
+// returns the number of elements that match
+#define array_count_f32(a_array, a_value) _array_count_f32(a_array, a_value)
+
+// find the smallest element in an array of floats
+// a_array the array to operate on
+// a_value set to the smallest value if not 0
+// returns the index of the first smallest element, or ARRAY_NOT_FOUND if the array is empty
+#define array_min_f32(a_array, a_value) _array_min_f32(a_array, a_value)
+
+// find the largest element in an array of floats
+// a_array the array to operate on
+// a_value set to the largest value if not 0
+// returns the index of the first largest element, or ARRAY_NOT_FOUND if the array is empty
+#define array_max_f32(a_array, a_value) _array_max_f32(a_array, a_value)
+
+// add all elements in an array of floats
+// a_array the array to operate on
+// returns the sum of the elements
+#define array_sum_f32(a_array) _array_sum_f32(a_array)
+
+// compare the elements of two arrays of floats
+// a_array the array to compare
+// a_other the array to compare with
+// returns the index of the first element that differs, or ARRAY_NOT_FOUND if the arrays are equal. if one array is
+// shorter and all of its elements match, the shorter count is returned.
+#define array_compare_f32(a_array, a_other) _array_compare_f32(a_array, a_other)
+
+// set every element in an array of doubles to a value
+// a_array the array to operate on
+// a_value the value to set
+#define array_fill_f64(a_array, a_value) _array_fill_f64(a_array, a_value)
+
+// find the first element in an array of doubles that is equal to a value
+// a_array the array to operate on
+// a_value the value to find
+// returns the index of the element, or ARRAY_NOT_FOUND if no elements match
+#define array_find_f64(a_array, a_value) _array_find_f64(a_array, a_value)
+
+// count the elements in an array of doubles that are equal to a value
+// a_array the array to operate on
+// a_value the value to count
+// returns the number of elements that match
+#define array_count_f64(a_array, a_value) _array_count_f64(a_array, a_value)
+
+// find the smallest element in an array of doubles
+// a_array the array to operate on
+// a_value set to the smallest value if not 0
+// returns the index of the first smallest element, or ARRAY_NOT_FOUND if the array is empty
+#define array_min_f64(a_array, a_value) _array_min_f64(a_array, a_value)
+
+// find the largest element in an array of doubles
+// a_array the array to operate on
+// a_value set to the largest value if not 0
+// returns the index of the first largest element, or ARRAY_NOT_FOUND if the array is empty
+#define array_max_f64(a_array, a_value) _array_max_f64(a_array, a_value)
+
+// add all elements in an array of doubles
+// a_array the array to operate on
+// returns the sum of the elements
+#define array_sum_f64(a_array) _array_sum_f64(a_array)
+
+// compare the elements of two arrays of doubles
+// a_array the array to compare
+// a_other the array to compare with
+// returns the index of the first element that differs, or ARRAY_NOT_FOUND if the arrays are equal. if one array is
+// shorter and all of its elements match, the shorter count is returned.
+#define array_compare_f64(a_array, a_other) _array_compare_f64(a_array, a_other)
+
+// set every element in an view of 32 bit ints to a value
+// a_view the view to operate on
+// a_value the value to set
+#define array_view_fill_i32(a_view, a_value) _array_view_fill_i32(a_view, a_value)
+
+// find the first element in an view of 32 bit ints that is equal to a value
+// a_view the view to operate on
+// a_value the value to find
+// returns the index of the element, or ARRAY_NOT_FOUND if no elements match
+#define array_view_find_i32(a_view, a_value) _array_view_find_i32(a_view, a_value)
+
+// count the elements in an view of 32 bit ints that are equal to a value
+// a_view the view to operate on
+// a_value the value to count
+// returns the number of elements that match
+#define array_view_count_i32(a_view, a_value) _array_view_count_i32(a_view, a_value)
+
+// find the smallest element in an view of 32 bit ints
+// a_view the view to operate on
+// a_value set to the smallest value if not 0
+// returns the index of the first smallest element, or ARRAY_NOT_FOUND if the view is empty
+#define array_view_min_i32(a_view, a_value) _array_view_min_i32(a_view, a_value)
+
+// find the largest element in an view of 32 bit ints
+// a_view the view to operate on
+// a_value set to the largest value if not 0
+// returns the index of the first largest element, or ARRAY_NOT_FOUND if the view is empty
+#define array_view_max_i32(a_view, a_value) _array_view_max_i32(a_view, a_value)
+
+// add all elements in an view of 32 bit ints
+// a_view the view to operate on
+// returns the sum of the elements
+#define array_view_sum_i32(a_view) _array_view_sum_i32(a_view)
+
+// compare the elements of two views of 32 bit ints
+// a_view the view to compare
+// a_other the view to compare with
+// returns the index of the first element that differs, or ARRAY_NOT_FOUND if the views are equal. if one view is
+// shorter and all of its elements match, the shorter count is returned.
+#define array_view_compare_i32(a_view, a_other) _array_view_compare_i32(a_view, a_other)
+
+// set every element in an view of 64 bit ints to a value
+// a_view the view to operate on
+// a_value the value to set
+#define array_view_fill_i64(a_view, a_value) _array_view_fill_i64(a_view, a_value)
+
+// find the first element in an view of 64 bit ints that is equal to a value
+// a_view the view to operate on
+// a_value the value to find
+// returns the index of the element, or ARRAY_NOT_FOUND if no elements match
+#define array_view_find_i64(a_view, a_value) _array_view_find_i64(a_view, a_value)
+
+// count the elements in an view of 64 bit ints that are equal to a value
+// a_view the view to operate on
+// a_value the value to count
+// returns the number of elements that match
+#define array_view_count_i64(a_view, a_value) _array_view_count_i64(a_view, a_value)
+
+// find the smallest element in an view of 64 bit ints
+// a_view the view to operate on
+// a_value set to the smallest value if not 0
+// returns the index of the first smallest element, or ARRAY_NOT_FOUND if the view is empty
+#define array_view_min_i64(a_view, a_value) _array_view_min_i64(a_view, a_value)
+
+// find the largest element in an view of 64 bit ints
+// a_view the view to operate on
+// a_value set to the largest value if not 0
+// returns the index of the first largest element, or ARRAY_NOT_FOUND if the view is empty
+#define array_view_max_i64(a_view, a_value) _array_view_max_i64(a_view, a_value)
+
+// add all elements in an view of 64 bit ints
+// a_view the view to operate on
+// returns the sum of the elements
+#define array_view_sum_i64(a_view) _array_view_sum_i64(a_view)
+
+// compare the elements of two views of 64 bit ints
+// a_view the view to compare
+// a_other the view to compare with
+// returns the index of the first element that differs, or ARRAY_NOT_FOUND if the views are equal. if one view is
+// shorter and all of its elements match, the shorter count is returned.
+#define array_view_compare_i64(a_view, a_other) _array_view_compare_i64(a_view, a_other)
+
+// set every element in an view of floats to a value
+// a_view the view to operate on
+// a_value the value to set
+#define array_view_fill_f32(a_view, a_value) _array_view_fill_f32(a_view, a_value)
+
+// find the first element in an view of floats that is equal to a value
+// a_view the view to operate on
+// a_value the value to find
+// returns the index of the element, or ARRAY_NOT_FOUND if no elements match
+#define array_view_find_f32(a_view, a_value) _array_view_find_f32(a_view, a_value)
+
+// count the elements in an view of floats that are equal to a value
+// a_view the view to operate on
+// a_value the value to count
+// returns the number of elements that match
+#define array_view_count_f32(a_view, a_value) _array_view_count_f32(a_view, a_value)
+
+// find the smallest element in an view of floats
+// a_view the view to operate on
+// a_value set to the smallest value if not 0
+// returns the index of the first smallest element, or ARRAY_NOT_FOUND if the view is empty
+#define array_view_min_f32(a_view, a_value) _array_view_min_f32(a_view, a_value)
+
+// find the largest element in an view of floats
+// a_view the view to operate on
+// a_value set to the largest value if not 0
+// returns the index of the first largest element, or ARRAY_NOT_FOUND if the view is empty
+#define array_view_max_f32(a_view, a_value) _array_view_max_f32(a_view, a_value)
+
+// add all elements in an view of floats
+// a_view the view to operate on
+// returns the sum of the elements
+#define array_view_sum_f32(a_view) _array_view_sum_f32(a_view)
+
+// compare the elements of two views of floats
+// a_view the view to compare
+// a_other the view to compare with
+// returns the index of the first element that differs, or ARRAY_NOT_FOUND if the views are equal. if one view is
+// shorter and all of its elements match, the shorter count is returned.
+#define array_view_compare_f32(a_view, a_other) _array_view_compare_f32(a_view, a_other)
+
+// set every element in an view of doubles to a value
+// a_view the view to operate on
+// a_value the value to set
+#define array_view_fill_f64(a_view, a_value) _array_view_fill_f64(a_view, a_value)
+
+// find the first element in an view of doubles that is equal to a value
+// a_view the view to operate on
+// a_value the value to find
+// returns the index of the element, or ARRAY_NOT_FOUND if no elements match
+#define array_view_find_f64(a_view, a_value) _array_view_find_f64(a_view, a_value)
+
+// count the elements in an view of doubles that are equal to a value
+// a_view the view to operate on
+// a_value the value to count
+// returns the number of elements that match
+#define array_view_count_f64(a_view, a_value) _array_view_count_f64(a_view, a_value)
+
+// find the smallest element in an view of doubles
+// a_view the view to operate on
+// a_value set to the smallest value if not 0
+// returns the index of the first smallest element, or ARRAY_NOT_FOUND if the view is empty
+#define array_view_min_f64(a_view, a_value) _array_view_min_f64(a_view, a_value)
+
+// find the largest element in an view of doubles
+// a_view the view to operate on
+// a_value set to the largest value if not 0
+// returns the index of the first largest element, or ARRAY_NOT_FOUND if the view is empty
+#define array_view_max_f64(a_view, a_value) _array_view_max_f64(a_view, a_value)
+
+// add all elements in an view of doubles
+// a_view the view to operate on
+// returns the sum of the elements
+#define array_view_sum_f64(a_view) _array_view_sum_f64(a_view)
+
+// compare the elements of two views of doubles
+// a_view the view to compare
+// a_other the view to compare with
+// returns the index of the first element that differs, or ARRAY_NOT_FOUND if the views are equal. if one view is
+// shorter and all of its elements match, the shorter count is returned.
+#define array_view_compare_f64(a_view, a_other) _array_view_compare_f64(a_view, a_other)
+
+// interface functions
+void _array_fill_i32(struct array *a_array, int32 a_value);
+size_t _array_find_i32(struct array *a_array, int32 a_value);
+size_t _array_count_i32(struct array *a_array, int32 a_value);
+size_t _array_min_i32(struct array *a_array, int32 *a_value);
+size_t _array_max_i32(struct array *a_array, int32 *a_value);
+int64 _array_sum_i32(struct array *a_array);
+size_t _array_compare_i32(struct array *a_array, struct array *a_other);
+void _array_fill_i64(struct array *a_array, int64 a_value);
+size_t _array_find_i64(struct array *a_array, int64 a_value);
+size_t _array_count_i64(struct array *a_array, int64 a_value);
+size_t _array_min_i64(struct array *a_array, int64 *a_value);
+size_t _array_max_i64(struct array *a_array, int64 *a_value);
+int64 _array_sum_i64(struct array *a_array);
+size_t _array_compare_i64(struct array *a_array, struct array *a_other);
+void _array_fill_f32(struct array *a_array, float a_value);
+size_t _array_find_f32(struct array *a_array, float a_value);
+size_t _array_count_f32(struct array *a_array, float a_value);
+size_t _array_min_f32(struct array *a_array, float *a_value);
+size_t _array_max_f32(struct array *a_array, float *a_value);
+double _array_sum_f32(struct array *a_array);
+size_t _array_compare_f32(struct array *a_array, struct array *a_other);
+void _array_fill_f64(struct array *a_array, double a_value);
+size_t _array_find_f64(struct array *a_array, double a_value);
+size_t _array_count_f64(struct array *a_array, double a_value);
+size_t _array_min_f64(struct array *a_array, double *a_value);
+size_t _array_max_f64(struct array *a_array, double *a_value);
+double _array_sum_f64(struct array *a_array);
+size_t _array_compare_f64(struct array *a_array, struct array *a_other);
+void _array_view_fill_i32(struct array_view *a_view, int32 a_value);
+size_t _array_view_find_i32(const struct array_view *a_view, int32 a_value);
+size_t _array_view_count_i32(const struct array_view *a_view, int32 a_value);
+size_t _array_view_min_i32(const struct array_view *a_view, int32 *a_value);
+size_t _array_view_max_i32(const struct array_view *a_view, int32 *a_value);
+int64 _array_view_sum_i32(const struct array_view *a_view);
+size_t _array_view_compare_i32(const struct array_view *a_view, const struct array_view *a_other);
+void _array_view_fill_i64(struct array_view *a_view, int64 a_value);
+size_t _array_view_find_i64(const struct array_view *a_view, int64 a_value);
+size_t _array_view_count_i64(const struct array_view *a_view, int64 a_value);
+size_t _array_view_min_i64(const struct array_view *a_view, int64 *a_value);
+size_t _array_view_max_i64(const struct array_view *a_view, int64 *a_value);
+int64 _array_view_sum_i64(const struct array_view *a_view);
+size_t _array_view_compare_i64(const struct array_view *a_view, const struct array_view *a_other);
+void _array_view_fill_f32(struct array_view *a_view, float a_value);
+size_t _array_view_find_f32(const struct array_view *a_view, float a_value);
+size_t _array_view_count_f32(const struct array_view *a_view, float a_value);
+size_t _array_view_min_f32(const struct array_view *a_view, float *a_value);
+size_t _array_view_max_f32(const struct array_view *a_view, float *a_value);
+double _array_view_sum_f32(const struct array_view *a_view);
+size_t _array_view_compare_f32(const struct array_view *a_view, const struct array_view *a_other);
+void _array_view_fill_f64(struct array_view *a_view, double a_value);
+size_t _array_view_find_f64(const struct array_view *a_view, double a_value);
+size_t _array_view_count_f64(const struct array_view *a_view, double a_value);
+size_t _array_view_min_f64(const struct array_view *a_view, double *a_value);
+size_t _array_view_max_f64(const struct array_view *a_view, double *a_value);
+double _array_view_sum_f64(const struct array_view *a_view);
+size_t _array_view_compare_f64(const struct array_view *a_view, const struct array_view *a_other);
+
+#ifdef  __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __h_arrayops
+
+// -- EOF
+
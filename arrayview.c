@@ -0,0 +1,111 @@
+
+#include "arrayview.h"
+
+#include <assert.h>
+#include <stdlib.h>
+
+#include "array.h"
+#include "vector.h"
+
+
+// make a view of a range of elements in an array
+void _array_view_array(struct array_view *a_view, struct array *a_array, size_t a_start, size_t a_count)
+{
+  // checks
+  assert(a_array);
+  assert(a_start <= array_count(a_array) && a_count <= array_count(a_array) - a_start);
+
+  _array_view_memory(a_view, (char *) array_data(a_array) + a_start * array_elemsize(a_array), array_elemsize(a_array), a_count);
+}
+
+
+// make a view of a range of elements in a vector
+void _array_view_vector(struct array_view *a_view, struct vector *a_vector, size_t a_start, size_t a_count)
+{
+  // checks
+  assert(a_vector);
+  assert(a_start <= vector_count(a_vector) && a_count <= vector_count(a_vector) - a_start);
+
+  _array_view_memory(a_view, (char *) vector_data(a_vector) + a_start * vector_elemsize(a_vector), vector_elemsize(a_vector), a_count);
+}
+
+
+// make a view of contiguous elements in memory
+void _array_view_memory(struct array_view *a_view, void *a_data, size_t a_elemsize, size_t a_count)
+{
+  // checks
+  assert(a_view);
+  assert(a_data || a_count == 0);
+  assert(a_elemsize > 0);
+
+  a_view->m_base = (char *) a_data;
+  a_view->m_count = a_count;
+  a_view->m_elemsize = a_elemsize;
+  a_view->m_stride = a_elemsize;
+}
+
+
+// make a view of a range of elements in another view
+void _array_view_slice(struct array_view *a_view, const struct array_view *a_source, size_t a_start, size_t a_count)
+{
+  // checks
+  assert(a_view);
+  assert(a_source);
+  assert(a_start <= a_source->m_count && a_count <= a_source->m_count - a_start);
+
+  a_view->m_base = a_source->m_base + a_start * a_source->m_stride;
+  a_view->m_count = a_count;
+  a_view->m_elemsize = a_source->m_elemsize;
+  a_view->m_stride = a_source->m_stride;
+}
+
+
+// make a view of every nth element in another view
+void _array_view_stride(struct array_view *a_view, const struct array_view *a_source, size_t a_start, size_t a_step)
+{
+  // checks
+  assert(a_view);
+  assert(a_source);
+  assert(a_start <= a_source->m_count);
+  assert(a_step > 0 && a_step <= ((size_t) ~0) / a_source->m_stride);
+
+  a_view->m_base = a_source->m_base + a_start * a_source->m_stride;
+  a_view->m_count = (a_source->m_count - a_start) / a_step + ((a_source->m_count - a_start) % a_step != 0);
+  a_view->m_elemsize = a_source->m_elemsize;
+  a_view->m_stride = a_source->m_stride * a_step;
+}
+
+
+// make a view of one of a number of equal parts of another view
+void _array_view_split(struct array_view *a_view, const struct array_view *a_source, int a_parts, int a_part)
+{
+  // locals
+  size_t size, extra, start;
+
+  // checks
+  assert(a_source);
+  assert(a_parts > 0);
+  assert(a_part >= 0 && a_part < a_parts);
+
+  // the first parts take one of the elements left over each
+  size = a_source->m_count / a_parts;
+  extra = a_source->m_count % a_parts;
+  start = a_part * size + min((size_t) a_part, extra);
+
+  _array_view_slice(a_view, a_source, start, size + ((size_t) a_part < extra));
+}
+
+
+// get a pointer to an element in a view
+void *_array_view_index(const struct array_view *a_view, size_t a_index)
+{
+  // checks
+  assert(a_view);
+  assert(a_index < a_view->m_count);
+
+  return a_view->m_base + a_index * a_view->m_stride;
+}
+
+
+// -- EOF
+
@@ -0,0 +1,106 @@
+
+#ifndef __h_arrayview
+#define __h_arrayview
+
+#ifdef  __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "config.h"
+
+// forward declarations
+typedef struct array;
+typedef struct vector;
+
+// a view of elements in an array, a vector or other memory, which does not own or allocate any memory.
+// the elements are m_stride bytes apart, so a view can also select every nth element. a view of a
+// vector is no longer valid once the vector is resized.
+struct array_view
+{
+  char *m_base;       // a pointer to the first element
+  size_t m_count;     // the number of elements in the view
+  size_t m_elemsize;  // the size of each element
+  size_t m_stride;    // the number of bytes between the start of each element
+};
+
+// make a view of a range of elements in an array
+// a_view the view to set
+// a_array the array to view
+// a_start the index of the first element in the view
+// a_count the number of elements in the view
+#define array_view_array(a_view, a_array, a_start, a_count) _array_view_array(a_view, a_array, a_start, a_count)
+
+// make a view of a range of elements in a vector
+// a_view the view to set
+// a_vector the vector to view
+// a_start the index of the first element in the view
+// a_count the number of elements in the view
+#define array_view_vector(a_view, a_vector, a_start, a_count) _array_view_vector(a_view, a_vector, a_start, a_count)
+
+// make a view of contiguous elements in memory
+// a_view the view to set
+// a_data a pointer to the first element
+// a_elemsize the size of each element
+// a_count the number of elements in the view
+#define array_view_memory(a_view, a_data, a_elemsize, a_count) _array_view_memory(a_view, a_data, a_elemsize, a_count)
+
+// make a view of a range of elements in another view
+// a_view the view to set
+// a_source the view to take the range from
+// a_start the index of the first element in the source view
+// a_count the number of elements in the view
+#define array_view_slice(a_view, a_source, a_start, a_count) _array_view_slice(a_view, a_source, a_start, a_count)
+
+// make a view of every nth element in another view
+// a_view the view to set
+// a_source the view to take the elements from
+// a_start the index of the first element in the source view
+// a_step the number of source elements between each element in the view
+#define array_view_stride(a_view, a_source, a_start, a_step) _array_view_stride(a_view, a_source, a_start, a_step)
+
+// make a view of one of a number of equal parts of another view, which is used to divide work between
+// threads. the first parts are one element larger when the count does not divide evenly.
+// a_view the view to set
+// a_source the view to divide
+// a_parts the number of parts to divide the source view into
+// a_part the index of the part to view
+#define array_view_split(a_view, a_source, a_parts, a_part) _array_view_split(a_view, a_source, a_parts, a_part)
+
+// get the number of elements in a view
+// a_view the view to operate on
+// returns the number of elements
+#define array_view_count(a_view) ((a_view)->m_count)
+
+// get the size of each element in a view
+// a_view the view to operate on
+// returns the element size
+#define array_view_elemsize(a_view) ((a_view)->m_elemsize)
+
+// check if the elements in a view are next to each other in memory
+// a_view the view to operate on
+// returns 1 if the elements are contiguous, otherwise 0
+#define array_view_contiguous(a_view) ((a_view)->m_stride == (a_view)->m_elemsize)
+
+// gets a pointer to an element in a view
+// a_view the view to operate on
+// a_index the index of the element to get a pointer to
+// returns a pointer to the element
+#define array_view_index(a_view, a_index) _array_view_index(a_view, a_index)
+
+// interface functions
+void _array_view_array(struct array_view *a_view, struct array *a_array, size_t a_start, size_t a_count);
+void _array_view_vector(struct array_view *a_view, struct vector *a_vector, size_t a_start, size_t a_count);
+void _array_view_memory(struct array_view *a_view, void *a_data, size_t a_elemsize, size_t a_count);
+void _array_view_slice(struct array_view *a_view, const struct array_view *a_source, size_t a_start, size_t a_count);
+void _array_view_stride(struct array_view *a_view, const struct array_view *a_source, size_t a_start, size_t a_step);
+void _array_view_split(struct array_view *a_view, const struct array_view *a_source, int a_parts, int a_part);
+void *_array_view_index(const struct array_view *a_view, size_t a_index);
+
+#ifdef  __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __h_arrayview
+
+// -- EOF
+
@@ -0,0 +1,243 @@
+
+#include "bitset.h"
+
+#include <assert.h>
+#include <emmintrin.h>
+#include <intrin.h>
+#include <memory.h>
+#include <stdlib.h>
+
+#include "cpu.h"
+#include "memorypool.h"
+
+// the number of words for a number of bits
+#define BITSET_WORDS(a_count) (((a_count) + 63) >> 6)
+
+// the word and sse2 forms of the set operations
+#define BITSET_WORD_AND(a_left, a_right)    ((a_left) & (a_right))
+#define BITSET_WORD_OR(a_left, a_right)     ((a_left) | (a_right))
+#define BITSET_WORD_XOR(a_left, a_right)    ((a_left) ^ (a_right))
+#define BITSET_WORD_ANDNOT(a_left, a_right) ((a_left) & ~(a_right))
+#define BITSET_SSE2_AND(a_left, a_right)    _mm_and_si128(a_left, a_right)
+#define BITSET_SSE2_OR(a_left, a_right)     _mm_or_si128(a_left, a_right)
+#define BITSET_SSE2_XOR(a_left, a_right)    _mm_xor_si128(a_left, a_right)
+#define BITSET_SSE2_ANDNOT(a_left, a_right) _mm_andnot_si128(a_right, a_left)
+
+
+int __bitset_lowest(uint64 a_word);
+int __popcount_word(uint64 a_word);
+
+
+// allocate a new bitset
+struct bitset *_bitset_alloc(int a_count, struct memorypool *a_pool, const char *a_file, int a_line)
+{
+  // locals
+  struct bitset *ptr;
+
+  // checks
+  assert(a_count >= 0);
+
+  // allocate the bitset structure memory
+  ptr = (struct bitset *) _palloc(a_file, a_line, a_pool, sizeof(struct bitset));
+  assert(ptr);
+
+  ptr->m_count = a_count;
+  ptr->m_pool = a_pool;
+  ptr->m_words = 0;
+
+  // allocate the words with all bits cleared
+  if (a_count > 0)
+  {
+    ptr->m_words = (uint64 *) _palloc(a_file, a_line, a_pool, BITSET_WORDS(a_count) * sizeof(uint64));
+    assert(ptr->m_words);
+
+    memset(ptr->m_words, 0, BITSET_WORDS(a_count) * sizeof(uint64));
+  }
+
+  // return a pointer to the bitset
+  return ptr;
+}
+
+
+// free a bitset
+void _bitset_free(struct bitset *a_bitset)
+{
+  // checks
+  assert(a_bitset);
+
+  if (a_bitset->m_words)
+  {
+    pfree(a_bitset->m_pool, a_bitset->m_words);
+  }
+
+  pfree(a_bitset->m_pool, a_bitset);
+}
+
+
+// set all bits
+void _bitset_set_all(struct bitset *a_bitset)
+{
+  // checks
+  assert(a_bitset);
+
+  if (a_bitset->m_count == 0)
+  {
+    return;
+  }
+
+  memset(a_bitset->m_words, 0xff, BITSET_WORDS(a_bitset->m_count) * sizeof(uint64));
+
+  // keep the bits past the end cleared
+  if (a_bitset->m_count & 63)
+  {
+    a_bitset->m_words[BITSET_WORDS(a_bitset->m_count) - 1] = ((uint64) 1 << (a_bitset->m_count & 63)) - 1;
+  }
+}
+
+
+// clear all bits
+void _bitset_clear_all(struct bitset *a_bitset)
+{
+  // checks
+  assert(a_bitset);
+
+  memset(a_bitset->m_words, 0, BITSET_WORDS(a_bitset->m_count) * sizeof(uint64));
+}
+
+
+// count the bits that are set
+int _bitset_popcount(struct bitset *a_bitset)
+{
+  // locals
+  const uint64 *words;
+  int i, count, total;
+
+  // checks
+  assert(a_bitset);
+
+  words = a_bitset->m_words;
+  count = BITSET_WORDS(a_bitset->m_count);
+  total = 0;
+
+  if (cpu_features() & CPU_POPCNT)
+  {
+    for (i = 0; i < count; i++)
+    {
+      total += __popcnt((uint32) words[i]) + __popcnt((uint32) (words[i] >> 32));
+    }
+  }
+  else
+  {
+    for (i = 0; i < count; i++)
+    {
+      total += __popcount_word(words[i]);
+    }
+  }
+
+  return total;
+}
+
+
+// find the next bit that is set
+int _bitset_find_next(struct bitset *a_bitset, int a_start)
+{
+  // locals
+  uint64 word;
+  int i, count;
+
+  // checks
+  assert(a_bitset);
+  assert(a_start >= 0);
+
+  if (a_start >= a_bitset->m_count)
+  {
+    return -1;
+  }
+
+  // ignore the bits before the start in the first word
+  i = a_start >> 6;
+  word = a_bitset->m_words[i] & (~(uint64) 0 << (a_start & 63));
+  count = BITSET_WORDS(a_bitset->m_count);
+
+  for (;;)
+  {
+    if (word)
+    {
+      return (i << 6) + __bitset_lowest(word);
+    }
+
+    if (++i >= count)
+    {
+      return -1;
+    }
+
+    word = a_bitset->m_words[i];
+  }
+}
+
+
+// the set operations, which use sse2 for two words at a time if the cpu supports it
+#define BITSET_COMBINE(a_name, a_word, a_sse2) \
+  void _bitset_##a_name(struct bitset *a_bitset, struct bitset *a_other) \
+  { \
+    uint64 *dst; \
+    const uint64 *src; \
+    int i, count; \
+    assert(a_bitset); \
+    assert(a_other); \
+    assert(a_bitset->m_count == a_other->m_count); \
+    dst = a_bitset->m_words; \
+    src = a_other->m_words; \
+    count = BITSET_WORDS(a_bitset->m_count); \
+    i = 0; \
+    if (cpu_features() & CPU_SSE2) \
+    { \
+      for (; i + 2 <= count; i += 2) \
+      { \
+        _mm_storeu_si128((__m128i *) (dst + i), a_sse2(_mm_loadu_si128((const __m128i *) (dst + i)), _mm_loadu_si128((const __m128i *) (src + i)))); \
+      } \
+    } \
+    for (; i < count; i++) \
+    { \
+      dst[i] = a_word(dst[i], src[i]); \
+    } \
+  }
+
+BITSET_COMBINE(and, BITSET_WORD_AND, BITSET_SSE2_AND)
+BITSET_COMBINE(or, BITSET_WORD_OR, BITSET_SSE2_OR)
+BITSET_COMBINE(xor, BITSET_WORD_XOR, BITSET_SSE2_XOR)
+BITSET_COMBINE(andnot, BITSET_WORD_ANDNOT, BITSET_SSE2_ANDNOT)
+
+
+// get the index of the lowest set bit in a word
+int __bitset_lowest(uint64 a_word)
+{
+  // locals
+  unsigned long index;
+
+  // checks
+  assert(a_word);
+
+  if ((uint32) a_word)
+  {
+    _BitScanForward(&index, (uint32) a_word);
+    return (int) index;
+  }
+
+  _BitScanForward(&index, (uint32) (a_word >> 32));
+  return (int) index + 32;
+}
+
+
+// count the bits that are set in a word, for cpus without the popcnt instruction
+int __popcount_word(uint64 a_word)
+{
+  a_word = a_word - ((a_word >> 1) & 0x5555555555555555);
+  a_word = (a_word & 0x3333333333333333) + ((a_word >> 2) & 0x3333333333333333);
+  a_word = (a_word + (a_word >> 4)) & 0x0f0f0f0f0f0f0f0f;
+  return (int) ((a_word * 0x0101010101010101) >> 56);
+}
+
+
+// -- EOF
+
@@ -0,0 +1,136 @@
+
+#ifndef __h_bitset
+#define __h_bitset
+
+#ifdef  __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "config.h"
+
+#include <assert.h>
+
+// forward declarations
+typedef struct memorypool;
+
+// structure for the bitset, which is public so the single bit operations can be inlined. the bits past
+// the end of the bitset in the last word are always 0.
+struct bitset
+{
+  uint64 *m_words;            // the bits, 64 to a word
+  int m_count;                // the number of bits
+  struct memorypool *m_pool;  // the memory allocator
+};
+
+// allocate a new bitset with all bits cleared
+// a_count the number of bits
+// a_pool the memory pool to allocate from
+// returns the newly allocated bitset
+#define bitset_alloc(a_count, a_pool) _bitset_alloc(a_count, a_pool, __FILE__, __LINE__)
+
+// free the bitset and all allocated memory
+// a_bitset the bitset to operate on
+#define bitset_free(a_bitset) _bitset_free(a_bitset)
+
+// get the number of bits in the bitset
+// a_bitset the bitset to operate on
+// returns the number of bits
+#define bitset_count(a_bitset) ((a_bitset)->m_count)
+
+// set a bit
+// a_bitset the bitset to operate on
+// a_index the index of the bit
+#define bitset_set(a_bitset, a_index) _bitset_set(a_bitset, a_index)
+
+// clear a bit
+// a_bitset the bitset to operate on
+// a_index the index of the bit
+#define bitset_clear(a_bitset, a_index) _bitset_clear(a_bitset, a_index)
+
+// test a bit
+// a_bitset the bitset to operate on
+// a_index the index of the bit
+// returns 1 if the bit is set, otherwise 0
+#define bitset_test(a_bitset, a_index) _bitset_test(a_bitset, a_index)
+
+// set all bits
+// a_bitset the bitset to operate on
+#define bitset_set_all(a_bitset) _bitset_set_all(a_bitset)
+
+// clear all bits
+// a_bitset the bitset to operate on
+#define bitset_clear_all(a_bitset) _bitset_clear_all(a_bitset)
+
+// count the bits that are set, with the popcnt instruction if the cpu supports it
+// a_bitset the bitset to operate on
+// returns the number of bits that are set
+#define bitset_popcount(a_bitset) _bitset_popcount(a_bitset)
+
+// find the next bit that is set
+// a_bitset the bitset to operate on
+// a_start the index of the first bit to check
+// returns the index of the next set bit, or -1 if there are no more set bits
+#define bitset_find_next(a_bitset, a_start) _bitset_find_next(a_bitset, a_start)
+
+// the set operations combine a bitset with another bitset of the same size a word (or an sse2 register)
+// at a time, storing the result in the first bitset
+
+// keep the bits that are also set in another bitset
+// a_bitset the bitset to operate on
+// a_other the bitset to combine with
+#define bitset_and(a_bitset, a_other) _bitset_and(a_bitset, a_other)
+
+// set the bits that are set in another bitset
+// a_bitset the bitset to operate on
+// a_other the bitset to combine with
+#define bitset_or(a_bitset, a_other) _bitset_or(a_bitset, a_other)
+
+// flip the bits that are set in another bitset
+// a_bitset the bitset to operate on
+// a_other the bitset to combine with
+#define bitset_xor(a_bitset, a_other) _bitset_xor(a_bitset, a_other)
+
+// clear the bits that are set in another bitset
+// a_bitset the bitset to operate on
+// a_other the bitset to combine with
+#define bitset_andnot(a_bitset, a_other) _bitset_andnot(a_bitset, a_other)
+
+// interface functions
+struct bitset *_bitset_alloc(int a_count, struct memorypool *a_pool, const char *a_file, int a_line);
+void _bitset_free(struct bitset *a_bitset);
+void _bitset_set_all(struct bitset *a_bitset);
+void _bitset_clear_all(struct bitset *a_bitset);
+int _bitset_popcount(struct bitset *a_bitset);
+int _bitset_find_next(struct bitset *a_bitset, int a_start);
+void _bitset_and(struct bitset *a_bitset, struct bitset *a_other);
+void _bitset_or(struct bitset *a_bitset, struct bitset *a_other);
+void _bitset_xor(struct bitset *a_bitset, struct bitset *a_other);
+void _bitset_andnot(struct bitset *a_bitset, struct bitset *a_other);
+
+// inline functions
+static inline void _bitset_set(struct bitset *a_bitset, int a_index)
+{
+  assert(a_index >= 0 && a_index < a_bitset->m_count);
+  a_bitset->m_words[a_index >> 6] |= (uint64) 1 << (a_index & 63);
+}
+
+static inline void _bitset_clear(struct bitset *a_bitset, int a_index)
+{
+  assert(a_index >= 0 && a_index < a_bitset->m_count);
+  a_bitset->m_words[a_index >> 6] &= ~((uint64) 1 << (a_index & 63));
+}
+
+static inline int _bitset_test(struct bitset *a_bitset, int a_index)
+{
+  assert(a_index >= 0 && a_index < a_bitset->m_count);
+  return (int) (a_bitset->m_words[a_index >> 6] >> (a_index & 63)) & 1;
+}
+
+#ifdef  __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __h_bitset
+
+// -- EOF
+
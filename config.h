@@ -2,6 +2,10 @@
 #ifndef __h_config
 #define __h_config
 
+#include <assert.h>
+#include <stddef.h>
+#include <stdlib.h>
+
 // specify if memory pool allocations should use the pools, or if they should
 // use malloc and free.
 #define __h_config_memorypool_enabled 1
@@ -10,13 +14,37 @@
 // to find out who has not unallocated memory.
 #define __h_config_memory_pool_tracking 1
 
+// should each new chunk in a memory pool start its items at a different cache line offset, so the
+// same item in many chunks does not map to the same cache set (uses 64 to 575 bytes more per chunk)
+#define __h_config_memorypool_colouring 1
+
 // inline function definition
 #ifndef inline
 #define inline __forceinline
 #endif
 
 // types
+typedef int int32;
 typedef unsigned int uint32;
+typedef __int64 int64;
+typedef unsigned __int64 uint64;
+
+// narrow a size_t count or size to an int for the interfaces that still index with int (the flat map).
+// the check is kept in release builds, as a count that wraps would index the wrong elements.
+// a_size the count or size to narrow
+// returns the count or size as an int
+#define size_to_int(a_size) _size_to_int(a_size)
+
+static inline int _size_to_int(size_t a_size)
+{
+  if (a_size > 0x7fffffff)
+  {
+    assert(0);
+    abort();
+  }
+
+  return (int) a_size;
+}
 
 #endif // __h_config
 
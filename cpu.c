@@ -0,0 +1,76 @@
+
+#include "cpu.h"
+
+#include <intrin.h>
+
+// the detected features, or -1 if they have not been detected yet
+static int g_cpu_features = -1;
+
+
+int __cpu_detect();
+
+
+// get the features supported by the cpu
+int _cpu_features()
+{
+  // detect the features on the first call. this is safe to race as every thread detects the same value.
+  if (g_cpu_features < 0)
+  {
+    g_cpu_features = __cpu_detect();
+  }
+
+  return g_cpu_features;
+}
+
+
+// detect the features supported by the cpu
+int __cpu_detect()
+{
+  // locals
+  int info[4];
+  int features;
+
+  features = 0;
+
+  __cpuid(info, 1);
+
+  if (info[3] & (1 << 26))
+  {
+    features |= CPU_SSE2;
+  }
+
+  if (info[2] & (1 << 19))
+  {
+    features |= CPU_SSE41;
+  }
+
+  if (info[2] & (1 << 23))
+  {
+    features |= CPU_POPCNT;
+  }
+
+#if defined(_MSC_VER) && (_MSC_VER >= 1700)
+  // avx2 also needs the os to save the ymm registers (osxsave, avx and the xcr0 sse and avx bits)
+  if ((info[2] & (1 << 27)) && (info[2] & (1 << 28)) && (_xgetbv(0) & 6) == 6)
+  {
+    // the avx2 bit is in leaf 7, which older cpus do not have
+    __cpuid(info, 0);
+
+    if (info[0] >= 7)
+    {
+      __cpuidex(info, 7, 0);
+
+      if (info[1] & (1 << 5))
+      {
+        features |= CPU_AVX2;
+      }
+    }
+  }
+#endif
+
+  return features;
+}
+
+
+// -- EOF
+
@@ -0,0 +1,31 @@
+
+#ifndef __h_cpu
+#define __h_cpu
+
+#ifdef  __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "config.h"
+
+// cpu features
+#define CPU_SSE2    0x01
+#define CPU_SSE41   0x02
+#define CPU_POPCNT  0x04
+#define CPU_AVX2    0x08
+
+// gets the features supported by the cpu (and the os), which are detected on the first call
+// returns a combination of the CPU_ flags
+#define cpu_features() _cpu_features()
+
+// interface functions
+int _cpu_features();
+
+#ifdef  __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __h_cpu
+
+// -- EOF
+
@@ -23,7 +23,7 @@ struct cstring *_cstring_alloc(const char *a_str, struct memorypool *a_pool, con
 {
   struct cstring *c_str;
   char *data;
-  int length;
+  size_t length;
 
   c_str = (struct cstring *) _palloc(a_file, a_line, a_pool, sizeof(struct cstring));
   assert(c_str);
@@ -84,14 +84,14 @@ int _cstring_hash(struct cstring *a_cstr)
 }
 
 
-int _cstring_len(struct cstring *a_cstr)
+size_t _cstring_len(struct cstring *a_cstr)
 {
   assert(a_cstr);
   return vector_count(a_cstr->m_chars) - 1;
 }
 
 
-void _cstring_reserve(struct cstring *a_cstr, int a_count, const char *a_file, int a_line)
+void _cstring_reserve(struct cstring *a_cstr, size_t a_count, const char *a_file, int a_line)
 {
   assert(a_cstr);
   assert(a_count > cstring_len(a_cstr));
@@ -103,7 +103,7 @@ void _cstring_reserve(struct cstring *a_cstr, int a_count, const char *a_file, i
 void _cstring_set(struct cstring *a_cstr, const char *a_str, const char *a_file, int a_line)
 {
   char *data;
-  int length;
+  size_t length;
 
   assert(a_cstr);
   assert(a_str);
@@ -137,6 +137,7 @@ void _cstring_setf(struct cstring *a_cstr, const char *a_file, int a_line, const
   va_start(args, a_format);
 
   length = _vscprintf(a_format, args);
+  assert(length >= 0);
   _vector_resize(a_cstr->m_chars, length + 1, a_file, a_line);
 
   data = (char *) vector_data(a_cstr->m_chars);
@@ -150,7 +151,7 @@ void _cstring_setf(struct cstring *a_cstr, const char *a_file, int a_line, const
 void _cstring_cat(struct cstring *a_cstr, const char *a_str, const char *a_file, int a_line)
 {
   char *data;
-  int curlen, newlen;
+  size_t curlen, newlen;
 
   assert(a_cstr);
   assert(a_str);
@@ -173,7 +174,8 @@ void _cstring_cat(struct cstring *a_cstr, const char *a_str, const char *a_file,
 void _cstring_catf(struct cstring *a_cstr, const char *a_file, int a_line, const char *a_format, ...)
 {
   char *data;
-  int curlen, newlen;
+  size_t curlen;
+  int newlen;
   va_list args;
 
   assert(a_cstr);
@@ -185,7 +187,7 @@ void _cstring_catf(struct cstring *a_cstr, const char *a_file, int a_line, const
   assert(curlen);
 
   newlen = _vscprintf(a_format, args);
-  assert(newlen);
+  assert(newlen > 0);
 
   _vector_resize(a_cstr->m_chars, curlen + newlen, a_file, a_line);
   data = (char *) vector_data(a_cstr->m_chars);
@@ -197,7 +199,7 @@ void _cstring_catf(struct cstring *a_cstr, const char *a_file, int a_line, const
 }
 
 
-void _cstring_del(struct cstring *a_cstr, int a_start, int a_count)
+void _cstring_del(struct cstring *a_cstr, size_t a_start, size_t a_count)
 {
   assert(a_cstr);
   assert(a_count);
@@ -206,7 +208,7 @@ void _cstring_del(struct cstring *a_cstr, int a_start, int a_count)
 }
 
 
-void _cstring_ins(struct cstring *a_cstr, int a_start, int a_count, const char *a_str, const char *a_file, int a_line)
+void _cstring_ins(struct cstring *a_cstr, size_t a_start, size_t a_count, const char *a_str, const char *a_file, int a_line)
 {
   char *data;
 
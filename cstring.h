@@ -10,7 +10,7 @@ extern "C" {
 
 // forward declarations
 typedef struct cstring;
-typedef struct mempool;
+typedef struct memorypool;
 
 // hash a string into an int
 // a_str the string to hash
@@ -101,14 +101,14 @@ struct cstring *_cstring_alloc(const char *a_str, struct memorypool *a_pool, con
 void _cstring_free(struct cstring *a_cstr);
 const char *_cstring_cstr(struct cstring *a_cstr);
 int _cstring_hash(struct cstring *a_cstr);
-int _cstring_len(struct cstring *a_cstr);
-void _cstring_reserve(struct cstring *a_string, int a_count, const char *a_file, int a_line);
+size_t _cstring_len(struct cstring *a_cstr);
+void _cstring_reserve(struct cstring *a_string, size_t a_count, const char *a_file, int a_line);
 void _cstring_set(struct cstring *a_cstr, const char *a_str, const char *a_file, int a_line);
 void _cstring_setf(struct cstring *a_cstr, const char *a_file, int a_line, const char *a_format, ...);
 void _cstring_cat(struct cstring *a_cstr, const char *a_str, const char *a_file, int a_line);
 void _cstring_catf(struct cstring *a_cstr, const char *a_file, int a_line, const char *a_format, ...);
-void _cstring_del(struct cstring *a_cstr, int a_start, int a_count);
-void _cstring_ins(struct cstring *a_cstr, int a_start, int a_count, const char *a_str, const char *a_file, int a_line);
+void _cstring_del(struct cstring *a_cstr, size_t a_start, size_t a_count);
+void _cstring_ins(struct cstring *a_cstr, size_t a_start, size_t a_count, const char *a_str, const char *a_file, int a_line);
 
 #ifdef  __cplusplus
 }
@@ -0,0 +1,293 @@
+
+#include "deque.h"
+
+#include <assert.h>
+#include <memory.h>
+#include <stdlib.h>
+
+#include "memorypool.h"
+
+// the number of elements reserved when elements are first added to a deque
+#define DEQUE_MIN_CAPACITY 16
+
+// structure for the deque
+struct deque
+{
+  struct memorypool *m_pool;  // the memory allocator
+  int m_elemsize;             // the size of each element
+  int m_head;                 // the slot of the element at the front
+  int m_count;                // the number of elements in the deque
+  int m_capacity;             // the number of slots, which is 0 or a power of 2
+  char *m_data;               // the slots
+};
+
+
+// get a pointer to a slot
+static inline char *__deque_slot(struct deque *a_deque, int a_slot)
+{
+  return a_deque->m_data + a_deque->m_elemsize * (a_slot & (a_deque->m_capacity - 1));
+}
+
+
+// copy elements between the ring and linear memory, in at most two pieces as the ring wraps around
+// a_deque the deque to operate on
+// a_slot the slot of the first element
+// a_mem the linear memory
+// a_count the number of elements
+// a_toring non-zero to copy from a_mem into the ring, otherwise from the ring into a_mem
+static void __deque_copy(struct deque *a_deque, int a_slot, char *a_mem, int a_count, int a_toring)
+{
+  // locals
+  int first;
+  char *slot;
+
+  a_slot &= a_deque->m_capacity - 1;
+  first = min(a_count, a_deque->m_capacity - a_slot);
+  slot = a_deque->m_data + a_deque->m_elemsize * a_slot;
+
+  if (a_toring)
+  {
+    memcpy(slot, a_mem, a_deque->m_elemsize * first);
+    memcpy(a_deque->m_data, a_mem + a_deque->m_elemsize * first, a_deque->m_elemsize * (a_count - first));
+  }
+  else
+  {
+    memcpy(a_mem, slot, a_deque->m_elemsize * first);
+    memcpy(a_mem + a_deque->m_elemsize * first, a_deque->m_data, a_deque->m_elemsize * (a_count - first));
+  }
+}
+
+
+// make sure there is space for more elements
+static inline void __deque_grow(struct deque *a_deque, int a_count, const char *a_file, int a_line)
+{
+  if (a_deque->m_count + a_count > a_deque->m_capacity)
+  {
+    _deque_reserve(a_deque, a_deque->m_count + a_count, a_file, a_line);
+  }
+}
+
+
+// allocate a new deque
+struct deque *_deque_alloc(int a_elemsize, struct memorypool *a_pool, const char *a_file, int a_line)
+{
+  // locals
+  struct deque *ptr;
+
+  // checks
+  assert(a_elemsize > 0);
+
+  // allocate the deque structure memory
+  ptr = (struct deque *) _palloc(a_file, a_line, a_pool, sizeof(struct deque));
+  assert(ptr);
+
+  memset(ptr, 0, sizeof(struct deque));
+  ptr->m_pool = a_pool;
+  ptr->m_elemsize = a_elemsize;
+
+  // return a pointer to the deque
+  return ptr;
+}
+
+
+// free a deque
+void _deque_free(struct deque *a_deque)
+{
+  // checks
+  assert(a_deque);
+
+  if (a_deque->m_data)
+  {
+    pfree(a_deque->m_pool, a_deque->m_data);
+  }
+
+  pfree(a_deque->m_pool, a_deque);
+}
+
+
+// reserve space for a number of elements
+void _deque_reserve(struct deque *a_deque, int a_capacity, const char *a_file, int a_line)
+{
+  // locals
+  int capacity;
+  char *data;
+
+  // checks
+  assert(a_deque);
+  assert(a_capacity >= 0);
+
+  if (a_capacity <= a_deque->m_capacity)
+  {
+    return;
+  }
+
+  // double the capacity until the elements fit, so the slot can be found with a mask
+  capacity = max(a_deque->m_capacity, DEQUE_MIN_CAPACITY);
+
+  while (capacity < a_capacity)
+  {
+    assert(capacity < 0x40000000);
+    capacity <<= 1;
+  }
+
+  // copy the elements to the start of the new slots, which unwraps the ring
+  data = (char *) _palloc(a_file, a_line, a_deque->m_pool, a_deque->m_elemsize * capacity);
+  assert(data);
+
+  if (a_deque->m_data)
+  {
+    __deque_copy(a_deque, a_deque->m_head, data, a_deque->m_count, 0);
+    pfree(a_deque->m_pool, a_deque->m_data);
+  }
+
+  a_deque->m_data = data;
+  a_deque->m_capacity = capacity;
+  a_deque->m_head = 0;
+}
+
+
+// add an element to the back
+void *_deque_push_back(struct deque *a_deque, const char *a_file, int a_line)
+{
+  // checks
+  assert(a_deque);
+
+  __deque_grow(a_deque, 1, a_file, a_line);
+
+  return __deque_slot(a_deque, a_deque->m_head + a_deque->m_count++);
+}
+
+
+// add an element to the front
+void *_deque_push_front(struct deque *a_deque, const char *a_file, int a_line)
+{
+  // checks
+  assert(a_deque);
+
+  __deque_grow(a_deque, 1, a_file, a_line);
+
+  a_deque->m_head = (a_deque->m_head - 1) & (a_deque->m_capacity - 1);
+  a_deque->m_count++;
+
+  return __deque_slot(a_deque, a_deque->m_head);
+}
+
+
+// remove the element at the back
+void _deque_pop_back(struct deque *a_deque, void *a_dst)
+{
+  // checks
+  assert(a_deque);
+  assert(a_deque->m_count > 0);
+
+  a_deque->m_count--;
+
+  if (a_dst)
+  {
+    memcpy(a_dst, __deque_slot(a_deque, a_deque->m_head + a_deque->m_count), a_deque->m_elemsize);
+  }
+}
+
+
+// remove the element at the front
+void _deque_pop_front(struct deque *a_deque, void *a_dst)
+{
+  // checks
+  assert(a_deque);
+  assert(a_deque->m_count > 0);
+
+  if (a_dst)
+  {
+    memcpy(a_dst, __deque_slot(a_deque, a_deque->m_head), a_deque->m_elemsize);
+  }
+
+  a_deque->m_head = (a_deque->m_head + 1) & (a_deque->m_capacity - 1);
+  a_deque->m_count--;
+}
+
+
+// add copies of elements to the back
+void _deque_push_back_n(struct deque *a_deque, const void *a_src, int a_count, const char *a_file, int a_line)
+{
+  // checks
+  assert(a_deque);
+  assert(a_count >= 0);
+  assert(a_src || !a_count);
+
+  if (!a_count)
+  {
+    return;
+  }
+
+  __deque_grow(a_deque, a_count, a_file, a_line);
+
+  __deque_copy(a_deque, a_deque->m_head + a_deque->m_count, (char *) a_src, a_count, 1);
+  a_deque->m_count += a_count;
+}
+
+
+// remove elements from the front
+void _deque_pop_front_n(struct deque *a_deque, void *a_dst, int a_count)
+{
+  // checks
+  assert(a_deque);
+  assert(a_count >= 0 && a_count <= a_deque->m_count);
+
+  if (!a_count)
+  {
+    return;
+  }
+
+  if (a_dst)
+  {
+    __deque_copy(a_deque, a_deque->m_head, (char *) a_dst, a_count, 0);
+  }
+
+  a_deque->m_head = (a_deque->m_head + a_count) & (a_deque->m_capacity - 1);
+  a_deque->m_count -= a_count;
+}
+
+
+// remove all elements
+void _deque_clear(struct deque *a_deque)
+{
+  // checks
+  assert(a_deque);
+
+  a_deque->m_head = 0;
+  a_deque->m_count = 0;
+}
+
+
+// get the number of elements
+int _deque_count(struct deque *a_deque)
+{
+  // checks
+  assert(a_deque);
+
+  return a_deque->m_count;
+}
+
+
+// get the capacity
+int _deque_capacity(struct deque *a_deque)
+{
+  // checks
+  assert(a_deque);
+
+  return a_deque->m_capacity;
+}
+
+
+// get a pointer to an element
+void *_deque_index(struct deque *a_deque, int a_index)
+{
+  // checks
+  assert(a_deque);
+  assert(a_index >= 0 && a_index < a_deque->m_count);
+
+  return __deque_slot(a_deque, a_deque->m_head + a_index);
+}
+
+// -- EOF
+
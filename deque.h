@@ -0,0 +1,118 @@
+
+#ifndef __h_deque
+#define __h_deque
+
+#ifdef  __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "config.h"
+
+// forward declarations
+typedef struct deque;
+typedef struct memorypool;
+
+// a double ended queue stored in a ring buffer, where elements are added and removed at either end in
+// constant time. the capacity is a power of 2 and doubles when the deque is full. pointers to the
+// elements are no longer valid once elements are added.
+
+// allocate a new deque
+// a_elemsize the size of each element in the deque
+// a_pool the memory pool to allocate from
+// returns the newly allocated deque
+#define deque_alloc(a_elemsize, a_pool) _deque_alloc(a_elemsize, a_pool, __FILE__, __LINE__)
+
+// free the deque and all allocated memory
+// a_deque the deque to operate on
+#define deque_free(a_deque) _deque_free(a_deque)
+
+// reserve space so elements can be added without reallocating
+// a_deque the deque to operate on
+// a_capacity the number of elements to reserve space for
+#define deque_reserve(a_deque, a_capacity) _deque_reserve(a_deque, a_capacity, __FILE__, __LINE__)
+
+// add an element to the back of the deque
+// a_deque the deque to operate on
+// returns a pointer to the new element
+#define deque_push_back(a_deque) _deque_push_back(a_deque, __FILE__, __LINE__)
+
+// add an element to the front of the deque
+// a_deque the deque to operate on
+// returns a pointer to the new element
+#define deque_push_front(a_deque) _deque_push_front(a_deque, __FILE__, __LINE__)
+
+// remove the element at the back of the deque
+// a_deque the deque to operate on
+// a_dst the memory to copy the element to, or 0 to discard it
+#define deque_pop_back(a_deque, a_dst) _deque_pop_back(a_deque, a_dst)
+
+// remove the element at the front of the deque
+// a_deque the deque to operate on
+// a_dst the memory to copy the element to, or 0 to discard it
+#define deque_pop_front(a_deque, a_dst) _deque_pop_front(a_deque, a_dst)
+
+// add copies of elements to the back of the deque, in order
+// a_deque the deque to operate on
+// a_src the elements to copy
+// a_count the number of elements to copy
+#define deque_push_back_n(a_deque, a_src, a_count) _deque_push_back_n(a_deque, a_src, a_count, __FILE__, __LINE__)
+
+// remove elements from the front of the deque, in order
+// a_deque the deque to operate on
+// a_dst the memory to copy the elements to, or 0 to discard them
+// a_count the number of elements to remove, which must not be more than the count
+#define deque_pop_front_n(a_deque, a_dst, a_count) _deque_pop_front_n(a_deque, a_dst, a_count)
+
+// remove all elements from the deque
+// a_deque the deque to operate on
+#define deque_clear(a_deque) _deque_clear(a_deque)
+
+// get the number of elements in the deque
+// a_deque the deque to operate on
+// returns the number of elements
+#define deque_count(a_deque) _deque_count(a_deque)
+
+// get the number of elements that fit in the deque before it reallocates
+// a_deque the deque to operate on
+// returns the capacity
+#define deque_capacity(a_deque) _deque_capacity(a_deque)
+
+// get a pointer to an element, counting from the front of the deque
+// a_deque the deque to operate on
+// a_index the index of the element
+// returns a pointer to the element
+#define deque_index(a_deque, a_index) _deque_index(a_deque, a_index)
+
+// get a pointer to the element at the front of the deque
+// a_deque the deque to operate on
+// returns a pointer to the element
+#define deque_front(a_deque) _deque_index(a_deque, 0)
+
+// get a pointer to the element at the back of the deque
+// a_deque the deque to operate on
+// returns a pointer to the element
+#define deque_back(a_deque) _deque_index(a_deque, _deque_count(a_deque) - 1)
+
+// interface functions
+struct deque *_deque_alloc(int a_elemsize, struct memorypool *a_pool, const char *a_file, int a_line);
+void _deque_free(struct deque *a_deque);
+void _deque_reserve(struct deque *a_deque, int a_capacity, const char *a_file, int a_line);
+void *_deque_push_back(struct deque *a_deque, const char *a_file, int a_line);
+void *_deque_push_front(struct deque *a_deque, const char *a_file, int a_line);
+void _deque_pop_back(struct deque *a_deque, void *a_dst);
+void _deque_pop_front(struct deque *a_deque, void *a_dst);
+void _deque_push_back_n(struct deque *a_deque, const void *a_src, int a_count, const char *a_file, int a_line);
+void _deque_pop_front_n(struct deque *a_deque, void *a_dst, int a_count);
+void _deque_clear(struct deque *a_deque);
+int _deque_count(struct deque *a_deque);
+int _deque_capacity(struct deque *a_deque);
+void *_deque_index(struct deque *a_deque, int a_index);
+
+#ifdef  __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __h_deque
+
+// -- EOF
+
@@ -0,0 +1,312 @@
+
+#include "flatmap.h"
+
+#include <assert.h>
+#include <memory.h>
+#include <stdlib.h>
+
+#include "memorypool.h"
+#include "vector.h"
+
+// structure for the flat map
+struct flatmap
+{
+  struct memorypool *m_pool;  // the memory allocator
+  struct vector *m_keys;      // the keys in ascending order
+  struct vector *m_values;    // the values in the same order as the keys
+};
+
+
+// find the first key that is not less than a key. the search halves the range without a branch on
+// the comparison, so it does not stall on mispredictions, and it only reads the keys.
+static inline int __flatmap_lower_bound(const int *a_keys, int a_count, int a_key)
+{
+  // locals
+  const int *base;
+  int half;
+
+  if (!a_count)
+  {
+    return 0;
+  }
+
+  base = a_keys;
+
+  while (a_count > 1)
+  {
+    half = a_count >> 1;
+    base = (base[half] < a_key) ? base + half : base;
+    a_count -= half;
+  }
+
+  return (int) (base - a_keys) + (*base < a_key);
+}
+
+
+// allocate a new flat map
+struct flatmap *_flatmap_alloc(int a_valuesize, struct memorypool *a_pool, const char *a_file, int a_line)
+{
+  // locals
+  struct flatmap *ptr;
+
+  // checks
+  assert(a_valuesize > 0);
+
+  // allocate the map structure memory
+  ptr = (struct flatmap *) _palloc(a_file, a_line, a_pool, sizeof(struct flatmap));
+  assert(ptr);
+
+  ptr->m_pool = a_pool;
+  ptr->m_keys = _vector_alloc(sizeof(int), a_pool, a_file, a_line);
+  ptr->m_values = _vector_alloc(a_valuesize, a_pool, a_file, a_line);
+
+  // return a pointer to the map
+  return ptr;
+}
+
+
+// free a flat map
+void _flatmap_free(struct flatmap *a_map)
+{
+  // checks
+  assert(a_map);
+
+  vector_free(a_map->m_keys);
+  vector_free(a_map->m_values);
+  pfree(a_map->m_pool, a_map);
+}
+
+
+// get the number of items
+int _flatmap_count(struct flatmap *a_map)
+{
+  // checks
+  assert(a_map);
+
+  return size_to_int(vector_count(a_map->m_keys));
+}
+
+
+// find the first key that is not less than a key
+int _flatmap_lower_bound(struct flatmap *a_map, int a_key)
+{
+  // checks
+  assert(a_map);
+
+  return __flatmap_lower_bound((const int *) vector_data(a_map->m_keys), size_to_int(vector_count(a_map->m_keys)), a_key);
+}
+
+
+// find the item for a key
+int _flatmap_find(struct flatmap *a_map, int a_key)
+{
+  // locals
+  int index;
+
+  // checks
+  assert(a_map);
+
+  index = _flatmap_lower_bound(a_map, a_key);
+
+  if (index < size_to_int(vector_count(a_map->m_keys)) && ((int *) vector_data(a_map->m_keys))[index] == a_key)
+  {
+    return index;
+  }
+
+  return -1;
+}
+
+
+// get the value for a key
+void *_flatmap_get(struct flatmap *a_map, int a_key)
+{
+  // locals
+  int index;
+
+  index = _flatmap_find(a_map, a_key);
+  return (index < 0) ? 0 : vector_index(a_map->m_values, index);
+}
+
+
+// insert an item
+void *_flatmap_insert(struct flatmap *a_map, int a_key, const void *a_value, const char *a_file, int a_line)
+{
+  // locals
+  void *value;
+  int index, count;
+
+  // checks
+  assert(a_map);
+
+  index = _flatmap_lower_bound(a_map, a_key);
+  count = size_to_int(vector_count(a_map->m_keys));
+  assert(count < 0x7fffffff);
+
+  // make space for a new key, unless the key is already in the map
+  if (index == count)
+  {
+    *(int *) _vector_append(a_map->m_keys, 1, a_file, a_line) = a_key;
+    value = _vector_append(a_map->m_values, 1, a_file, a_line);
+  }
+  else if (((int *) vector_data(a_map->m_keys))[index] != a_key)
+  {
+    *(int *) _vector_insert(a_map->m_keys, index, 1, a_file, a_line) = a_key;
+    value = _vector_insert(a_map->m_values, index, 1, a_file, a_line);
+  }
+  else
+  {
+    value = vector_index(a_map->m_values, index);
+  }
+
+  if (a_value)
+  {
+    memcpy(value, a_value, vector_elemsize(a_map->m_values));
+  }
+
+  return value;
+}
+
+
+// insert a sorted run of items
+void _flatmap_insert_sorted(struct flatmap *a_map, const int *a_keys, const void *a_values, int a_count, const char *a_file, int a_line)
+{
+  // locals
+  int *keys;
+  char *values;
+  size_t valuesize;
+  int start, count, duplicates, i, j, k;
+
+  // checks
+  assert(a_map);
+  assert(a_count >= 0);
+  assert((a_keys && a_values) || !a_count);
+
+  if (!a_count)
+  {
+    return;
+  }
+
+  // the items before the first key in the run do not move
+  count = size_to_int(vector_count(a_map->m_keys));
+  start = _flatmap_lower_bound(a_map, a_keys[0]);
+
+  // count the keys in the run that are already in the map, which replace the value rather than add an item
+  keys = (int *) vector_data(a_map->m_keys);
+  duplicates = 0;
+
+  for (i = start, j = 0; i < count && j < a_count; )
+  {
+    assert(j == 0 || a_keys[j] > a_keys[j - 1]);
+
+    if (keys[i] < a_keys[j])
+    {
+      i++;
+    }
+    else if (keys[i] > a_keys[j])
+    {
+      j++;
+    }
+    else
+    {
+      duplicates++;
+      i++;
+      j++;
+    }
+  }
+
+  // grow both vectors once and merge from the back, so each item moves at most once. the map is indexed
+  // with int, so it holds fewer than 2G items
+  assert(a_count - duplicates <= 0x7fffffff - count);
+  _vector_resize(a_map->m_keys, count + a_count - duplicates, a_file, a_line);
+  _vector_resize(a_map->m_values, count + a_count - duplicates, a_file, a_line);
+
+  keys = (int *) vector_data(a_map->m_keys);
+  values = (char *) vector_data(a_map->m_values);
+  valuesize = vector_elemsize(a_map->m_values);
+
+  i = count - 1;
+  j = a_count - 1;
+  k = count + a_count - duplicates - 1;
+
+  while (j >= 0)
+  {
+    if (i >= start && keys[i] > a_keys[j])
+    {
+      keys[k] = keys[i];
+      memmove(values + (size_t) k * valuesize, values + (size_t) i * valuesize, valuesize);
+      i--;
+    }
+    else
+    {
+      // a key from the run replaces the same key in the map
+      if (i >= start && keys[i] == a_keys[j])
+      {
+        i--;
+      }
+
+      keys[k] = a_keys[j];
+      memcpy(values + (size_t) k * valuesize, (const char *) a_values + (size_t) j * valuesize, valuesize);
+      j--;
+    }
+
+    k--;
+  }
+}
+
+
+// remove an item
+void _flatmap_remove(struct flatmap *a_map, int a_index)
+{
+  // checks
+  assert(a_map);
+  assert(a_index >= 0 && a_index < size_to_int(vector_count(a_map->m_keys)));
+
+  vector_remove(a_map->m_keys, a_index, 1);
+  vector_remove(a_map->m_values, a_index, 1);
+}
+
+
+// find the items with keys in a range
+int _flatmap_range(struct flatmap *a_map, int a_min, int a_max, int *a_start)
+{
+  // locals
+  int start, end;
+
+  // checks
+  assert(a_map);
+  assert(a_start);
+
+  start = _flatmap_lower_bound(a_map, a_min);
+  end = start;
+
+  if (a_max >= a_min)
+  {
+    end = (a_max == 0x7fffffff) ? size_to_int(vector_count(a_map->m_keys)) : _flatmap_lower_bound(a_map, a_max + 1);
+  }
+
+  *a_start = start;
+  return end - start;
+}
+
+
+// get the key of an item
+int _flatmap_key(struct flatmap *a_map, int a_index)
+{
+  // checks
+  assert(a_map);
+
+  return *(int *) vector_index(a_map->m_keys, a_index);
+}
+
+
+// get the value of an item
+void *_flatmap_value(struct flatmap *a_map, int a_index)
+{
+  // checks
+  assert(a_map);
+
+  return vector_index(a_map->m_values, a_index);
+}
+
+// -- EOF
+
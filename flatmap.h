@@ -0,0 +1,115 @@
+
+#ifndef __h_flatmap
+#define __h_flatmap
+
+#ifdef  __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "config.h"
+
+// forward declarations
+typedef struct flatmap;
+typedef struct memorypool;
+
+// a map from unique keys to values, stored as a sorted vector of keys and a vector of values in the
+// same order. a lookup is a binary search over the keys alone, so it reads a few cache lines where a
+// tree or a sorted list reads a node per step, and iterating is a walk over contiguous memory. inserting
+// and removing single items moves the items after them, so the map suits keys that are read far more
+// often than they change, or changes that come in sorted batches. the items are addressed by their
+// index in key order, and pointers to the values are no longer valid once the map changes.
+
+// allocate a new flat map
+// a_valuesize the size of the value for each key
+// a_pool the memory pool to allocate from
+// returns the newly allocated flat map
+#define flatmap_alloc(a_valuesize, a_pool) _flatmap_alloc(a_valuesize, a_pool, __FILE__, __LINE__)
+
+// free the flat map and all allocated memory
+// a_map the map to operate on
+#define flatmap_free(a_map) _flatmap_free(a_map)
+
+// get the number of items in the map
+// a_map the map to operate on
+// returns the number of items
+#define flatmap_count(a_map) _flatmap_count(a_map)
+
+// find the first item with a key that is not less than a key
+// a_map the map to operate on
+// a_key the key to search for
+// returns the index of the item, or the count if every key is less than a_key
+#define flatmap_lower_bound(a_map, a_key) _flatmap_lower_bound(a_map, a_key)
+
+// find the item for a key
+// a_map the map to operate on
+// a_key the key to search for
+// returns the index of the item, or -1 if the key is not in the map
+#define flatmap_find(a_map, a_key) _flatmap_find(a_map, a_key)
+
+// get the value for a key
+// a_map the map to operate on
+// a_key the key to search for
+// returns a pointer to the value, or 0 if the key is not in the map
+#define flatmap_get(a_map, a_key) _flatmap_get(a_map, a_key)
+
+// insert an item, replacing the value if the key is already in the map
+// a_map the map to operate on
+// a_key the key to insert
+// a_value the value to copy to the key (if not 0)
+// returns a pointer to the value
+#define flatmap_insert(a_map, a_key, a_value) _flatmap_insert(a_map, a_key, a_value, __FILE__, __LINE__)
+
+// insert a run of items in one pass, replacing the values of keys that are already in the map
+// a_map the map to operate on
+// a_keys the keys to insert, in ascending order without duplicates
+// a_values the values for the keys, which are a_count values of the value size in a row
+// a_count the number of items to insert
+#define flatmap_insert_sorted(a_map, a_keys, a_values, a_count) _flatmap_insert_sorted(a_map, a_keys, a_values, a_count, __FILE__, __LINE__)
+
+// remove an item from the map
+// a_map the map to operate on
+// a_index the index of the item
+#define flatmap_remove(a_map, a_index) _flatmap_remove(a_map, a_index)
+
+// find the items with keys in a range, which are the items from the start index to the start plus the count
+// a_map the map to operate on
+// a_min the smallest key in the range
+// a_max the largest key in the range
+// a_start set to the index of the first item in the range
+// returns the number of items in the range
+#define flatmap_range(a_map, a_min, a_max, a_start) _flatmap_range(a_map, a_min, a_max, a_start)
+
+// get the key of an item
+// a_map the map to operate on
+// a_index the index of the item
+// returns the key
+#define flatmap_key(a_map, a_index) _flatmap_key(a_map, a_index)
+
+// get the value of an item
+// a_map the map to operate on
+// a_index the index of the item
+// returns a pointer to the value
+#define flatmap_value(a_map, a_index) _flatmap_value(a_map, a_index)
+
+// interface functions
+struct flatmap *_flatmap_alloc(int a_valuesize, struct memorypool *a_pool, const char *a_file, int a_line);
+void _flatmap_free(struct flatmap *a_map);
+int _flatmap_count(struct flatmap *a_map);
+int _flatmap_lower_bound(struct flatmap *a_map, int a_key);
+int _flatmap_find(struct flatmap *a_map, int a_key);
+void *_flatmap_get(struct flatmap *a_map, int a_key);
+void *_flatmap_insert(struct flatmap *a_map, int a_key, const void *a_value, const char *a_file, int a_line);
+void _flatmap_insert_sorted(struct flatmap *a_map, const int *a_keys, const void *a_values, int a_count, const char *a_file, int a_line);
+void _flatmap_remove(struct flatmap *a_map, int a_index);
+int _flatmap_range(struct flatmap *a_map, int a_min, int a_max, int *a_start);
+int _flatmap_key(struct flatmap *a_map, int a_index);
+void *_flatmap_value(struct flatmap *a_map, int a_index);
+
+#ifdef  __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __h_flatmap
+
+// -- EOF
+
@@ -3,21 +3,56 @@
 
 #include <assert.h>
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <conio.h>
 #include <memory.h>
 #include <crtdbg.h>
+#include <time.h>
+#include <windows.h>
 
 #include "array.h"
+#include "array2d.h"
+#include "arrayops.h"
+#include "arrayview.h"
+#include "bitset.h"
 #include "cstring.h"
+#include "deque.h"
+#include "flatmap.h"
 #include "vector.h"
 #include "tree.h"
 #include "sortedlist.h"
 #include "memorypool.h"
+#include "pagedarray.h"
+#include "queue.h"
+#include "segvector.h"
+#include "cpu.h"
+#include "parallel.h"
+#include "soatable.h"
+#include "sort.h"
+#include "threadpool.h"
 
 
 void test_memorypool();
+void test_memorypool_map();
+void test_memorypool_profile();
+void bench_memorypool_colour();
 void test_array();
+void test_arrayops();
+void test_array_map();
+void test_array_view();
+void test_sort();
+void test_parallel();
+void test_soa_table();
+void test_bitset();
+void test_pagedarray();
+void test_array2d();
 void test_vector();
+void test_deque();
+void test_segvector();
+void test_queue();
+void bench_queue();
+void test_flatmap();
 void test_string();
 void test_tree();
 void test_sortedlist();
@@ -32,19 +67,47 @@ static int e = 50;
 static int f = 60;
 
 
+ARRAY_DEFINE(intarray, int)
+VECTOR_DEFINE(intvector, int)
+VECTOR_DEFINE_INLINE(smallvector, int, 8)
+
+
 int main(int a_argc, char *a_argv[])
 {
   struct memorypool *globalpool;
+  struct threadpool *threadpool;
   globalpool = memorypool_alloc();
   memorypool_global(globalpool);
+  threadpool = threadpool_alloc(0, 0);
+  threadpool_global(threadpool);
 
   test_memorypool();
+  test_memorypool_map();
+  test_memorypool_profile();
+  bench_memorypool_colour();
   test_array();
+  test_arrayops();
+  test_array_map();
+  test_array_view();
+  test_sort();
+  test_parallel();
+  test_soa_table();
+  test_bitset();
+  test_pagedarray();
+  test_array2d();
   test_vector();
+  test_deque();
+  test_segvector();
+  test_queue();
+  bench_queue();
+  test_flatmap();
   test_string();
   test_sortedlist();
   test_tree();
 
+  threadpool_free(threadpool);
+  threadpool = 0;
+
   memorypool_free(globalpool);
   globalpool = 0;
 
@@ -77,65 +140,987 @@ void test_tree()
   tree_insert(items, 5, &e);
   tree_insert(items, 6, &f);
 
-  tree_enum(items, test_tree_func);
-  printf("--------------------------------\n\n");
+  tree_enum(items, test_tree_func);
+  printf("--------------------------------\n\n");
+
+  tree_find_remove(items, 5);
+  tree_find_remove(items, 6);
+  tree_find_remove(items, 4);
+  tree_insert(items, 6, &f);
+  tree_insert(items, 5, &e);
+  tree_insert(items, 4, &d);
+
+  tree_enum(items, test_tree_func);
+  printf("--------------------------------\n\n");
+
+  tree_find_remove_subtree(items, 4);
+  tree_find_remove(items, 2);
+  tree_insert(items, 2, &b);
+
+  tree_enum(items, test_tree_func);
+  printf("--------------------------------\n\n");
+
+  tree_free(items);
+}
+
+
+void test_array()
+{
+  struct array *items;
+  struct intarray *ints;
+  unsigned char *data;
+  int *intdata;
+  size_t count;
+  size_t elemsize;
+  size_t i;
+  int sum;
+
+  items = array_alloc(sizeof(int), 8, 0);
+  data = (unsigned char *) array_data(items);
+  
+  array_zero(items);
+
+  count = array_count(items);
+  elemsize = array_elemsize(items);
+  printf("Array: Count(%d), Size(%d)\n", (int) count, (int) elemsize);
+
+  array_resize(items, 10);
+  data = (unsigned char *) array_data(items);
+
+  count = array_count(items);
+  elemsize = array_elemsize(items);
+  printf("Array: Count(%d), Size(%d)\n", (int) count, (int) elemsize);
+
+  array_free(items);
+  items = 0;
+
+  ints = intarray_alloc(16, 0);
+
+  for (i = 0; i < intarray_count(ints); i++)
+  {
+    intarray_set(ints, i, (int) i);
+  }
+
+  sum = 0;
+  intdata = intarray_data(ints);
+  count = intarray_count(ints);
+
+  for (i = 0; i < count; i++)
+  {
+    sum += intdata[i];
+  }
+
+  printf("Typed array: Count(%d), Sum(%d)\n", (int) array_count(intarray_array(ints)), sum);
+
+  intarray_free(ints);
+  ints = 0;
+}
+
+
+void test_arrayops()
+{
+  struct array *items, *other;
+  int32 *data;
+  int32 value;
+  int64 sum;
+  size_t index;
+  int i;
+
+  printf("Cpu: Features(0x%x)\n", cpu_features());
+
+  // use an odd count so the simd kernels also run their scalar tail
+  items = array_alloc(sizeof(int32), 1001, 0);
+  other = array_alloc(sizeof(int32), 1001, 0);
+  data = (int32 *) array_data(items);
+
+  array_fill_i32(items, 7);
+  assert(array_count_i32(items, 7) == 1001);
+
+  for (i = 0; i < (int) array_count(items); i++)
+  {
+    data[i] = (i * 37) % 1001 - 500;
+  }
+
+  sum = array_sum_i32(items);
+  assert(sum == 0);
+
+  index = array_min_i32(items, &value);
+  assert(value == -500 && data[index] == -500);
+
+  index = array_max_i32(items, &value);
+  assert(value == 500 && data[index] == 500);
+
+  assert(array_find_i32(items, data[999]) == 999);
+  assert(array_find_i32(items, 1000) == ARRAY_NOT_FOUND);
+
+  memcpy(array_data(other), data, sizeof(int32) * 1001);
+  assert(array_compare_i32(items, other) == ARRAY_NOT_FOUND);
+
+  ((int32 *) array_data(other))[998]++;
+  assert(array_compare_i32(items, other) == 998);
+
+  printf("Array ops: Sum(%d), Min(%d), Max(%d)\n", (int) sum, data[array_min_i32(items, 0)], data[array_max_i32(items, 0)]);
+
+  array_free(other);
+  other = 0;
+
+  array_free(items);
+  items = 0;
+}
+
+
+void test_array_map()
+{
+  struct memorypool *pool;
+  struct array *items;
+  FILE *file;
+  int32 data[1000];
+  int i;
+
+  for (i = 0; i < 1000; i++)
+  {
+    data[i] = i;
+  }
+
+  file = fopen("test_array.map", "wb");
+  assert(file);
+  fwrite(data, sizeof(int32), 1000, file);
+  fclose(file);
+
+  items = array_map_file("test_array.map", sizeof(int32), ARRAY_MAP_READONLY | ARRAY_MAP_SEQUENTIAL, 0);
+  assert(items);
+  assert(array_count(items) == 1000);
+  assert(array_sum_i32(items) == 999 * 1000 / 2);
+  printf("Mapped array: Count(%d), Sum(%d)\n", (int) array_count(items), (int) array_sum_i32(items));
+
+  array_free(items);
+
+  // changes to a copy on write array are not written to the file. the array comes from its own pool.
+  pool = memorypool_alloc();
+  assert(pool);
+
+  items = array_map_file("test_array.map", sizeof(int32), ARRAY_MAP_COPYONWRITE | ARRAY_MAP_RANDOM, pool);
+  assert(items);
+
+  array_fill_i32(items, 1);
+  assert(array_sum_i32(items) == 1000);
+
+  array_free(items);
+  memorypool_free(pool);
+  pool = 0;
+
+  items = array_map_file("test_array.map", sizeof(int32), ARRAY_MAP_READONLY, 0);
+  assert(items);
+  assert(array_sum_i32(items) == 999 * 1000 / 2);
+
+  array_free(items);
+  items = 0;
+
+  // a file that is not a whole number of elements is not mapped
+  items = array_map_file("test_array.map", 3, ARRAY_MAP_READONLY, 0);
+  assert(!items);
+
+  // an empty file is an empty array
+  file = fopen("test_array.map", "wb");
+  assert(file);
+  fclose(file);
+
+  items = array_map_file("test_array.map", sizeof(int32), ARRAY_MAP_READONLY, 0);
+  assert(items);
+  assert(array_count(items) == 0);
+
+  array_free(items);
+  items = 0;
+
+  remove("test_array.map");
+}
+
+
+void test_array_view()
+{
+  struct vector *items;
+  struct array_view view, part, odd;
+  int32 *data;
+  int64 sum, total;
+  int i;
+
+  items = vector_alloc(sizeof(int32), 0);
+  data = (int32 *) vector_append(items, 1000);
+
+  for (i = 0; i < 1000; i++)
+  {
+    data[i] = i;
+  }
+
+  // split the vector into parts, as it would be for a number of threads
+  array_view_vector(&view, items, 0, vector_count(items));
+  total = 0;
+
+  for (i = 0; i < 3; i++)
+  {
+    array_view_split(&part, &view, 3, i);
+    total += array_view_sum_i32(&part);
+  }
+
+  sum = array_view_sum_i32(&view);
+  assert(sum == total);
+
+  // every odd element
+  array_view_stride(&odd, &view, 1, 2);
+  assert(array_view_count(&odd) == 500);
+  assert(array_view_sum_i32(&odd) == 500 * 500);
+  assert(array_view_find_i32(&odd, 7) == 3);
+  assert(array_view_find_i32(&odd, 8) == ARRAY_NOT_FOUND);
+
+  array_view_fill_i32(&odd, 0);
+  assert(array_view_count_i32(&view, 0) == 501);
+
+  printf("Array view: Count(%d), Sum(%d), Parts(%d)\n", (int) array_view_count(&view), (int) sum, (int) total);
+
+  vector_free(items);
+  items = 0;
+}
+
+
+void test_parallel_double(void *a_context, const struct array_view *a_range, size_t a_start)
+{
+  int32 *data;
+  size_t i;
+
+  data = (int32 *) array_view_index(a_range, 0);
+
+  for (i = 0; i < array_view_count(a_range); i++)
+  {
+    data[i] *= 2;
+  }
+}
+
+
+void test_parallel_sum(void *a_context, const struct array_view *a_range, size_t a_start, void *a_result)
+{
+  *(int64 *) a_result += array_view_sum_i32(a_range);
+}
+
+
+void test_parallel_combine(void *a_context, void *a_result, const void *a_partial)
+{
+  *(int64 *) a_result += *(const int64 *) a_partial;
+}
+
+
+void test_parallel()
+{
+  struct array *items;
+  int32 *data;
+  int64 sum;
+  int i;
+
+  items = array_alloc(sizeof(int32), 1000000, 0);
+  data = (int32 *) array_data(items);
+
+  for (i = 0; i < (int) array_count(items); i++)
+  {
+    data[i] = i % 1000;
+  }
+
+  array_parallel_for(items, 0, test_parallel_double, 0);
+  assert(data[999] == 1998);
+
+  sum = 0;
+  array_parallel_reduce(items, 0, test_parallel_sum, test_parallel_combine, 0, &sum, sizeof(sum));
+  assert(sum == (int64) 999 * 1000 * 1000);
+
+  // a small grain gives more chunks than threads
+  sum = 0;
+  array_parallel_reduce(items, 1000, test_parallel_sum, test_parallel_combine, 0, &sum, sizeof(sum));
+  assert(sum == (int64) 999 * 1000 * 1000);
+
+  printf("Parallel: Count(%d), Sum(%d)\n", (int) array_count(items), (int) (sum / 1000));
+
+  array_free(items);
+  items = 0;
+}
+
+
+struct test_sort_record
+{
+  float m_key;
+  int m_value;
+};
+
+
+int test_sort_compare(const void *a_left, const void *a_right)
+{
+  return *(const int *) a_left - *(const int *) a_right;
+}
+
+
+void test_sort()
+{
+  struct vector *items;
+  struct array *records;
+  struct test_sort_record *record;
+  int *data;
+  int i, count;
+
+  // enough elements to be split across the threads
+  count = 200000;
+
+  items = vector_alloc(sizeof(int), 0);
+  data = (int *) vector_append(items, count);
+
+  for (i = 0; i < count; i++)
+  {
+    data[i] = rand();
+  }
+
+  vector_sort(items, test_sort_compare);
+
+  for (i = 1; i < count; i++)
+  {
+    assert(data[i - 1] <= data[i]);
+  }
+
+  vector_free(items);
+  items = 0;
+
+  // sort records by a float key, equal keys keep their order
+  records = array_alloc(sizeof(struct test_sort_record), count, 0);
+  record = (struct test_sort_record *) array_data(records);
+
+  for (i = 0; i < count; i++)
+  {
+    record[i].m_key = (float) (rand() % 1000 - 500) * 0.5f;
+    record[i].m_value = i;
+  }
+
+  array_radix_sort(records, SORT_KEY_F32, 0);
+
+  for (i = 1; i < count; i++)
+  {
+    assert(record[i - 1].m_key < record[i].m_key || (record[i - 1].m_key == record[i].m_key && record[i - 1].m_value < record[i].m_value));
+  }
+
+  printf("Sort: Count(%d), Threads(%d), First(%f), Last(%f)\n", count, threadpool_threads(0), record[0].m_key, record[count - 1].m_key);
+
+  array_free(records);
+  records = 0;
+}
+
+
+void test_soa_table()
+{
+  struct soa_table *table;
+  struct array_view view;
+  int elemsizes[3];
+  int i, row;
+
+  // a table of records with an id, a price and a quantity
+  elemsizes[0] = sizeof(int32);
+  elemsizes[1] = sizeof(double);
+  elemsizes[2] = sizeof(int32);
+
+  table = soa_table_alloc(3, elemsizes, 0);
+
+  for (i = 0; i < 100; i++)
+  {
+    row = soa_table_append(table, 1);
+    *(int32 *) soa_table_index(table, row, 0) = i;
+    *(double *) soa_table_index(table, row, 1) = i * 0.5;
+    *(int32 *) soa_table_index(table, row, 2) = i % 10;
+  }
+
+  // remove the first ten rows, the columns stay in step
+  soa_table_remove(table, 0, 10);
+  assert(soa_table_count(table) == 90);
+  assert(*(int32 *) soa_table_index(table, 0, 0) == 10);
+  assert(*(double *) soa_table_index(table, 0, 1) == 5.0);
+
+  // scan just the quantity column
+  soa_table_view(table, 2, &view);
+  assert(array_view_count_i32(&view, 0) == 9);
+
+  soa_table_view(table, 1, &view);
+  printf("Soa table: Rows(%d), Columns(%d), Total(%f)\n", soa_table_count(table), soa_table_columns(table), array_view_sum_f64(&view));
+
+  soa_table_free(table);
+  table = 0;
+
+  // an empty table has no column data to free
+  table = soa_table_alloc(3, elemsizes, 0);
+  assert(soa_table_count(table) == 0);
+  soa_table_free(table);
+  table = 0;
+}
+
+
+void test_bitset()
+{
+  struct bitset *evens, *thirds;
+  int i, index, count;
+
+  evens = bitset_alloc(1000, 0);
+  thirds = bitset_alloc(1000, 0);
+
+  for (i = 0; i < 1000; i++)
+  {
+    if (i % 2 == 0)
+    {
+      bitset_set(evens, i);
+    }
+
+    if (i % 3 == 0)
+    {
+      bitset_set(thirds, i);
+    }
+  }
+
+  assert(bitset_popcount(evens) == 500);
+  assert(bitset_popcount(thirds) == 334);
+
+  // keep the multiples of six
+  bitset_and(evens, thirds);
+  assert(bitset_test(evens, 6) && !bitset_test(evens, 4) && !bitset_test(evens, 9));
+
+  count = 0;
+  for (index = bitset_find_next(evens, 0); index >= 0; index = bitset_find_next(evens, index + 1))
+  {
+    assert(index % 6 == 0);
+    count++;
+  }
+
+  assert(count == 167);
+
+  // the multiples of three that are odd
+  bitset_andnot(thirds, evens);
+  assert(bitset_popcount(thirds) == 167);
+
+  bitset_set_all(evens);
+  bitset_xor(evens, thirds);
+  bitset_clear(evens, 0);
+  printf("Bitset: Count(%d), Set(%d), Multiples of six(%d)\n", bitset_count(evens), bitset_popcount(evens), count);
+
+  bitset_free(thirds);
+  bitset_free(evens);
+
+  // an empty bitset has no words to free
+  evens = bitset_alloc(0, 0);
+  assert(bitset_count(evens) == 0 && bitset_popcount(evens) == 0);
+  bitset_free(evens);
+}
+
+
+void test_pagedarray()
+{
+  struct pagedarray *items;
+  uint32 id;
+  int i, pages;
+
+  items = pagedarray_alloc(sizeof(int), 0);
+
+  // ids scattered across the whole 32 bit range
+  for (i = 0, id = 17; i < 1000; i++, id = id * 2654435761u + 1)
+  {
+    *(int *) pagedarray_index(items, id) = i + 1;
+  }
+
+  for (i = 0, id = 17; i < 1000; i++, id = id * 2654435761u + 1)
+  {
+    assert(*(const int *) pagedarray_get(items, id) == i + 1);
+  }
+
+  // reading does not allocate pages
+  pages = pagedarray_pages(items);
+  pagedarray_get(items, 0xfffffffe);
+  assert(pagedarray_pages(items) == pages);
+  printf("Paged array: Pages(%d), Page count(%d)\n", pagedarray_pages(items), pagedarray_page_count(items));
+
+  pagedarray_free(items);
+  items = 0;
+}
+
+
+void test_array2d()
+{
+  struct array2d *matrix, *transposed, *copy;
+  struct array2d_tile tile;
+  float sum;
+  int row, col, i, j;
+
+  matrix = array2d_alloc(100, 70, sizeof(float), ARRAY2D_ROWMAJOR, 0);
+  transposed = array2d_alloc(70, 100, sizeof(float), ARRAY2D_TILED, 0);
+
+  for (row = 0; row < 100; row++)
+  {
+    for (col = 0; col < 70; col++)
+    {
+      *(float *) array2d_index(matrix, row, col) = (float) (row * 1000 + col);
+    }
+  }
+
+  array2d_transpose(transposed, matrix);
+  assert(*(float *) array2d_index(transposed, 69, 99) == 99069.0f);
+  assert(*(float *) array2d_index(transposed, 5, 17) == 17005.0f);
+
+  // sum the first column of the matrix, which is the first row of the transposed tiles
+  sum = 0;
+  for (i = 0; i < array2d_tile_cols(transposed); i++)
+  {
+    array2d_tile(transposed, 0, i, &tile);
+
+    for (j = 0; j < tile.m_cols; j++)
+    {
+      sum += *(float *) array2d_tile_index(&tile, 0, j);
+    }
+  }
+
+  assert(sum == 4950000.0f);
+
+  // copy the transposed tiles to a row major layout
+  copy = array2d_alloc(70, 100, sizeof(float), ARRAY2D_ROWMAJOR, 0);
+  array2d_copy(copy, transposed);
+  assert(*(float *) array2d_index(copy, 5, 17) == 17005.0f);
+
+  printf("Array2d: Rows(%d), Cols(%d), Tiles(%d x %d), Column sum(%f)\n", array2d_rows(transposed), array2d_cols(transposed),
+    array2d_tile_rows(transposed), array2d_tile_cols(transposed), sum);
+
+  array2d_free(copy);
+  array2d_free(transposed);
+  array2d_free(matrix);
+
+  // arrays with no rows or no columns have no elements to free
+  matrix = array2d_alloc(0, 70, sizeof(float), ARRAY2D_ROWMAJOR, 0);
+  transposed = array2d_alloc(100, 0, sizeof(float), ARRAY2D_TILED, 0);
+  assert(array2d_rows(matrix) == 0 && array2d_tile_cols(transposed) == 0);
+
+  array2d_free(transposed);
+  array2d_free(matrix);
+}
+
+
+void test_deque()
+{
+  struct deque *queue;
+  int values[100];
+  int i, j, next, expected, value;
+
+  queue = deque_alloc(sizeof(int), 0);
+
+  // use the deque as a fifo that wraps around the ring many times
+  next = 0;
+  expected = 0;
+
+  for (i = 0; i < 1000; i++)
+  {
+    for (j = 0; j < 7; j++)
+    {
+      *(int *) deque_push_back(queue) = next++;
+    }
+
+    for (j = 0; j < 5; j++)
+    {
+      deque_pop_front(queue, &value);
+      assert(value == expected++);
+    }
+  }
+
+  assert(deque_count(queue) == 2000);
+  assert(*(int *) deque_front(queue) == expected);
+  assert(*(int *) deque_back(queue) == next - 1);
+  assert(*(int *) deque_index(queue, 1000) == expected + 1000);
+
+  // bulk pushes and pops are copied in at most two pieces where the ring wraps
+  for (i = 0; i < 100; i++)
+  {
+    values[i] = next + i;
+  }
+
+  deque_push_back_n(queue, values, 100);
+  deque_pop_front_n(queue, 0, 2000);
+  deque_pop_front_n(queue, values, 50);
+  assert(values[0] == next && values[49] == next + 49);
+  assert(deque_count(queue) == 50);
+
+  // both ends
+  *(int *) deque_push_front(queue) = -1;
+  deque_pop_back(queue, &value);
+  assert(value == next + 99);
+  assert(*(int *) deque_front(queue) == -1);
+
+  printf("Deque: Count(%d), Capacity(%d)\n", deque_count(queue), deque_capacity(queue));
+
+  deque_free(queue);
+  queue = 0;
+}
+
+
+void test_segvector()
+{
+  struct segvector *items;
+  struct array_view view;
+  int values[1000];
+  int *first;
+  int64 sum;
+  int i, segment;
+
+  items = segvector_alloc(sizeof(int), 0);
+
+  // pointers to the elements stay valid as the vector grows
+  first = (int *) segvector_push(items);
+  *first = -1;
+
+  for (i = 1; i < 100000; i++)
+  {
+    *(int *) segvector_push(items) = i;
+  }
+
+  assert(*first == -1);
+  assert(first == (int *) segvector_index(items, 0));
+
+  for (i = 0; i < 1000; i++)
+  {
+    values[i] = 100000 + i;
+  }
+
+  segvector_push_n(items, values, 1000);
+  assert(segvector_count(items) == 101000);
+  assert(*(int *) segvector_index(items, 65535) == 65535);
+  assert(*(int *) segvector_index(items, 100999) == 100999);
+
+  // iterate a segment at a time
+  sum = 0;
+
+  for (segment = 0; segment < segvector_segments(items); segment++)
+  {
+    segvector_segment(items, segment, &view);
+    sum += array_view_sum_i32(&view);
+  }
+
+  assert(sum == (int64) 101000 * 100999 / 2 - 1);
+
+  segvector_resize(items, 10);
+  assert(segvector_segments(items) == 1);
+  assert(*first == -1);
+
+  printf("Segmented vector: Count(%d), Segments(%d)\n", segvector_count(items), items->m_segmentcount);
+
+  segvector_free(items);
+  items = 0;
+}
+
+
+void test_queue()
+{
+  struct spscqueue *spsc;
+  struct mpmcqueue *mpmc;
+  int values[64];
+  int i, j, value;
+
+  spsc = spscqueue_alloc(sizeof(int), 50, 0);
+  mpmc = mpmcqueue_alloc(sizeof(int), 50, 0);
+
+  // the capacity is rounded up to 64, and a push fails when the queue is full
+  for (i = 0; i < 64; i++)
+  {
+    assert(spscqueue_push(spsc, &i));
+    assert(mpmcqueue_push(mpmc, &i));
+  }
+
+  assert(!spscqueue_push(spsc, &i));
+  assert(!mpmcqueue_push(mpmc, &i));
+
+  for (i = 0; i < 64; i++)
+  {
+    assert(spscqueue_pop(spsc, &value) && value == i);
+    assert(mpmcqueue_pop(mpmc, &value) && value == i);
+  }
+
+  assert(!spscqueue_pop(spsc, &value));
+  assert(!mpmcqueue_pop(mpmc, &value));
+
+  // batches wrap around the ring and stop at the space that is left
+  for (j = 0; j < 100; j++)
+  {
+    for (i = 0; i < 40; i++)
+    {
+      values[i] = j * 40 + i;
+    }
+
+    assert(spscqueue_push_n(spsc, values, 40) == 40);
+    assert(mpmcqueue_push_n(mpmc, values, 40) == 40);
+
+    memset(values, 0, sizeof(values));
+    assert(spscqueue_pop_n(spsc, values, 64) == 40);
+    assert(values[0] == j * 40 && values[39] == j * 40 + 39);
+
+    memset(values, 0, sizeof(values));
+    assert(mpmcqueue_pop_n(mpmc, values, 64) == 40);
+    assert(values[0] == j * 40 && values[39] == j * 40 + 39);
+  }
+
+  assert(spscqueue_push_n(spsc, values, 40) == 40);
+  assert(spscqueue_push_n(spsc, values, 40) == 24);
+  assert(mpmcqueue_push_n(mpmc, values, 40) == 40);
+  assert(mpmcqueue_push_n(mpmc, values, 40) == 24);
+
+  printf("Queue: spsc and mpmc passed\n");
+
+  mpmcqueue_free(mpmc);
+  mpmc = 0;
+  spscqueue_free(spsc);
+  spsc = 0;
+}
+
+
+// the number of elements the queue benchmark pushes or pops in each call
+#define BENCH_QUEUE_BATCH 16
+
+// the context of a queue benchmark run, where the first jobs are producers and the rest are consumers
+struct bench_queue_context
+{
+  struct spscqueue *m_spsc;
+  struct mpmcqueue *m_mpmc;
+  int m_producers;
+  int m_items;
+  volatile LONG m_popped;
+  int64 m_sums[8];
+};
+
+
+// push or pop the items for a queue benchmark job
+void bench_queue_job(void *a_context, int a_index)
+{
+  struct bench_queue_context *context;
+  int values[BENCH_QUEUE_BATCH];
+  int i, count, total;
+  int64 sum;
+
+  context = (struct bench_queue_context *) a_context;
+  total = context->m_items * context->m_producers;
+
+  if (a_index < context->m_producers)
+  {
+    // push this producer's share of the items, waiting while the queue is full
+    for (i = 0; i < context->m_items; i += count)
+    {
+      for (count = 0; count < BENCH_QUEUE_BATCH && i + count < context->m_items; count++)
+      {
+        values[count] = a_index * context->m_items + i + count;
+      }
+
+      count = context->m_spsc ? spscqueue_push_n(context->m_spsc, values, count) : mpmcqueue_push_n(context->m_mpmc, values, count);
+
+      if (!count)
+      {
+        SwitchToThread();
+      }
+    }
+  }
+  else
+  {
+    // pop items until every item has been popped by one of the consumers
+    sum = 0;
+
+    while (context->m_popped < total)
+    {
+      count = context->m_spsc ? spscqueue_pop_n(context->m_spsc, values, BENCH_QUEUE_BATCH) : mpmcqueue_pop_n(context->m_mpmc, values, BENCH_QUEUE_BATCH);
+
+      if (!count)
+      {
+        SwitchToThread();
+        continue;
+      }
+
+      for (i = 0; i < count; i++)
+      {
+        sum += values[i];
+      }
+
+      InterlockedExchangeAdd(&context->m_popped, count);
+    }
+
+    context->m_sums[a_index - context->m_producers] = sum;
+  }
+}
+
+
+void bench_queue()
+{
+  static const int producers[] = { 1, 1, 2, 4, 1, 4 };
+  static const int consumers[] = { 1, 1, 2, 4, 4, 1 };
+  struct bench_queue_context context;
+  struct threadpool *threads;
+  int64 sum, total;
+  int i, j;
+  clock_t start;
+
+  // the first run uses the spsc queue, the rest use the mpmc queue
+  for (i = 0; i < (int) (sizeof(producers) / sizeof(producers[0])); i++)
+  {
+    memset(&context, 0, sizeof(context));
+    context.m_producers = producers[i];
+    context.m_items = (1 << 22) / producers[i];
+
+    if (i == 0)
+    {
+      context.m_spsc = spscqueue_alloc(sizeof(int), 1024, 0);
+    }
+    else
+    {
+      context.m_mpmc = mpmcqueue_alloc(sizeof(int), 1024, 0);
+    }
+
+    // a thread for every job, so the producers and consumers all run at the same time
+    threads = threadpool_alloc(producers[i] + consumers[i], 0);
+
+    start = clock();
+    threadpool_run(threads, bench_queue_job, &context, producers[i] + consumers[i]);
+
+    printf("Queue %s %d/%d: %d ms\n", context.m_spsc ? "spsc" : "mpmc", producers[i], consumers[i],
+      (int) ((clock() - start) * 1000 / CLOCKS_PER_SEC));
+
+    // every item was popped exactly once
+    sum = 0;
+    total = (int64) context.m_items * producers[i];
+
+    for (j = 0; j < consumers[i]; j++)
+    {
+      sum += context.m_sums[j];
+    }
+
+    assert(context.m_popped == total);
+    assert(sum == total * (total - 1) / 2);
+
+    threadpool_free(threads);
+    threads = 0;
+
+    if (context.m_spsc)
+    {
+      spscqueue_free(context.m_spsc);
+    }
+    else
+    {
+      mpmcqueue_free(context.m_mpmc);
+    }
+  }
+}
+
+
+void test_flatmap()
+{
+  struct flatmap *map;
+  int keys[100], values[100];
+  int i, key, value, start, count;
+
+  map = flatmap_alloc(sizeof(int), 0);
+
+  // insert the even keys out of order, with a value of ten times the key
+  for (i = 0; i < 1000; i++)
+  {
+    key = (i * 337) % 1000 * 2;
+    value = key * 10;
+    flatmap_insert(map, key, &value);
+  }
+
+  assert(flatmap_count(map) == 1000);
+
+  for (i = 0; i < 2000; i++)
+  {
+    assert((flatmap_find(map, i) >= 0) == !(i & 1));
+    assert(!(i & 1) ? *(int *) flatmap_get(map, i) == i * 10 : !flatmap_get(map, i));
+  }
+
+  assert(flatmap_lower_bound(map, -5) == 0);
+  assert(flatmap_lower_bound(map, 3) == 2);
+  assert(flatmap_lower_bound(map, 5000) == 1000);
+
+  // merge a sorted run of odd keys, and even keys that replace values
+  for (i = 0; i < 100; i++)
+  {
+    keys[i] = i * 20 + (i & 1);
+    values[i] = -keys[i];
+  }
+
+  flatmap_insert_sorted(map, keys, values, 100);
+  assert(flatmap_count(map) == 1050);
 
-  tree_find_remove(items, 5);
-  tree_find_remove(items, 6);
-  tree_find_remove(items, 4);
-  tree_insert(items, 6, &f);
-  tree_insert(items, 5, &e);
-  tree_insert(items, 4, &d);
+  for (i = 1; i < flatmap_count(map); i++)
+  {
+    assert(flatmap_key(map, i) > flatmap_key(map, i - 1));
+  }
 
-  tree_enum(items, test_tree_func);
-  printf("--------------------------------\n\n");
+  assert(*(int *) flatmap_get(map, 20) == 200);
+  assert(*(int *) flatmap_get(map, 40) == -40);
+  assert(*(int *) flatmap_get(map, 21) == -21);
 
-  tree_find_remove_subtree(items, 4);
-  tree_find_remove(items, 2);
-  tree_insert(items, 2, &b);
+  // iterate over a range of keys
+  count = flatmap_range(map, 100, 200, &start);
+  assert(count == 51 + 3);
 
-  tree_enum(items, test_tree_func);
-  printf("--------------------------------\n\n");
+  for (i = start; i < start + count; i++)
+  {
+    assert(flatmap_key(map, i) >= 100 && flatmap_key(map, i) <= 200);
+  }
 
-  tree_free(items);
+  flatmap_remove(map, flatmap_find(map, 21));
+  assert(flatmap_find(map, 21) == -1);
+  assert(flatmap_count(map) == 1049);
+
+  printf("Flat map: Count(%d)\n", flatmap_count(map));
+
+  flatmap_free(map);
+  map = 0;
 }
 
 
-void test_array()
+// fill chunks with increasing values until 40 have been filled
+size_t test_vector_fill(void *a_ctx, void *a_dst, size_t a_count)
 {
-  struct array *items;
-  unsigned char *data;
-  int count;
-  int elemsize;
+  int *next, *dst;
+  size_t i;
 
-  items = array_alloc(sizeof(int), 8, 0);
-  data = (unsigned char *) array_data(items);
-  
-  array_zero(items);
+  next = (int *) a_ctx;
+  dst = (int *) a_dst;
 
-  count = array_count(items);
-  elemsize = array_elemsize(items);
-  printf("Array: Count(%d), Size(%d)\n", count, elemsize);
+  if (a_count > (size_t) (40 - *next))
+  {
+    a_count = 40 - *next;
+  }
 
-  array_resize(items, 10);
-  data = (unsigned char *) array_data(items);
+  for (i = 0; i < a_count; i++)
+  {
+    dst[i] = (*next)++;
+  }
 
-  count = array_count(items);
-  elemsize = array_elemsize(items);
-  printf("Array: Count(%d), Size(%d)\n", count, elemsize);
+  return a_count;
+}
 
-  array_free(items);
-  items = 0;
+
+// select the odd values
+int test_vector_odd(void *a_ctx, const void *a_elem)
+{
+  if (a_ctx)
+  {
+    ++*(int *) a_ctx;
+  }
+
+  return *(const int *) a_elem & 1;
 }
 
 
 void test_vector()
 {
   struct vector *items;
+  struct intvector *ints;
+  struct smallvector *small;
+  int values[64];
+  size_t indices[4];
   int *data;
-  int count;
-  int capacity;
-  int elemsize;
+  int i;
+  int calls;
+  size_t count;
+  size_t capacity;
+  size_t elemsize;
   
   items = vector_alloc(sizeof(int), 0);
 
@@ -145,7 +1130,7 @@ void test_vector()
   count = vector_count(items);
   capacity = vector_capacity(items);
   elemsize = vector_elemsize(items);
-  printf("Vector: Count(%d), Capacity(%d), Size(%d)\n", count, capacity, elemsize);
+  printf("Vector: Count(%d), Capacity(%d), Size(%d)\n", (int) count, (int) capacity, (int) elemsize);
 
   data = vector_append(items, 3);
   *data++ = 1;
@@ -160,6 +1145,147 @@ void test_vector()
 
   vector_free(items);
   items = 0;
+
+  ints = intvector_alloc(0);
+
+  for (i = 0; i < 100; i++)
+  {
+    intvector_push(ints, i);
+  }
+
+  printf("Typed vector: Count(%d), Last(%d)\n", (int) intvector_count(ints), intvector_get(ints, 99));
+
+  intvector_free(ints);
+  ints = 0;
+
+  // appending one element at a time grows the capacity geometrically
+  items = vector_alloc(sizeof(int), 0);
+  vector_set_growth(items, 1.5f);
+
+  for (i = 0; i < 1000000; i++)
+  {
+    *(int *) vector_append(items, 1) = i;
+  }
+
+  assert(vector_capacity(items) >= vector_count(items));
+  assert(vector_capacity(items) < vector_count(items) * 2);
+
+  vector_shrink_to_fit(items);
+  assert(vector_capacity(items) == 1000000);
+  assert(*(int *) vector_index(items, 999999) == 999999);
+
+  vector_resize(items, 0);
+  vector_shrink_to_fit(items);
+  assert(vector_capacity(items) == 0);
+
+  vector_append(items, 1);
+  assert(vector_capacity(items) >= 1);
+
+  printf("Vector growth: Count(%d), Capacity(%d)\n", (int) vector_count(items), (int) vector_capacity(items));
+
+  vector_free(items);
+  items = 0;
+
+  // the first elements of a small vector are stored in the vector itself
+  small = smallvector_alloc(0);
+  assert(smallvector_capacity(small) == 8);
+  assert(smallvector_data(small) == small->m_inline);
+
+  for (i = 0; i < 8; i++)
+  {
+    smallvector_push(small, i);
+  }
+
+  assert(smallvector_data(small) == small->m_inline);
+
+  for (i = 8; i < 100; i++)
+  {
+    smallvector_push(small, i);
+  }
+
+  assert(smallvector_data(small) != small->m_inline);
+
+  for (i = 0; i < 100; i++)
+  {
+    assert(smallvector_get(small, i) == i);
+  }
+
+  smallvector_resize(small, 5);
+  vector_shrink_to_fit(smallvector_vector(small));
+  assert(smallvector_data(small) == small->m_inline);
+  assert(smallvector_capacity(small) == 8);
+  assert(smallvector_get(small, 4) == 4);
+
+  printf("Small vector: Count(%d), Capacity(%d)\n", (int) smallvector_count(small), (int) smallvector_capacity(small));
+
+  smallvector_free(small);
+  small = 0;
+
+  // bulk copies in and out of a vector
+  for (i = 0; i < 64; i++)
+  {
+    values[i] = i;
+  }
+
+  ints = intvector_alloc(0);
+  intvector_push_n(ints, values, 64);
+  vector_extend(intvector_vector(ints), intvector_vector(ints));
+  assert(intvector_count(ints) == 128);
+  assert(intvector_get(ints, 64) == 0 && intvector_get(ints, 127) == 63);
+
+  vector_copy_range(intvector_vector(ints), 60, 8, values);
+  assert(values[0] == 60 && values[3] == 63 && values[4] == 0 && values[7] == 3);
+
+  i = 0;
+  count = vector_append_from(intvector_vector(ints), test_vector_fill, &i, 16);
+  assert(count == 40);
+  assert(intvector_count(ints) == 168 && intvector_get(ints, 167) == 39);
+
+  vector_assign(intvector_vector(ints), values, 8);
+  assert(intvector_count(ints) == 8 && intvector_get(ints, 0) == 60);
+
+  printf("Vector bulk: Count(%d), Capacity(%d)\n", (int) intvector_count(ints), (int) intvector_capacity(ints));
+
+  intvector_free(ints);
+  ints = 0;
+
+  // removing elements in a single pass
+  ints = intvector_alloc(0);
+
+  for (i = 0; i < 1000; i++)
+  {
+    intvector_push(ints, i);
+  }
+
+  calls = 0;
+  count = vector_remove_if(intvector_vector(ints), test_vector_odd, &calls);
+  assert(count == 500 && intvector_count(ints) == 500);
+  assert(calls == 1000);
+
+  for (i = 0; i < 500; i++)
+  {
+    assert(intvector_get(ints, i) == i * 2);
+  }
+
+  indices[0] = 0;
+  indices[1] = 1;
+  indices[2] = 250;
+  indices[3] = 499;
+  vector_remove_indices(intvector_vector(ints), indices, 4);
+  assert(intvector_count(ints) == 496);
+  assert(intvector_get(ints, 0) == 4 && intvector_get(ints, 247) == 498 && intvector_get(ints, 248) == 502);
+  assert(intvector_get(ints, 495) == 996);
+
+  vector_swap_remove(intvector_vector(ints), 0);
+  assert(intvector_count(ints) == 495 && intvector_get(ints, 0) == 996);
+
+  vector_remove(intvector_vector(ints), 490, 5);
+  assert(intvector_count(ints) == 490);
+
+  printf("Vector remove: Count(%d)\n", (int) intvector_count(ints));
+
+  intvector_free(ints);
+  ints = 0;
 }
 
 
@@ -281,36 +1407,52 @@ void test_string()
   struct cstring *cstr;
 
   cstr = cstring_alloc("Test", 0);
-  printf("String: [%s] - Len: %d\n", cstring_cstr(cstr), cstring_len(cstr));
+  printf("String: [%s] - Len: %d\n", cstring_cstr(cstr), (int) cstring_len(cstr));
 
   cstring_cat(cstr, " 100");
-  printf("String: [%s] - Len: %d\n", cstring_cstr(cstr), cstring_len(cstr));
+  printf("String: [%s] - Len: %d\n", cstring_cstr(cstr), (int) cstring_len(cstr));
 
   cstring_catf(cstr, " %d", 200);
-  printf("String: [%s] - Len: %d\n", cstring_cstr(cstr), cstring_len(cstr));
+  printf("String: [%s] - Len: %d\n", cstring_cstr(cstr), (int) cstring_len(cstr));
 
   cstring_del(cstr, 1, 2);
-  printf("String: [%s] - Len: %d\n", cstring_cstr(cstr), cstring_len(cstr));
+  printf("String: [%s] - Len: %d\n", cstring_cstr(cstr), (int) cstring_len(cstr));
 
   cstring_del(cstr, 1, 2);
-  printf("String: [%s] - Len: %d\n", cstring_cstr(cstr), cstring_len(cstr));
+  printf("String: [%s] - Len: %d\n", cstring_cstr(cstr), (int) cstring_len(cstr));
 
   cstring_ins(cstr, 1, 4, "est ");
-  printf("String: [%s] - Len: %d\n", cstring_cstr(cstr), cstring_len(cstr));
+  printf("String: [%s] - Len: %d\n", cstring_cstr(cstr), (int) cstring_len(cstr));
 
   cstring_setf(cstr, "Test [%s] : [%d]", "String", 100);
-  printf("String: [%s] - Len: %d\n", cstring_cstr(cstr), cstring_len(cstr));
+  printf("String: [%s] - Len: %d\n", cstring_cstr(cstr), (int) cstring_len(cstr));
 
   cstring_free(cstr);
   cstr = 0;
 }
 
 
+void test_memorypool_diff_func(void *a_context, const char *a_file, int a_line, int a_count, size_t a_bytes)
+{
+  *(int *) a_context += a_count;
+}
+
+
+// count the allocations made by earlier opens of a mapped pool, and by this one
+void test_memorypool_run_func(void *a_context, const char *a_file, int a_line, int a_count, size_t a_bytes)
+{
+  ((int *) a_context)[strcmp(a_file, "previous run") ? 1 : 0] += a_count;
+}
+
+
 void test_memorypool()
 {
   struct memorypool *pool;
   int i;
   int *memarray[256];
+  uint32 generation;
+  int sites;
+  int count;
   
   pool = memorypool_alloc();
   assert(pool);
@@ -327,6 +1469,9 @@ void test_memorypool()
 
   memorypool_trunc(pool);
 
+  memorypool_reserve(pool, 32, 100);
+  memorypool_reserve(pool, 1024, 4);
+
   for (i = 1; i < 16; i++)
   {
     memarray[i] = palloc(pool, i*4);
@@ -347,10 +1492,292 @@ void test_memorypool()
     pfree(pool, memarray[i]);
   }
 
+  for (i = 0; i < 8; i++)
+  {
+    memarray[i] = palloc(pool, 16);
+  }
+
+  generation = memorypool_checkpoint(pool);
+
+  for (i = 8; i < 16; i++)
+  {
+    memarray[i] = palloc(pool, 512);
+  }
+
+  count = 0;
+  sites = memorypool_diff_enum(pool, generation, test_memorypool_diff_func, &count);
+  printf("Memory pool diff: Sites(%d), Count(%d)\n", sites, count);
+  assert(sites == 1 && count == 8);
+  memorypool_diff(pool, generation);
+
+  for (i = 0; i < 16; i++)
+  {
+    pfree(pool, memarray[i]);
+  }
+
+  memorypool_free(pool);
+
+  pool = 0;
+}
+
+
+void test_memorypool_map()
+{
+  struct memorypool *pool;
+  struct sortedlist *items;
+  struct sortedlist_item *item;
+  void *mem;
+  FILE *file;
+  uint32 version, settings;
+  int i, runs[2];
+
+  remove("test_memorypool.map");
+
+  pool = memorypool_map("test_memorypool.map", 1024 * 1024, 0);
+  assert(pool);
+
+  items = sortedlist_alloc(sizeof(int), pool);
+  memorypool_set_root(pool, items);
+
+  for (i = 0; i < 1000; i++)
+  {
+    sortedlist_insert(items, i, &i);
+  }
+
+  memorypool_unmap(pool);
+
+  // reopen the file and find the list again
+  pool = memorypool_map("test_memorypool.map", 0, 0);
+  assert(pool);
+
+  items = (struct sortedlist *) memorypool_root(pool);
+  assert(sortedlist_count(items) == 1000);
+
+  item = sortedlist_find_first(items, 500);
+  assert(item);
+  assert(*(int *) sortedlist_value(item) == 500);
+  printf("Mapped pool: Count(%d)\n", sortedlist_count(items));
+
+  // the file names of the list are from the first open, so only the new allocation reports its own
+  mem = palloc(pool, 16);
+  runs[0] = 0;
+  runs[1] = 0;
+  memorypool_diff_enum(pool, 0, test_memorypool_run_func, runs);
+  assert(runs[0] > 1000 && runs[1] == 1);
+  pfree(pool, mem);
+
+  sortedlist_free(items);
+
+  // allocating from a full file fails rather than writing past the end of it
+  i = 0;
+  while (palloc(pool, 256))
+  {
+    i++;
+  }
+
+  assert(i > 0 && i < 1024 * 1024 / 256);
+  assert(!palloc(pool, 256));
+
+  memorypool_trunc(pool);
+  memorypool_unmap(pool);
+  pool = 0;
+
+  // a file made by a build with other tracking or colouring settings is not opened
+  file = fopen("test_memorypool.map", "r+b");
+  assert(file);
+
+  fseek(file, 2 * sizeof(uint32), SEEK_SET);
+  fread(&settings, sizeof(uint32), 1, file);
+  settings ^= 1;
+  fseek(file, 2 * sizeof(uint32), SEEK_SET);
+  fwrite(&settings, sizeof(uint32), 1, file);
+  fclose(file);
+
+  pool = memorypool_map("test_memorypool.map", 0, 0);
+  assert(!pool);
+
+  // a file with a different layout version is not opened, once the settings are put back
+  file = fopen("test_memorypool.map", "r+b");
+  assert(file);
+
+  settings ^= 1;
+  fseek(file, 2 * sizeof(uint32), SEEK_SET);
+  fwrite(&settings, sizeof(uint32), 1, file);
+  fclose(file);
+
+  pool = memorypool_map("test_memorypool.map", 0, 0);
+  assert(pool);
+  memorypool_unmap(pool);
+
+  file = fopen("test_memorypool.map", "r+b");
+  assert(file);
+
+  version = ~0;
+  fseek(file, sizeof(uint32), SEEK_SET);
+  fwrite(&version, sizeof(uint32), 1, file);
+  fclose(file);
+
+  pool = memorypool_map("test_memorypool.map", 0, 0);
+  assert(!pool);
+
+  remove("test_memorypool.map");
+}
+
+
+// the bytes wasted by rounding 32 allocations each of 36 and 68 bytes up to the classes of a pool
+int test_memorypool_waste(const uint32 *a_sizes)
+{
+  int i, j;
+
+  i = 0;
+  while (a_sizes[i] < 36)
+  {
+    i++;
+  }
+
+  j = i;
+  while (a_sizes[j] < 68)
+  {
+    j++;
+  }
+
+  return (a_sizes[i] - 36) * 32 + (a_sizes[j] - 68) * 32;
+}
+
+
+void test_memorypool_profile()
+{
+  struct memorypool *pool;
+  struct memorypool_profile profile;
+  uint32 defaults[MEMORYPOOL_CLASSES];
+  uint32 sizes[MEMORYPOOL_CLASSES];
+  int i;
+  int *memarray[64];
+
+  pool = memorypool_alloc();
+  assert(pool);
+
+  memorypool_classes(pool, defaults);
+  memorypool_profile_start(pool);
+
+  for (i = 0; i < 64; i++)
+  {
+    memarray[i] = palloc(pool, (i & 1) ? 36 : 68);
+  }
+
+  memorypool_profile_stop(pool, &profile);
+
+  for (i = 0; i < 64; i++)
+  {
+    pfree(pool, memarray[i]);
+  }
+
+  memorypool_free(pool);
+
+  // a pool tuned to the profile should have classes that fit the sizes exactly, and keep the default
+  // classes where there were no samples
+  pool = memorypool_alloc_profiled(&profile);
+  assert(pool);
+
+  memorypool_classes(pool, sizes);
+  printf("Memory pool classes:");
+
+  for (i = 0; i < MEMORYPOOL_CLASSES; i++)
+  {
+    printf(" %u", sizes[i]);
+  }
+
+  printf(", Waste(%d default, %d tuned)\n", test_memorypool_waste(defaults), test_memorypool_waste(sizes));
+  assert(sizes[2] == 40 && sizes[4] == 72 && sizes[5] == 128);
+  assert(test_memorypool_waste(sizes) < test_memorypool_waste(defaults));
+
+  for (i = 0; i < 64; i++)
+  {
+    memarray[i] = palloc(pool, (i & 1) ? 36 : 68);
+  }
+
+  for (i = 0; i < 64; i++)
+  {
+    pfree(pool, memarray[i]);
+  }
+
+  memorypool_free(pool);
+
+  // a profile with no samples gives the default classes
+  memset(&profile, 0, sizeof(profile));
+  pool = memorypool_alloc_profiled(&profile);
+  assert(pool);
+
+  memorypool_classes(pool, sizes);
+  assert(memcmp(sizes, defaults, sizeof(sizes)) == 0);
+
   memorypool_free(pool);
+  pool = 0;
+}
+
+
+// time reading the first item of every chunk of a pool with or without colouring
+int bench_memorypool_layout(int a_colouring, uint32 *a_sum)
+{
+  struct memorypool *pool;
+  int **items;
+  uint32 sum;
+  int i, j, ms;
+  clock_t start;
+  const int chunks = 4096;
+
+  pool = memorypool_alloc();
+  assert(pool);
+
+  memorypool_set_colouring(pool, a_colouring);
+
+  // every 32nd allocation is the first item of a new chunk
+  items = (int **) malloc(chunks * 32 * sizeof(int *));
+  assert(items);
+
+  for (i = 0; i < chunks * 32; i++)
+  {
+    items[i] = palloc(pool, 64);
+    *items[i] = i;
+  }
+
+  sum = 0;
+  start = clock();
 
+  for (j = 0; j < 1000; j++)
+  {
+    for (i = 0; i < chunks * 32; i += 32)
+    {
+      sum += (uint32) *items[i];
+    }
+  }
+
+  ms = (int) ((clock() - start) * 1000 / CLOCKS_PER_SEC);
+  *a_sum = sum;
+
+  for (i = 0; i < chunks * 32; i++)
+  {
+    pfree(pool, items[i]);
+  }
+
+  free(items);
+  memorypool_free(pool);
   pool = 0;
+
+  return ms;
 }
 
 
+void bench_memorypool_colour()
+{
+  uint32 sum;
+  int coloured, uncoloured;
+
+  // both layouts are timed in the same run, so they are compared on the same machine and build
+  coloured = bench_memorypool_layout(1, &sum);
+  uncoloured = bench_memorypool_layout(0, &sum);
+
+  printf("Memory pool colour: Coloured(%d ms), Uncoloured(%d ms) (%u)\n", coloured, uncoloured, sum);
+}
+
 
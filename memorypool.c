@@ -3,9 +3,11 @@
 
 #include <assert.h>
 #include <crtdbg.h>
+#include <intrin.h>
 #include <memory.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <windows.h>
 
 #include "array.h"
 
@@ -24,26 +26,63 @@
 
 #define HEAP_ALLOC_INDEX 0xffffffff
 
+// the number of pointer sized slots before the data of each allocation, which are the header, the file
+// and line if they are tracked, the index in the chunk, and the chunk. they are pointer sized so the
+// file and chunk pointers fit in 64 bit builds.
+#if __h_config_memory_pool_tracking
+#define ALLOC_SLOTS 5
+#else
+#define ALLOC_SLOTS 3
+#endif
+
 #define CHUNK_ITEMS 32
 
+// the version of the layout of a mapped file, which must change whenever the arena, the pool or the
+// chunk and heap headers change
+#define ARENA_MAGIC 0x6c6f6f70
+#define ARENA_VERSION 4
+#define ARENA_ALIGN 8
+#define ARENA_GRANULARITY 0x10000
+#define ARENA_MIN_SPLIT 64
+
+// the build settings that change the layout of the items in a mapped file
+#define ARENA_TRACKING 0x01
+#define ARENA_COLOURING 0x02
+#define ARENA_SETTINGS ((__h_config_memory_pool_tracking ? ARENA_TRACKING : 0) | (__h_config_memorypool_colouring ? ARENA_COLOURING : 0))
+
+#define DIFF_SITES 256
+
+#define CACHE_LINE 64
+#define COLOUR_ALIGN 512
+
+#define CLASS_GRANULARITY 8
+#define CLASS_LOOKUP ((256 / CLASS_GRANULARITY) + 1)
+
 
 struct heapchunk
 {
   struct heapchunk *m_next;
   struct heapchunk *m_prev;
-  int m_size;
+  size_t m_size;
+  size_t m_capacity; // the size the block was reserved with, or 0 if it is not reserved
+
+#if __h_config_memory_pool_tracking
+  uint32 m_generation;
+  uint32 m_run;     // the open of a mapped pool that made the allocation
+#endif
   
-  int m_header;
+  // the same pointer sized slots as the header of a chunk item
+  intptr_t m_header;
 
 #if __h_config_memory_pool_tracking
   const char *m_file;
-  int m_line;
+  intptr_t m_line;
 #endif
 
-  int m_index; // will equal ~0 for a heapchunk
+  intptr_t m_index; // will equal ~0 for a heapchunk
   struct heapchunk *m_chunk;
 
-  int m_end;
+  intptr_t m_end;
 };
 
 
@@ -52,6 +91,12 @@ struct memorychunk
   int m_size;
   int m_mask;
   struct memorychunk *m_next;
+  int m_colour; // the offset of the first item from the end of the header
+
+#if __h_config_memory_pool_tracking
+  uint32 m_generation[CHUNK_ITEMS];
+  uint32 m_run[CHUNK_ITEMS];  // the open of a mapped pool that made each item
+#endif
 
   // struct data
   // {
@@ -77,7 +122,7 @@ enum
   chunk_64    = 4,
   chunk_128   = 5,
   chunk_256   = 6,
-  chunk_count = 7
+  chunk_count = MEMORYPOOL_CLASSES
 };
 
 
@@ -97,26 +142,176 @@ struct memorypool
 {
   struct memorychunk *m_chunks[chunk_count];
   struct heapchunk *m_heap;
+  struct heapchunk *m_spare;                    // reserved heap blocks that are not in use
   int m_num_alloc;
+  uint32 m_chunk_size[chunk_count];             // the item size of each chunk class
+  unsigned char m_chunk_id[CLASS_LOOKUP];       // the chunk class for each (size + 7) / 8
+  int m_profiling;                              // set if allocation sizes are being recorded
+  uint32 m_profile[MEMORYPOOL_PROFILE_BUCKETS]; // the recorded allocation sizes
+  struct memoryarena *m_arena;  // the mapped file the pool allocates from, or 0 to use the os
+  uint32 m_run;                 // counts the opens of a mapped file, 0 if the pool is not mapped
+  uint32 m_generation;          // the generation stamped on new allocations
+  int m_colour[chunk_count];    // the colour of the next chunk for each class
+  int m_uncoloured;             // set if the items of every new chunk start at the same offset
+};
+
+
+// the allocations from one call site found by memorypool_diff
+struct memorysite
+{
+  const char *m_file;
+  int m_line;
+  int m_count;
+  size_t m_bytes;
+};
+
+
+// the call sites found by memorypool_diff
+struct memorysites
+{
+  struct memorysite m_site[DIFF_SITES];
+  struct memorysite m_other;
+  int m_count;
+};
+
+
+// header for each block allocated from a memory arena. the links are offsets from the start of the
+// arena, so the free list is valid no matter where the file is mapped.
+struct memoryblock
+{
+  uint32 m_size;  // the size of the block including the header
+  uint32 m_next;  // the offset of the next free block, or 0
+};
+
+
+// a memory mapped file that a memory pool allocates its chunks from. the arena (and the pool) is
+// stored at the start of the file.
+struct memoryarena
+{
+  uint32 m_magic;
+  uint32 m_version;
+  uint32 m_settings;      // the tracking and colouring settings of the build that made the file
+  uint32 m_slots;         // the number of slots before the data of each allocation
+  uint32 m_poolsize;      // the size of the pool structure
+  uint32 m_chunksize;     // the size of the header of each chunk
+  uint32 m_heapsize;      // the size of the header of each heap block
+  uint32 m_size;          // the size of the file
+  uint32 m_top;           // the offset of the first byte that has never been allocated
+  uint32 m_free;          // the offset of the first free block, or 0
+  void *m_base;           // the address the file is mapped at
+  void *m_root;           // the user root object
+  HANDLE m_file;          // the file handle (only valid in the process that opened it)
+  HANDLE m_mapping;       // the mapping handle (only valid in the process that opened it)
+  struct memorypool m_pool;
 };
 
 
 struct memorypool *g_global_memorypool = 0;
 
+// the file name reported for an allocation that an earlier open of a mapped pool made, as its tracked
+// file name points into the image of the process that made it
+static const char g_memorypool_image[] = "previous run";
+
 
-void *__alloc_from_heap(const char *a_file, int a_line, struct memorypool *a_pool, uint32 a_size);
+void *__alloc_from_heap(const char *a_file, int a_line, struct memorypool *a_pool, size_t a_size);
 void *__alloc_from_chunk(const char *a_file, int a_line, struct memorypool *a_pool, int a_id);
-int __alloc_chunk_size(int a_id);
+int __alloc_chunk_size(struct memorypool *a_pool, int a_id);
+void __init_chunk_sizes(struct memorypool *a_pool, const uint32 *a_sizes);
+void __tune_chunk_sizes(const struct memorypool_profile *a_profile, uint32 *a_sizes);
+int __chunk_item_stride(int a_size);
+int __chunk_colours(struct memorypool *a_pool, int a_id);
 struct memorychunk *__alloc_new_chunk(struct memorypool *a_pool, int a_id);
-void __free_chunk(struct memorychunk *a_chunk);
+void __free_chunk(struct memorypool *a_pool, struct memorychunk *a_chunk);
 void __free_heap(struct memorypool *a_pool, struct heapchunk *a_chunk);
+void __free_spares(struct memorypool *a_pool);
 void *__chunk_item_data(struct memorychunk *a_chunk, int a_index);
-int *__chunk_item_header(struct memorychunk *a_chunk, int a_index);
+intptr_t *__chunk_item_header(struct memorychunk *a_chunk, int a_index);
 int *__chunk_item_footer(struct memorychunk *a_chunk, int a_index);
+void *__pool_os_alloc(struct memorypool *a_pool, size_t a_size);
+void __pool_os_free(struct memorypool *a_pool, void *a_mem);
+void *__arena_alloc(struct memoryarena *a_arena, uint32 a_size);
+void __arena_free(struct memoryarena *a_arena, void *a_mem);
+void __arena_reset(struct memoryarena *a_arena);
+void __arena_layout(struct memoryarena *a_arena);
+int __arena_matches(const struct memoryarena *a_arena);
 void __show_pool_allocations(struct memorypool *a_pool);
-void __show_chunk_allocations(struct memorychunk *a_chunk);
-void __show_heap_allocations(struct heapchunk *a_chunk);
-void __show_allocation(const char *a_source, const char *a_file, int a_line, int a_size);
+void __show_chunk_allocations(struct memorypool *a_pool, struct memorychunk *a_chunk);
+void __show_heap_allocations(struct memorypool *a_pool, struct heapchunk *a_chunk);
+void __show_allocation(const char *a_source, const char *a_file, int a_line, size_t a_size);
+void __diff_site(struct memorysites *a_sites, const char *a_file, int a_line, size_t a_bytes);
+void __diff_report(void *a_context, const char *a_file, int a_line, int a_count, size_t a_bytes);
+const char *__alloc_file(struct memorypool *a_pool, const char *a_file, uint32 a_run);
+
+
+void _memorypool_reserve(struct memorypool *a_pool, size_t a_size, size_t a_count)
+{
+  struct memorychunk *chunk;
+  struct heapchunk *hchunk;
+  size_t allocsize, avail, i;
+  int id, j;
+
+  if (!a_pool)
+  {
+    a_pool = g_global_memorypool;
+  }
+
+  assert(a_pool);
+
+  // a reservation too large to address reserves nothing
+  if (psize(a_count, a_size) == (size_t) ~0)
+  {
+    return;
+  }
+
+  if (a_size > a_pool->m_chunk_size[chunk_count - 1])
+  {
+    // reserve heap blocks, which are kept when they are freed
+    assert(a_size <= ((size_t) ~0) - sizeof(struct heapchunk) - sizeof(int));
+    allocsize = a_size + sizeof(struct heapchunk) + sizeof(int);
+
+    for (i = 0; i < a_count; i++)
+    {
+      hchunk = (struct heapchunk *) __pool_os_alloc(a_pool, allocsize);
+      if (!hchunk)
+      {
+        return;
+      }
+
+      memset(hchunk, 0, allocsize);
+      hchunk->m_capacity = a_size;
+      hchunk->m_next = a_pool->m_spare;
+      a_pool->m_spare = hchunk;
+    }
+  }
+  else
+  {
+    // count the free items in the existing chunks, then add chunks for the rest
+    id = a_pool->m_chunk_id[(a_size + CLASS_GRANULARITY - 1) / CLASS_GRANULARITY];
+    avail = 0;
+
+    for (chunk = a_pool->m_chunks[id]; chunk; chunk = chunk->m_next)
+    {
+      for (j = 0; j < CHUNK_ITEMS; j++)
+      {
+        if ((chunk->m_mask & (1 << j)) == 0)
+        {
+          avail++;
+        }
+      }
+    }
+
+    while (avail < a_count)
+    {
+      chunk = __alloc_new_chunk(a_pool, id);
+      if (!chunk)
+      {
+        return;
+      }
+
+      avail += CHUNK_ITEMS;
+    }
+  }
+}
 
 
 void _memorypool_global(struct memorypool *a_pool)
@@ -135,10 +330,64 @@ struct memorypool *_memorypool_alloc()
   assert(pool);
 
   memset(pool, 0, sizeof(struct memorypool));
+  __init_chunk_sizes(pool, g_memorychunk_size);
+
+  return pool;
+}
+
+
+struct memorypool *_memorypool_alloc_profiled(const struct memorypool_profile *a_profile)
+{
+  struct memorypool *pool;
+  uint32 sizes[chunk_count];
+
+  assert(a_profile);
+
+  __tune_chunk_sizes(a_profile, sizes);
+
+  pool = _memorypool_alloc();
+  __init_chunk_sizes(pool, sizes);
+
   return pool;
 }
 
 
+void _memorypool_profile_start(struct memorypool *a_pool)
+{
+  assert(a_pool);
+
+  memset(a_pool->m_profile, 0, sizeof(a_pool->m_profile));
+  a_pool->m_profiling = 1;
+}
+
+
+void _memorypool_profile_stop(struct memorypool *a_pool, struct memorypool_profile *a_profile)
+{
+  assert(a_pool);
+  assert(a_profile);
+
+  a_pool->m_profiling = 0;
+  memcpy(a_profile->m_count, a_pool->m_profile, sizeof(a_profile->m_count));
+}
+
+
+void _memorypool_classes(struct memorypool *a_pool, uint32 *a_sizes)
+{
+  assert(a_pool);
+  assert(a_sizes);
+
+  memcpy(a_sizes, a_pool->m_chunk_size, sizeof(a_pool->m_chunk_size));
+}
+
+
+void _memorypool_set_colouring(struct memorypool *a_pool, int a_colouring)
+{
+  assert(a_pool);
+
+  a_pool->m_uncoloured = !a_colouring;
+}
+
+
 void _memorypool_trunc(struct memorypool *a_pool)
 {
   int i;
@@ -152,7 +401,7 @@ void _memorypool_trunc(struct memorypool *a_pool)
 
     if (chunk)
     {
-      __free_chunk(chunk);
+      __free_chunk(a_pool, chunk);
     }
   }
 
@@ -161,7 +410,18 @@ void _memorypool_trunc(struct memorypool *a_pool)
     __free_heap(a_pool, a_pool->m_heap);
   }
 
-  memset(a_pool, 0, sizeof(struct memorypool));
+  __free_spares(a_pool);
+
+  // the chunk sizes and profile are kept, only the allocations are removed
+  memset(a_pool->m_chunks, 0, sizeof(a_pool->m_chunks));
+  a_pool->m_heap = 0;
+  a_pool->m_spare = 0;
+  a_pool->m_num_alloc = 0;
+
+  if (a_pool->m_arena)
+  {
+    __arena_reset(a_pool->m_arena);
+  }
 }
 
 
@@ -171,6 +431,7 @@ int _memorypool_free(struct memorypool *a_pool)
   struct memorychunk *chunk;
 
   assert(a_pool);
+  assert(!a_pool->m_arena); // use memorypool_unmap for a file backed pool
   
   if (a_pool->m_num_alloc > 0)
   {
@@ -189,7 +450,7 @@ int _memorypool_free(struct memorypool *a_pool)
 
     if (chunk)
     {
-      __free_chunk(chunk);
+      __free_chunk(a_pool, chunk);
     }
   }
 
@@ -198,6 +459,8 @@ int _memorypool_free(struct memorypool *a_pool)
     __free_heap(a_pool, a_pool->m_heap);
   }
 
+  __free_spares(a_pool);
+
   OS_FREE(a_pool);
   return 0;
 }
@@ -212,11 +475,242 @@ void _memorypool_report(struct memorypool *a_pool)
 }
 
 
-void *_palloc(const char *a_file, int a_line, struct memorypool *a_pool, uint32 a_size)
+struct memorypool *_memorypool_map(const char *a_path, uint32 a_size, void *a_base)
+{
+  struct memoryarena header, *arena;
+  HANDLE file, mapping;
+  DWORD bytes;
+  void *view;
+  int exists;
+
+  assert(a_path);
+
+  file = CreateFileA(a_path, GENERIC_READ | GENERIC_WRITE, 0, 0, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, 0);
+  if (file == INVALID_HANDLE_VALUE)
+  {
+    return 0;
+  }
+
+  // an existing file must be mapped at the same address and size it was created with
+  exists = (GetFileSize(file, 0) >= sizeof(struct memoryarena));
+  if (exists)
+  {
+    if (!ReadFile(file, &header, sizeof(struct memoryarena), &bytes, 0) || bytes != sizeof(struct memoryarena) ||
+        !__arena_matches(&header))
+    {
+      CloseHandle(file);
+      return 0;
+    }
+
+    a_size = header.m_size;
+    a_base = header.m_base;
+  }
+  else
+  {
+    assert(a_size > sizeof(struct memoryarena));
+    a_size = (a_size + ARENA_GRANULARITY - 1) & ~(ARENA_GRANULARITY - 1);
+  }
+
+  mapping = CreateFileMappingA(file, 0, PAGE_READWRITE, 0, a_size, 0);
+  if (!mapping)
+  {
+    CloseHandle(file);
+    return 0;
+  }
+
+  view = MapViewOfFileEx(mapping, FILE_MAP_ALL_ACCESS, 0, 0, a_size, a_base);
+  if (!view || (a_base && view != a_base))
+  {
+    if (view)
+    {
+      UnmapViewOfFile(view);
+    }
+
+    CloseHandle(mapping);
+    CloseHandle(file);
+    return 0;
+  }
+
+  arena = (struct memoryarena *) view;
+
+  if (!exists)
+  {
+    memset(arena, 0, sizeof(struct memoryarena));
+    __arena_layout(arena);
+    arena->m_size = a_size;
+    arena->m_base = view;
+    arena->m_pool.m_arena = arena;
+    __init_chunk_sizes(&arena->m_pool, g_memorychunk_size);
+    __arena_reset(arena);
+  }
+
+  // each open is a new run, so the file names of the allocations made by earlier runs are not used
+  arena->m_pool.m_run++;
+
+  arena->m_file = file;
+  arena->m_mapping = mapping;
+
+  _CrtSetDbgFlag(_CrtSetDbgFlag(_CRTDBG_REPORT_FLAG) | _CRTDBG_LEAK_CHECK_DF);
+
+  return &arena->m_pool;
+}
+
+
+void _memorypool_unmap(struct memorypool *a_pool)
+{
+  struct memoryarena *arena;
+  HANDLE file, mapping;
+
+  assert(a_pool);
+  assert(a_pool->m_arena);
+
+  if (a_pool == g_global_memorypool)
+  {
+    g_global_memorypool = 0;
+  }
+
+  arena = a_pool->m_arena;
+  file = arena->m_file;
+  mapping = arena->m_mapping;
+
+  arena->m_file = 0;
+  arena->m_mapping = 0;
+
+  FlushViewOfFile(arena, 0);
+  UnmapViewOfFile(arena);
+  CloseHandle(mapping);
+  CloseHandle(file);
+}
+
+
+void _memorypool_sync(struct memorypool *a_pool)
+{
+  assert(a_pool);
+  assert(a_pool->m_arena);
+
+  FlushViewOfFile(a_pool->m_arena, 0);
+  FlushFileBuffers(a_pool->m_arena->m_file);
+}
+
+
+void *_memorypool_root(struct memorypool *a_pool)
+{
+  assert(a_pool);
+  assert(a_pool->m_arena);
+
+  return a_pool->m_arena->m_root;
+}
+
+
+void _memorypool_set_root(struct memorypool *a_pool, void *a_root)
+{
+  assert(a_pool);
+  assert(a_pool->m_arena);
+
+  a_pool->m_arena->m_root = a_root;
+}
+
+
+uint32 _memorypool_checkpoint(struct memorypool *a_pool)
+{
+  assert(a_pool);
+
+  return ++a_pool->m_generation;
+}
+
+
+int _memorypool_diff_enum(struct memorypool *a_pool, uint32 a_generation, memorypool_diff_func a_funcptr, void *a_context)
+{
+#if __h_config_memory_pool_tracking
+  struct memorysites *sites;
+  struct memorychunk *chunk;
+  struct heapchunk *hchunk;
+  int i, j, count;
+  unsigned long index;
+  uint32 live;
+  intptr_t *header;
+  const char *file;
+
+  assert(a_pool);
+  assert(a_funcptr);
+
+  // the sites are not allocated from a pool, as that would change what is being walked
+  sites = (struct memorysites *) OS_ALLOC(sizeof(struct memorysites));
+  assert(sites);
+
+  memset(sites, 0, sizeof(struct memorysites));
+
+  for (i = 0; i < chunk_count; i++)
+  {
+    for (chunk = a_pool->m_chunks[i]; chunk; chunk = chunk->m_next)
+    {
+      // visit only the live items, taking the lowest set bit of the mask each time
+      live = (uint32) chunk->m_mask;
+
+      while (live)
+      {
+        _BitScanForward(&index, live);
+        live &= live - 1;
+        j = (int) index;
+
+        if (chunk->m_generation[j] >= a_generation)
+        {
+          header = __chunk_item_header(chunk, j);
+          assert(header[0] == ALLOC_HEADER);
+
+          file = __alloc_file(a_pool, (const char *) header[1], chunk->m_run[j]);
+          __diff_site(sites, file, (int) header[2], chunk->m_size);
+        }
+      }
+    }
+  }
+
+  for (hchunk = a_pool->m_heap; hchunk; hchunk = hchunk->m_next)
+  {
+    if (hchunk->m_generation >= a_generation)
+    {
+      file = __alloc_file(a_pool, hchunk->m_file, hchunk->m_run);
+      __diff_site(sites, file, (int) hchunk->m_line, hchunk->m_size);
+    }
+  }
+
+  for (i = 0; i < DIFF_SITES; i++)
+  {
+    if (sites->m_site[i].m_count)
+    {
+      a_funcptr(a_context, sites->m_site[i].m_file, sites->m_site[i].m_line, sites->m_site[i].m_count, sites->m_site[i].m_bytes);
+    }
+  }
+
+  if (sites->m_other.m_count)
+  {
+    a_funcptr(a_context, "other", 0, sites->m_other.m_count, sites->m_other.m_bytes);
+  }
+
+  count = sites->m_count + (sites->m_other.m_count ? 1 : 0);
+
+  OS_FREE(sites);
+  return count;
+#else
+  return 0;
+#endif
+}
+
+
+void _memorypool_diff(struct memorypool *a_pool, uint32 a_generation)
+{
+  assert(a_pool);
+
+  _RPT1(0, "\nMemory pool allocations since generation %u:\n", a_generation);
+  _memorypool_diff_enum(a_pool, a_generation, __diff_report, 0);
+  _RPT0(0, "\n");
+}
+
+
+void *_palloc(const char *a_file, int a_line, struct memorypool *a_pool, size_t a_size)
 {
 #if __h_config_memorypool_enabled
   void *mem;
-  int i;
 
   assert(chunk_count);
 
@@ -227,20 +721,18 @@ void *_palloc(const char *a_file, int a_line, struct memorypool *a_pool, uint32
 
   if (a_pool)
   {
-    if (a_size > g_memorychunk_size[chunk_count - 1])
+    if (a_size > a_pool->m_chunk_size[chunk_count - 1])
     {
       mem = __alloc_from_heap(a_file, a_line, a_pool, a_size);
     }
     else
     {
-      for (i = 0; i < chunk_count; i++)
+      if (a_pool->m_profiling)
       {
-        if (a_size <= g_memorychunk_size[i])
-        {
-          mem = __alloc_from_chunk(a_file, a_line, a_pool, i);
-          break;
-        }
+        a_pool->m_profile[a_size ? (a_size - 1) / CLASS_GRANULARITY : 0]++;
       }
+
+      mem = __alloc_from_chunk(a_file, a_line, a_pool, a_pool->m_chunk_id[(a_size + CLASS_GRANULARITY - 1) / CLASS_GRANULARITY]);
     }
 
     if (mem)
@@ -261,13 +753,14 @@ void *_palloc(const char *a_file, int a_line, struct memorypool *a_pool, uint32
 
 
 // todo: make each chunk point to the pool so realloc does not need to specify the pool
-void *_prealloc(const char *a_file, int a_line, struct memorypool *a_pool, void *a_mem, uint32 a_size)
+void *_prealloc(const char *a_file, int a_line, struct memorypool *a_pool, void *a_mem, size_t a_size)
 {
 #if __h_config_memorypool_enabled
   struct memorychunk *chunk;
   struct heapchunk *hchunk;
-  int index, *ptr;
-  uint32 oldsize;
+  intptr_t *ptr;
+  int index;
+  size_t oldsize;
   void *newmem;
 
   if (!a_pool)
@@ -276,22 +769,15 @@ void *_prealloc(const char *a_file, int a_line, struct memorypool *a_pool, void
   }
 
   assert(a_pool);
-  assert(a_size >= 0);
 
   if (a_mem)
   {
-#if __h_config_memory_pool_tracking
-    ptr = (int *) a_mem;
-    ptr -= 5;
+    ptr = (intptr_t *) a_mem;
+    ptr -= ALLOC_SLOTS;
     assert(ptr[0] == ALLOC_HEADER);
-    ptr += 2;
-#else
-    ptr = (int *) a_mem;
-    ptr -= 3;
-    assert(ptr[0] == ALLOC_HEADER);
-#endif
+    ptr += ALLOC_SLOTS - 3;
 
-    index = ptr[1];
+    index = (int) ptr[1];
     chunk = (struct memorychunk *) ptr[2];
 
     if (index == HEAP_ALLOC_INDEX)
@@ -316,7 +802,10 @@ void *_prealloc(const char *a_file, int a_line, struct memorypool *a_pool, void
   }
 
   newmem = _palloc(a_file, a_line, a_pool, a_size);
-  assert(newmem);
+  if (!newmem)
+  {
+    return 0;
+  }
 
   if (oldsize)
   {
@@ -336,7 +825,8 @@ void *_prealloc(const char *a_file, int a_line, struct memorypool *a_pool, void
 void pfree(struct memorypool *a_pool, void *a_mem)
 {
 #if __h_config_memorypool_enabled
-  int mask, index, *ptr;
+  int mask, index, *footer;
+  intptr_t *ptr;
   struct memorychunk *chunk;
   struct heapchunk *hchunk;
   
@@ -350,18 +840,12 @@ void pfree(struct memorypool *a_pool, void *a_mem)
 
   a_pool->m_num_alloc--;
 
-#if __h_config_memory_pool_tracking
-  ptr = (int *) a_mem;
-  ptr -= 5;
-  assert(ptr[0] == ALLOC_HEADER);
-  ptr += 2;
-#else
-  ptr = (int *) a_mem;
-  ptr -= 3;
+  ptr = (intptr_t *) a_mem;
+  ptr -= ALLOC_SLOTS;
   assert(ptr[0] == ALLOC_HEADER);
-#endif
+  ptr += ALLOC_SLOTS - 3;
 
-  index = ptr[1];
+  index = (int) ptr[1];
   chunk = (struct memorychunk *) ptr[2];
 
   if (index == HEAP_ALLOC_INDEX)
@@ -375,8 +859,8 @@ void pfree(struct memorypool *a_pool, void *a_mem)
     assert(chunk->m_size);
     assert(index >= 0 && index < CHUNK_ITEMS);
 
-    ptr = __chunk_item_footer(chunk, index);
-    assert(ptr[0] == ALLOC_FOOTER);
+    footer = __chunk_item_footer(chunk, index);
+    assert(footer[0] == ALLOC_FOOTER);
 
     mask = 1 << index;
     chunk->m_mask &= ~mask;
@@ -390,8 +874,8 @@ void pfree(struct memorypool *a_pool, void *a_mem)
 void *__alloc_from_chunk(const char *a_file, int a_line, struct memorypool *a_pool, int a_id)
 {
   struct memorychunk *chunk;
-  int size, i, mask;
-  int *ptr;
+  int i, mask, *footer;
+  intptr_t *ptr;
 
   assert(a_pool);
 
@@ -407,19 +891,13 @@ void *__alloc_from_chunk(const char *a_file, int a_line, struct memorypool *a_po
     if (!chunk)
     {
       chunk = __alloc_new_chunk(a_pool, a_id);
-      assert(chunk);
-
-      size = __alloc_chunk_size(a_id);
-      memset(chunk, 0, size);
-
-      chunk->m_next = a_pool->m_chunks[a_id];
-      a_pool->m_chunks[a_id] = chunk;
-
-      chunk->m_size = g_memorychunk_size[a_id];
+      if (!chunk)
+      {
+        return 0;
+      }
     }
   }
 
-  assert(chunk);
   for (i = 0; i < CHUNK_ITEMS; i++)
   {
     mask = 1 << i;
@@ -431,19 +909,21 @@ void *__alloc_from_chunk(const char *a_file, int a_line, struct memorypool *a_po
       ptr[0] = ALLOC_HEADER;
 
 #if __h_config_memory_pool_tracking
-      ptr[1] = (int) (int *) a_file;
+      ptr[1] = (intptr_t) a_file;
       ptr[2] = a_line;
       ptr += 2;
+
+      chunk->m_generation[i] = a_pool->m_generation;
+      chunk->m_run[i] = a_pool->m_run;
 #endif
 
       ptr[1] = i;
-      ptr[2] = (int) (int *) chunk;
+      ptr[2] = (intptr_t) chunk;
 
-      ptr = __chunk_item_footer(chunk, i);
-      ptr[0] = ALLOC_FOOTER;
+      footer = __chunk_item_footer(chunk, i);
+      footer[0] = ALLOC_FOOTER;
 
-      ptr = __chunk_item_data(chunk, i);
-      return ptr;
+      return __chunk_item_data(chunk, i);
     }
   }
 
@@ -451,25 +931,56 @@ void *__alloc_from_chunk(const char *a_file, int a_line, struct memorypool *a_po
 }
 
 
-void *__alloc_from_heap(const char *a_file, int a_line, struct memorypool *a_pool, uint32 a_size)
+void *__alloc_from_heap(const char *a_file, int a_line, struct memorypool *a_pool, size_t a_size)
 {
-  int allocsize;
+  size_t allocsize;
   void *mem;
   int *ptr;
   char *ptrchar;
-  struct heapchunk *chunk;
+  struct heapchunk *chunk, *prev;
+
+  // use a reserved block if there is one big enough
+  for (chunk = a_pool->m_spare, prev = 0; chunk; prev = chunk, chunk = chunk->m_next)
+  {
+    if (chunk->m_capacity >= a_size)
+    {
+      if (prev)
+      {
+        prev->m_next = chunk->m_next;
+      }
+      else
+      {
+        a_pool->m_spare = chunk->m_next;
+      }
+
+      break;
+    }
+  }
+
+  if (!chunk)
+  {
+    // a size too large to add the header and footer to, such as an overflowed count times size from
+    // psize, fails the allocation
+    if (a_size > ((size_t) ~0) - sizeof(struct heapchunk) - sizeof(int))
+    {
+      return 0;
+    }
 
-  allocsize = a_size + sizeof(struct heapchunk);
+    allocsize = a_size + sizeof(struct heapchunk) + sizeof(int);
 
-  mem = OS_ALLOC(allocsize);
-  assert(mem);
+    mem = __pool_os_alloc(a_pool, allocsize);
+    if (!mem)
+    {
+      return 0;
+    }
 
-  ptr = (int *) mem;
-  chunk = (struct heapchunk *) mem;
+    chunk = (struct heapchunk *) mem;
+    chunk->m_capacity = 0;
+  }
 
   chunk->m_chunk = chunk;
   chunk->m_header = ALLOC_HEADER;
-  chunk->m_size = (int) a_size;
+  chunk->m_size = a_size;
   chunk->m_index = HEAP_ALLOC_INDEX;
 
   chunk->m_next = a_pool->m_heap;
@@ -483,6 +994,8 @@ void *__alloc_from_heap(const char *a_file, int a_line, struct memorypool *a_poo
 #if __h_config_memory_pool_tracking
   chunk->m_file = a_file;
   chunk->m_line = a_line;
+  chunk->m_generation = a_pool->m_generation;
+  chunk->m_run = a_pool->m_run;
 #endif
 
   mem = &chunk->m_end;
@@ -496,45 +1009,81 @@ void *__alloc_from_heap(const char *a_file, int a_line, struct memorypool *a_poo
 }
 
 
-int __alloc_chunk_size(int a_id)
+int __alloc_chunk_size(struct memorypool *a_pool, int a_id)
 {
   int size;
 
-  size = sizeof(struct memorychunk) + (CHUNK_ITEMS * (sizeof(int) + sizeof(int) + sizeof(int) + sizeof(int) + g_memorychunk_size[a_id]));
+  size = sizeof(struct memorychunk) + (CHUNK_ITEMS * __chunk_item_stride(a_pool->m_chunk_size[a_id]));
 
-#if __h_config_memory_pool_tracking
-  size += (CHUNK_ITEMS * (sizeof(int) + sizeof(int)));
+#if __h_config_memorypool_colouring
+  // round the chunk up so there is at least one cache line of spare space at the end, which is used to
+  // give each new chunk a different offset to its first item
+  size = (size + CACHE_LINE + COLOUR_ALIGN - 1) & ~(COLOUR_ALIGN - 1);
 #endif
 
   return size;
 }
 
 
+int __chunk_colours(struct memorypool *a_pool, int a_id)
+{
+  int size;
+
+  size = sizeof(struct memorychunk) + (CHUNK_ITEMS * __chunk_item_stride(a_pool->m_chunk_size[a_id]));
+  return ((__alloc_chunk_size(a_pool, a_id) - size) / CACHE_LINE) + 1;
+}
+
+
+int __chunk_item_stride(int a_size)
+{
+  int size;
+
+  // the stride is rounded up to the size of a header slot, so the headers and data of every item stay
+  // aligned when the slots are 64 bit
+  size = (sizeof(intptr_t) * ALLOC_SLOTS) + a_size + sizeof(int);
+  size = (size + sizeof(intptr_t) - 1) & ~(sizeof(intptr_t) - 1);
+  return size;
+}
+
+
 struct memorychunk *__alloc_new_chunk(struct memorypool *a_pool, int a_id)
 {
   int size;
   struct memorychunk *chunk;
 
-  size = __alloc_chunk_size(a_id);
+  size = __alloc_chunk_size(a_pool, a_id);
   assert(size);
 
-  chunk = (struct memorychunk *) OS_ALLOC(size);
-  assert(chunk);
+  // a mapped pool fails when its file is full
+  chunk = (struct memorychunk *) __pool_os_alloc(a_pool, size);
+  if (!chunk)
+  {
+    return 0;
+  }
+
+  // clearing the chunk also faults in its pages
+  memset(chunk, 0, size);
+
+  chunk->m_next = a_pool->m_chunks[a_id];
+  a_pool->m_chunks[a_id] = chunk;
+
+  chunk->m_size = a_pool->m_chunk_size[a_id];
+  chunk->m_colour = a_pool->m_uncoloured ? 0 : (a_pool->m_colour[a_id]++ % __chunk_colours(a_pool, a_id)) * CACHE_LINE;
 
   return chunk;
 }
 
 
-void __free_chunk(struct memorychunk *a_chunk)
+void __free_chunk(struct memorypool *a_pool, struct memorychunk *a_chunk)
 {
   assert(a_chunk);
   
   if (a_chunk->m_next)
   {
-    __free_chunk(a_chunk->m_next);
+    __free_chunk(a_pool, a_chunk->m_next);
   }
 
-  OS_FREE(a_chunk);
+  __pool_os_free(a_pool, a_chunk);
 }
 
 
@@ -555,8 +1104,343 @@ void __free_heap(struct memorypool *a_pool, struct heapchunk *a_chunk)
     a_chunk->m_prev->m_next = a_chunk->m_next;
   }
 
+  // reserved blocks are kept for the next heap allocation
+  if (a_chunk->m_capacity)
+  {
+    a_chunk->m_prev = 0;
+    a_chunk->m_next = a_pool->m_spare;
+    a_pool->m_spare = a_chunk;
+    return;
+  }
+
   ptr = (void *) a_chunk;
-  OS_FREE(ptr);
+  __pool_os_free(a_pool, ptr);
+}
+
+
+void __free_spares(struct memorypool *a_pool)
+{
+  struct heapchunk *chunk;
+
+  while (a_pool->m_spare)
+  {
+    chunk = a_pool->m_spare;
+    a_pool->m_spare = chunk->m_next;
+    __pool_os_free(a_pool, chunk);
+  }
+}
+
+
+void __init_chunk_sizes(struct memorypool *a_pool, const uint32 *a_sizes)
+{
+  int i, id;
+
+  assert(a_pool);
+  assert(a_sizes);
+  assert(a_sizes[chunk_count - 1] == g_memorychunk_size[chunk_count - 1]);
+
+  memcpy(a_pool->m_chunk_size, a_sizes, sizeof(a_pool->m_chunk_size));
+
+  // build the lookup from the allocation size to the smallest chunk class that fits it
+  id = 0;
+  for (i = 0; i < CLASS_LOOKUP; i++)
+  {
+    while (a_sizes[id] < (uint32) (i * CLASS_GRANULARITY))
+    {
+      id++;
+    }
+
+    a_pool->m_chunk_id[i] = (unsigned char) id;
+  }
+}
+
+
+void __tune_chunk_sizes(const struct memorypool_profile *a_profile, uint32 *a_sizes)
+{
+  // cost[k][b] is the least bytes wasted by buckets 0..b using k + 1 classes, the largest of which is
+  // bucket b. from[k][b] is the bucket used for class k - 1 in that solution.
+  double cost[chunk_count][MEMORYPOOL_PROFILE_BUCKETS];
+  int from[chunk_count][MEMORYPOOL_PROFILE_BUCKETS];
+  double waste, best;
+  int i, j, k, a, b, used, pick, score, bestscore;
+  uint32 size, low, high;
+
+  assert(a_profile);
+  assert(a_sizes);
+  assert(MEMORYPOOL_PROFILE_BUCKETS * CLASS_GRANULARITY == g_memorychunk_size[chunk_count - 1]);
+
+  for (b = 0; b < MEMORYPOOL_PROFILE_BUCKETS; b++)
+  {
+    waste = 0;
+    for (i = 0; i <= b; i++)
+    {
+      waste += (double) a_profile->m_count[i] * (b - i) * CLASS_GRANULARITY;
+    }
+
+    cost[0][b] = waste;
+    from[0][b] = -1;
+  }
+
+  for (k = 1; k < chunk_count; k++)
+  {
+    for (b = 0; b < MEMORYPOOL_PROFILE_BUCKETS; b++)
+    {
+      best = -1;
+      from[k][b] = -1;
+
+      for (a = k - 1; a < b; a++)
+      {
+        if (cost[k - 1][a] < 0)
+        {
+          continue;
+        }
+
+        waste = cost[k - 1][a];
+        for (i = a + 1; i <= b; i++)
+        {
+          waste += (double) a_profile->m_count[i] * (b - i) * CLASS_GRANULARITY;
+        }
+
+        if (best < 0 || waste < best)
+        {
+          best = waste;
+          from[k][b] = a;
+        }
+      }
+
+      cost[k][b] = best;
+    }
+  }
+
+  // use the fewest classes that waste the least, as more classes would only go to sizes that were
+  // never allocated
+  b = MEMORYPOOL_PROFILE_BUCKETS - 1;
+  used = 1;
+
+  while (cost[used - 1][b] > cost[chunk_count - 1][b])
+  {
+    used++;
+  }
+
+  // the largest class is fixed, as it is where allocations move to the heap
+  for (k = used - 1; k >= 0; k--)
+  {
+    assert(b >= 0);
+    a_sizes[k] = (b + 1) * CLASS_GRANULARITY;
+    b = from[k][b];
+  }
+
+  // each spare class takes the default size that splits the widest range between the classes most
+  // evenly, so sizes that were not sampled keep classes near the defaults. with no samples this gives
+  // the default classes.
+  for (k = used; k < chunk_count; k++)
+  {
+    pick = -1;
+    bestscore = 0;
+
+    for (i = 0; i < chunk_count; i++)
+    {
+      size = g_memorychunk_size[i];
+      low = 0;
+      high = 0;
+
+      for (j = 0; j < k && a_sizes[j] != size; j++)
+      {
+        if (a_sizes[j] < size && a_sizes[j] > low)
+        {
+          low = a_sizes[j];
+        }
+        else if (a_sizes[j] > size && (!high || a_sizes[j] < high))
+        {
+          high = a_sizes[j];
+        }
+      }
+
+      if (j < k)
+      {
+        continue;
+      }
+
+      score = (int) (high - low) * 512 - (int) max(size - low, high - size);
+      if (pick < 0 || score > bestscore)
+      {
+        pick = i;
+        bestscore = score;
+      }
+    }
+
+    assert(pick >= 0);
+    a_sizes[k] = g_memorychunk_size[pick];
+  }
+
+  // the classes are in order of size
+  for (k = 1; k < chunk_count; k++)
+  {
+    size = a_sizes[k];
+
+    for (j = k; j > 0 && a_sizes[j - 1] > size; j--)
+    {
+      a_sizes[j] = a_sizes[j - 1];
+    }
+
+    a_sizes[j] = size;
+  }
+}
+
+
+void *__pool_os_alloc(struct memorypool *a_pool, size_t a_size)
+{
+  assert(a_pool);
+
+  // a mapped file addresses its blocks with 32 bit offsets
+  if (a_pool->m_arena)
+  {
+    return (a_size <= 0x7fffffff) ? __arena_alloc(a_pool->m_arena, (uint32) a_size) : 0;
+  }
+
+  return OS_ALLOC(a_size);
+}
+
+
+void __pool_os_free(struct memorypool *a_pool, void *a_mem)
+{
+  assert(a_pool);
+
+  if (a_pool->m_arena)
+  {
+    __arena_free(a_pool->m_arena, a_mem);
+  }
+  else
+  {
+    OS_FREE(a_mem);
+  }
+}
+
+
+void *__arena_alloc(struct memoryarena *a_arena, uint32 a_size)
+{
+  struct memoryblock *block, *split, *prev;
+  uint32 size, offset;
+  char *base;
+
+  assert(a_arena);
+
+  base = (char *) a_arena;
+  size = (a_size + sizeof(struct memoryblock) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+
+  // first fit from the free list
+  prev = 0;
+  offset = a_arena->m_free;
+
+  while (offset)
+  {
+    block = (struct memoryblock *) (base + offset);
+
+    if (block->m_size >= size)
+    {
+      // split the remainder of the block back onto the free list
+      if (block->m_size - size >= ARENA_MIN_SPLIT)
+      {
+        split = (struct memoryblock *) (base + offset + size);
+        split->m_size = block->m_size - size;
+        split->m_next = block->m_next;
+        block->m_size = size;
+        block->m_next = offset + size;
+      }
+
+      if (prev)
+      {
+        prev->m_next = block->m_next;
+      }
+      else
+      {
+        a_arena->m_free = block->m_next;
+      }
+
+      block->m_next = 0;
+      return block + 1;
+    }
+
+    prev = block;
+    offset = block->m_next;
+  }
+
+  // otherwise take the memory from the top of the arena
+  if (size > a_arena->m_size - a_arena->m_top)
+  {
+    return 0;
+  }
+
+  block = (struct memoryblock *) (base + a_arena->m_top);
+  block->m_size = size;
+  block->m_next = 0;
+
+  a_arena->m_top += size;
+  return block + 1;
+}
+
+
+void __arena_free(struct memoryarena *a_arena, void *a_mem)
+{
+  struct memoryblock *block;
+  uint32 offset;
+
+  assert(a_arena);
+  assert(a_mem);
+
+  block = ((struct memoryblock *) a_mem) - 1;
+  offset = (uint32) ((char *) block - (char *) a_arena);
+
+  assert(offset >= sizeof(struct memoryarena));
+  assert(offset + block->m_size <= a_arena->m_top);
+
+  // give the block back to the top of the arena if it is the last block, otherwise add it to the free list
+  if (offset + block->m_size == a_arena->m_top)
+  {
+    a_arena->m_top = offset;
+  }
+  else
+  {
+    block->m_next = a_arena->m_free;
+    a_arena->m_free = offset;
+  }
+}
+
+
+void __arena_reset(struct memoryarena *a_arena)
+{
+  assert(a_arena);
+
+  a_arena->m_top = (sizeof(struct memoryarena) + ARENA_ALIGN - 1) & ~(ARENA_ALIGN - 1);
+  a_arena->m_free = 0;
+  a_arena->m_root = 0;
+}
+
+
+// stamp the header of a new mapped file with the layout of this build
+void __arena_layout(struct memoryarena *a_arena)
+{
+  assert(a_arena);
+
+  a_arena->m_magic = ARENA_MAGIC;
+  a_arena->m_version = ARENA_VERSION;
+  a_arena->m_settings = ARENA_SETTINGS;
+  a_arena->m_slots = ALLOC_SLOTS;
+  a_arena->m_poolsize = sizeof(struct memorypool);
+  a_arena->m_chunksize = sizeof(struct memorychunk);
+  a_arena->m_heapsize = sizeof(struct heapchunk);
+}
+
+
+// check if the header of a mapped file has the layout of this build, as the items are only valid in a
+// build with the same settings
+int __arena_matches(const struct memoryarena *a_arena)
+{
+  assert(a_arena);
+
+  return a_arena->m_magic == ARENA_MAGIC && a_arena->m_version == ARENA_VERSION && a_arena->m_settings == ARENA_SETTINGS &&
+    a_arena->m_slots == ALLOC_SLOTS && a_arena->m_poolsize == sizeof(struct memorypool) &&
+    a_arena->m_chunksize == sizeof(struct memorychunk) && a_arena->m_heapsize == sizeof(struct heapchunk);
 }
 
 
@@ -570,26 +1454,15 @@ void *__chunk_item_data(struct memorychunk *a_chunk, int a_index)
 
   ptr = (char *) a_chunk;
   ptr += sizeof(struct memorychunk);
-  ptr += sizeof(int);
-  ptr += sizeof(int);
-
-#if __h_config_memory_pool_tracking
-  ptr += sizeof(int);
-  ptr += sizeof(int);
-#endif
-
-  ptr += sizeof(struct memorychunk *);
-  ptr += (a_index * (sizeof(int) + sizeof(struct memorychunk) + a_chunk->m_size));
-
-#if __h_config_memory_pool_tracking
-  ptr += ((sizeof(int) + sizeof(int)) * a_index);
-#endif
+  ptr += a_chunk->m_colour;
+  ptr += sizeof(intptr_t) * ALLOC_SLOTS;
+  ptr += (a_index * __chunk_item_stride(a_chunk->m_size));
 
   return (void *) ptr;
 }
 
 
-int *__chunk_item_header(struct memorychunk *a_chunk, int a_index)
+intptr_t *__chunk_item_header(struct memorychunk *a_chunk, int a_index)
 {
   char *ptr;
 
@@ -599,13 +1472,10 @@ int *__chunk_item_header(struct memorychunk *a_chunk, int a_index)
 
   ptr = (char *) a_chunk;
   ptr += sizeof(struct memorychunk);
-  ptr += (a_index * (sizeof(int) + sizeof(struct memorychunk) + a_chunk->m_size));
-
-#if __h_config_memory_pool_tracking
-  ptr += ((sizeof(int) + sizeof(int)) * a_index);
-#endif
+  ptr += a_chunk->m_colour;
+  ptr += (a_index * __chunk_item_stride(a_chunk->m_size));
 
-  return (int *) ptr;
+  return (intptr_t *) ptr;
 }
 
 
@@ -619,21 +1489,10 @@ int *__chunk_item_footer(struct memorychunk *a_chunk, int a_index)
 
   ptr = (char *) a_chunk;
   ptr += sizeof(struct memorychunk);
-  ptr += sizeof(int);
-  ptr += sizeof(int);
-
-#if __h_config_memory_pool_tracking
-  ptr += sizeof(int);
-  ptr += sizeof(int);
-#endif
-
-  ptr += sizeof(struct memorychunk *);
+  ptr += a_chunk->m_colour;
+  ptr += sizeof(intptr_t) * ALLOC_SLOTS;
   ptr += a_chunk->m_size;
-  ptr += (a_index * (sizeof(int) + sizeof(struct memorychunk) + a_chunk->m_size));
-
-#if __h_config_memory_pool_tracking
-  ptr += ((sizeof(int) + sizeof(int)) * a_index);
-#endif
+  ptr += (a_index * __chunk_item_stride(a_chunk->m_size));
 
   return (int *) ptr;
 }
@@ -652,29 +1511,30 @@ void __show_pool_allocations(struct memorypool *a_pool)
   {
     if (a_pool->m_chunks[i])
     {
-      __show_chunk_allocations(a_pool->m_chunks[i]);
+      __show_chunk_allocations(a_pool, a_pool->m_chunks[i]);
     }
   }
 
   if (a_pool->m_heap)
   {
-    __show_heap_allocations(a_pool->m_heap);
+    __show_heap_allocations(a_pool, a_pool->m_heap);
   }
 
   _RPT0(0, "\n");
 }
 
 
-void __show_chunk_allocations(struct memorychunk *a_chunk)
+void __show_chunk_allocations(struct memorypool *a_pool, struct memorychunk *a_chunk)
 {
-  int i, mask, line, *header;
+  int i, mask, line;
+  intptr_t *header;
   const char *file;
 
   assert(a_chunk);
 
   if (a_chunk->m_next)
   {
-    __show_chunk_allocations(a_chunk->m_next);
+    __show_chunk_allocations(a_pool, a_chunk->m_next);
   }
 
   if (a_chunk->m_mask)
@@ -688,7 +1548,7 @@ void __show_chunk_allocations(struct memorychunk *a_chunk)
 
         header = __chunk_item_header(a_chunk, i);
 
-        file = (const char *) (int *) header[1];
+        file = __alloc_file(a_pool, (const char *) header[1], a_chunk->m_run[i]);
         line = (int) header[2];
 
         assert(header[0] == ALLOC_HEADER);
@@ -703,28 +1563,79 @@ void __show_chunk_allocations(struct memorychunk *a_chunk)
 }
 
 
-void __show_heap_allocations(struct heapchunk *a_chunk)
+void __show_heap_allocations(struct memorypool *a_pool, struct heapchunk *a_chunk)
 {
   assert(a_chunk);
 
 #if __h_config_memory_pool_tracking
-    __show_allocation("heap", a_chunk->m_file, a_chunk->m_line, a_chunk->m_size);
+    __show_allocation("heap", __alloc_file(a_pool, a_chunk->m_file, a_chunk->m_run), (int) a_chunk->m_line, a_chunk->m_size);
 #else
     __show_allocation("", 0, a_chunk->m_size);
 #endif
 
   if (a_chunk->m_next)
   {
-    __show_heap_allocations(a_chunk->m_next);
+    __show_heap_allocations(a_pool, a_chunk->m_next);
   }
 }
 
 
-void __show_allocation(const char *a_source, const char *a_file, int a_line, int a_size)
+void __show_allocation(const char *a_source, const char *a_file, int a_line, size_t a_size)
 {
-  _RPT4(0, "  %04d byte %s chunk: %s(%d)\n", a_size, a_source, a_file, a_line);
+  _RPT4(0, "  %04Iu byte %s chunk: %s(%d)\n", a_size, a_source, a_file, a_line);
 }
 
 
-// -- EOF
+void __diff_site(struct memorysites *a_sites, const char *a_file, int a_line, size_t a_bytes)
+{
+  struct memorysite *site;
+  uint32 hash;
+  int i;
+
+  assert(a_sites);
+
+  hash = ((uint32) (intptr_t) a_file >> 2) * 31 + (uint32) a_line;
+
+  // find the site with open addressing, or group it with the other sites if the table is full
+  for (i = 0; i < DIFF_SITES; i++)
+  {
+    site = &a_sites->m_site[(hash + i) % DIFF_SITES];
+
+    if (!site->m_count)
+    {
+      site->m_file = a_file;
+      site->m_line = a_line;
+      a_sites->m_count++;
+      break;
+    }
+
+    if (site->m_file == a_file && site->m_line == a_line)
+    {
+      break;
+    }
+  }
 
+  if (i == DIFF_SITES)
+  {
+    site = &a_sites->m_other;
+  }
+
+  site->m_count++;
+  site->m_bytes += a_bytes;
+}
+
+
+void __diff_report(void *a_context, const char *a_file, int a_line, int a_count, size_t a_bytes)
+{
+  _RPT4(0, "  %d allocations, %Iu bytes: %s(%d)\n", a_count, a_bytes, a_file, a_line);
+}
+
+
+// the tracked file name of an allocation, which is only valid if it was made since the pool was opened
+const char *__alloc_file(struct memorypool *a_pool, const char *a_file, uint32 a_run)
+{
+  return (a_run == a_pool->m_run) ? a_file : g_memorypool_image;
+}
+
+
+// -- EOF
@@ -6,15 +6,58 @@
 extern "C" {
 #endif // __cplusplus
 
+#include <assert.h>
 #include "config.h"
 
+// the number of chunk classes in a memory pool
+#define MEMORYPOOL_CLASSES 7
+
+// the number of buckets in a memory pool profile
+#define MEMORYPOOL_PROFILE_BUCKETS 32
+
 // forward declarations
 typedef struct memorypool;
 
+// a histogram of the allocation sizes made from a memory pool, which can be saved and used to tune
+// the chunk classes of a new pool. m_count[i] is the number of allocations of (i * 8, i * 8 + 8] bytes.
+struct memorypool_profile
+{
+  uint32 m_count[MEMORYPOOL_PROFILE_BUCKETS];
+};
+
+// function prototype for enumerating the call sites found by memorypool_diff_enum
+typedef void (*memorypool_diff_func)(void *a_context, const char *a_file, int a_line, int a_count, size_t a_bytes);
+
 // allocte a new memory pool
 // returns a pointer to the memory pool
 #define memorypool_alloc() _memorypool_alloc()
 
+// allocate a new memory pool with chunk classes tuned to the allocation sizes in a profile. the classes
+// that the profile does not need are kept near the default sizes.
+// a_profile the profile recorded from memorypool_profile_stop
+// returns a pointer to the memory pool
+#define memorypool_alloc_profiled(a_profile) _memorypool_alloc_profiled(a_profile)
+
+// starts recording the sizes of the allocations made from a memory pool
+// a_pool the memory pool to operate on
+#define memorypool_profile_start(a_pool) _memorypool_profile_start(a_pool)
+
+// stops recording the sizes of the allocations made from a memory pool
+// a_pool the memory pool to operate on
+// a_profile the profile to copy the recorded sizes to
+#define memorypool_profile_stop(a_pool, a_profile) _memorypool_profile_stop(a_pool, a_profile)
+
+// gets the item size of each chunk class of a memory pool
+// a_pool the memory pool to operate on
+// a_sizes an array of MEMORYPOOL_CLASSES sizes to fill
+#define memorypool_classes(a_pool, a_sizes) _memorypool_classes(a_pool, a_sizes)
+
+// sets if the new chunks of a memory pool start their items at different cache line offsets. it is on
+// by default when __h_config_memorypool_colouring is set, and can be turned off to compare the layouts.
+// a_pool the memory pool to operate on
+// a_colouring 1 to colour the new chunks, 0 to start the items of every new chunk at the same offset
+#define memorypool_set_colouring(a_pool, a_colouring) _memorypool_set_colouring(a_pool, a_colouring)
+
 // frees a memory pool (if there are no outstanding allocations, otherwise no action is taken)
 // a_pool the memory pool to operate on
 // returns 0 if no allocations were open and the pool was freed
@@ -32,6 +75,65 @@ typedef struct memorypool;
 // a_pool the memory pool to report on
 #define memorypool_report(a_pool) _memorypool_report(a_pool)
 
+// reserves memory in a pool so a number of allocations of a size can be made without going to the
+// os, which moves the cost of creating and clearing the memory to startup. a pool mapped from a file
+// reserves what fits if the file fills up.
+// a_pool the pool to reserve memory in, otherwise the global pool is used if 0 is specified
+// a_size the size of the allocations to reserve memory for
+// a_count the number of allocations to reserve memory for
+#define memorypool_reserve(a_pool, a_size, a_count) _memorypool_reserve(a_pool, a_size, a_count)
+
+// starts a new allocation generation, which is stamped on every allocation made after this call
+// a_pool the memory pool to operate on
+// returns the new generation, to be passed to memorypool_diff
+#define memorypool_checkpoint(a_pool) _memorypool_checkpoint(a_pool)
+
+// reports the allocations that are still open and were made since the given generation, grouped
+// by call site (requires __h_config_memory_pool_tracking)
+// a_pool the memory pool to report on
+// a_generation the generation returned from memorypool_checkpoint
+#define memorypool_diff(a_pool, a_generation) _memorypool_diff(a_pool, a_generation)
+
+// enumerates the allocations that are still open and were made since the given generation, calling
+// the function once for each call site with the number of allocations and the bytes they use
+// a_pool the memory pool to operate on
+// a_generation the generation returned from memorypool_checkpoint
+// a_funcptr the function to call for each call site
+// a_context passed to the function
+// returns the number of call sites
+#define memorypool_diff_enum(a_pool, a_generation, a_funcptr, a_context) _memorypool_diff_enum(a_pool, a_generation, a_funcptr, a_context)
+
+// open (or create) a memory pool that is backed by a memory mapped file, so that all allocations made
+// from the pool (and any containers built in it) persist in the file and are available again when the
+// file is reopened. an existing file is always mapped at the address it was created at, as the
+// containers store absolute pointers.
+// a_path the path of the file to open or create
+// a_size the size of the file to create (ignored if the file already exists)
+// a_base the address to map a new file at, or 0 to let the system choose
+// returns a pointer to the memory pool, or 0 if the file could not be mapped at its base address or
+// was created by a build with a different pool layout
+#define memorypool_map(a_path, a_size, a_base) _memorypool_map(a_path, a_size, a_base)
+
+// unmaps a file backed memory pool, writing all changes to the file. outstanding allocations are kept
+// in the file and are not reported.
+// a_pool the memory pool to operate on
+#define memorypool_unmap(a_pool) _memorypool_unmap(a_pool)
+
+// flushes all changes to a file backed memory pool to disk
+// a_pool the memory pool to operate on
+#define memorypool_sync(a_pool) _memorypool_sync(a_pool)
+
+// gets the root object of a file backed memory pool, which is used to find the data in the file
+// after it has been reopened
+// a_pool the memory pool to operate on
+// returns the root object, or 0 if it has not been set
+#define memorypool_root(a_pool) _memorypool_root(a_pool)
+
+// sets the root object of a file backed memory pool
+// a_pool the memory pool to operate on
+// a_root a pointer to memory allocated from the pool
+#define memorypool_set_root(a_pool, a_root) _memorypool_set_root(a_pool, a_root)
+
 // allocate memory from the given memory pool
 // a_pool the pool to allocate from, otherwise the global pool is used if 0 is specified
 // returns a pointer to the allocated memory or 0 on failure
@@ -47,6 +149,13 @@ typedef struct memorypool;
 // a_mem a pointer to the memory to free
 #define pfree(a_pool, a_mem) _pfree(a_pool, a_mem)
 
+// gets the size in bytes of an array of items, checking that the multiply does not overflow. an
+// overflowed size asserts and saturates to the largest size, so the allocation made with it fails
+// a_count the number of items
+// a_size the size of each item
+// returns the size of the array in bytes
+#define psize(a_count, a_size) _psize(a_count, a_size)
+
 // allocate memory from the global memory pool
 // returns a pointer to the allocated memory or 0 on failure
 #define gpalloc(a_size) _palloc(__FILE__, __LINE__, 0, a_size)
@@ -61,14 +170,40 @@ typedef struct memorypool;
 
 // interface functions
 struct memorypool *_memorypool_alloc();
+struct memorypool *_memorypool_alloc_profiled(const struct memorypool_profile *a_profile);
+void _memorypool_profile_start(struct memorypool *a_pool);
+void _memorypool_profile_stop(struct memorypool *a_pool, struct memorypool_profile *a_profile);
+void _memorypool_classes(struct memorypool *a_pool, uint32 *a_sizes);
+void _memorypool_set_colouring(struct memorypool *a_pool, int a_colouring);
 int _memorypool_free(struct memorypool *a_pool);
 void _memorypool_trunc(struct memorypool *a_pool);
 void _memorypool_global(struct memorypool *a_pool);
 void _memorypool_report(struct memorypool *a_pool);
-void *_palloc(const char *a_file, int a_line, struct memorypool *a_pool, uint32 a_size);
-void *_prealloc(const char *a_file, int a_line, struct memorypool *a_pool, void *a_mem, uint32 a_size);
+void _memorypool_reserve(struct memorypool *a_pool, size_t a_size, size_t a_count);
+uint32 _memorypool_checkpoint(struct memorypool *a_pool);
+void _memorypool_diff(struct memorypool *a_pool, uint32 a_generation);
+int _memorypool_diff_enum(struct memorypool *a_pool, uint32 a_generation, memorypool_diff_func a_funcptr, void *a_context);
+struct memorypool *_memorypool_map(const char *a_path, uint32 a_size, void *a_base);
+void _memorypool_unmap(struct memorypool *a_pool);
+void _memorypool_sync(struct memorypool *a_pool);
+void *_memorypool_root(struct memorypool *a_pool);
+void _memorypool_set_root(struct memorypool *a_pool, void *a_root);
+void *_palloc(const char *a_file, int a_line, struct memorypool *a_pool, size_t a_size);
+void *_prealloc(const char *a_file, int a_line, struct memorypool *a_pool, void *a_mem, size_t a_size);
 void _pfree(struct memorypool *a_pool, void *a_mem);
 
+// inline functions
+static inline size_t _psize(size_t a_count, size_t a_size)
+{
+  if (a_size && a_count > ((size_t) ~0) / a_size)
+  {
+    assert(0);
+    return (size_t) ~0;
+  }
+
+  return a_count * a_size;
+}
+
 #ifdef  __cplusplus
 }
 #endif // __cplusplus
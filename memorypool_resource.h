@@ -0,0 +1,123 @@
+
+#ifndef __h_memorypool_resource
+#define __h_memorypool_resource
+
+// this header needs c++17 for <memory_resource>, which is VS2017 15.6 or later with /std:c++17. it is
+// not part of the VS2008 project, which builds the c containers only.
+#ifndef __cplusplus
+#error memorypool_resource.h can only be used from c++
+#endif // __cplusplus
+
+#if (defined(_MSVC_LANG) ? _MSVC_LANG : __cplusplus) < 201703L
+#error memorypool_resource.h needs c++17
+#endif
+
+#include <assert.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <new>
+
+#include "memorypool.h"
+
+// the alignment of the memory returned from palloc, which follows the pointer sized slots before each
+// allocation (only 4 bytes in 32 bit builds)
+#define MEMORYPOOL_ALIGNMENT sizeof(std::intptr_t)
+
+// declare a memory resource that tracks its allocations against the line it is declared on
+// a_name the name of the memory resource variable
+// a_pool the memory pool to allocate from, otherwise the global pool is used if 0 is specified
+#define memorypool_resource_decl(a_name, a_pool) memorypool_resource a_name(a_pool, __FILE__, __LINE__)
+
+// a std::pmr::memory_resource that allocates from a memory pool, so the standard containers can
+// share the same pools as the c containers. the call site of each allocation is the one the resource
+// was created with, as the real call site is inside the standard library.
+class memorypool_resource : public std::pmr::memory_resource
+{
+public:
+  // create a memory resource
+  // a_pool the memory pool to allocate from, otherwise the global pool is used if 0 is specified
+  // a_file, a_line the call site to track the allocations against
+  explicit memorypool_resource(struct memorypool *a_pool, const char *a_file = __FILE__, int a_line = __LINE__)
+    : m_pool(a_pool), m_file(a_file), m_line(a_line)
+  {
+  }
+
+  // get the memory pool the resource allocates from
+  // returns the memory pool
+  struct memorypool *pool() const
+  {
+    return m_pool;
+  }
+
+protected:
+  virtual void *do_allocate(std::size_t a_bytes, std::size_t a_alignment)
+  {
+    // locals
+    char *mem, *aligned;
+
+    // the pool returns memory that is aligned well enough for most types
+    if (a_alignment <= MEMORYPOOL_ALIGNMENT)
+    {
+      mem = (char *) _palloc(m_file, m_line, m_pool, a_bytes);
+      if (!mem)
+      {
+        throw std::bad_alloc();
+      }
+
+      assert(((std::size_t) mem & (a_alignment - 1)) == 0);
+      return mem;
+    }
+
+    // otherwise over allocate and store the pointer to free just before the aligned memory
+    if (a_bytes > ((std::size_t) ~0) - a_alignment - sizeof(void *))
+    {
+      throw std::bad_alloc();
+    }
+
+    mem = (char *) _palloc(m_file, m_line, m_pool, a_bytes + a_alignment + sizeof(void *));
+    if (!mem)
+    {
+      throw std::bad_alloc();
+    }
+
+    aligned = (char *) (((std::size_t) mem + sizeof(void *) + a_alignment - 1) & ~(a_alignment - 1));
+    ((void **) aligned)[-1] = mem;
+
+    return aligned;
+  }
+
+  virtual void do_deallocate(void *a_mem, std::size_t a_bytes, std::size_t a_alignment)
+  {
+    // checks
+    assert(a_mem);
+
+    // find the memory that was allocated for over aligned memory
+    if (a_alignment > MEMORYPOOL_ALIGNMENT)
+    {
+      a_mem = ((void **) a_mem)[-1];
+    }
+
+    pfree(m_pool, a_mem);
+  }
+
+  virtual bool do_is_equal(const std::pmr::memory_resource &a_other) const noexcept
+  {
+    // locals
+    const memorypool_resource *other;
+
+    // resources are equal if they share the same pool, as either one can free the memory
+    other = dynamic_cast<const memorypool_resource *>(&a_other);
+    return other && other->m_pool == m_pool;
+  }
+
+private:
+  struct memorypool *m_pool;  // the memory pool to allocate from
+  const char *m_file;         // the file to track allocations against
+  int m_line;                 // the line to track allocations against
+};
+
+#endif // __h_memorypool_resource
+
+// -- EOF
+
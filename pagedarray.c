@@ -0,0 +1,181 @@
+
+#include "pagedarray.h"
+
+#include <assert.h>
+#include <memory.h>
+#include <stdlib.h>
+#include <windows.h>
+
+#include "memorypool.h"
+
+// the page of zeros that every page points at until it is written to
+static char g_pagedarray_zeros[PAGEDARRAY_PAGE_SIZE];
+
+// the second level table that every table points at until a page in it is written to
+static char *g_pagedarray_empty[PAGEDARRAY_TABLE_SIZE];
+
+// set to 1 by the thread that fills the empty table, and to 2 once the table is filled
+static volatile LONG g_pagedarray_ready = 0;
+
+
+void __pagedarray_init();
+
+
+// allocate a new paged array
+struct pagedarray *_pagedarray_alloc(int a_elemsize, struct memorypool *a_pool, const char *a_file, int a_line)
+{
+  // locals
+  struct pagedarray *ptr;
+  int i, tables;
+
+  // checks
+  assert(a_elemsize > 0 && a_elemsize <= PAGEDARRAY_PAGE_SIZE);
+
+  __pagedarray_init();
+
+  // allocate the paged array structure memory
+  ptr = (struct pagedarray *) _palloc(a_file, a_line, a_pool, sizeof(struct pagedarray));
+  assert(ptr);
+
+  ptr->m_elemsize = a_elemsize;
+  ptr->m_pages = 0;
+  ptr->m_pool = a_pool;
+
+  // fit as many elements in a page as possible, as a power of two
+  for (ptr->m_pageshift = 0; (a_elemsize << (ptr->m_pageshift + 1)) <= PAGEDARRAY_PAGE_SIZE; ptr->m_pageshift++)
+  {
+  }
+
+  ptr->m_tableshift = ptr->m_pageshift + PAGEDARRAY_TABLE_BITS;
+
+  // the first level table covers the rest of the index bits
+  tables = 1 << (32 - ptr->m_tableshift);
+  ptr->m_table = (char ***) _palloc(a_file, a_line, a_pool, sizeof(char **) * tables);
+  assert(ptr->m_table);
+
+  for (i = 0; i < tables; i++)
+  {
+    ptr->m_table[i] = g_pagedarray_empty;
+  }
+
+  // return a pointer to the paged array
+  return ptr;
+}
+
+
+// free a paged array
+void _pagedarray_free(struct pagedarray *a_array)
+{
+  // locals
+  char **table;
+  int i, j, tables;
+
+  // checks
+  assert(a_array);
+
+  // free the tables and pages that were written to
+  tables = 1 << (32 - a_array->m_tableshift);
+
+  for (i = 0; i < tables; i++)
+  {
+    table = a_array->m_table[i];
+    if (table == g_pagedarray_empty)
+    {
+      continue;
+    }
+
+    for (j = 0; j < PAGEDARRAY_TABLE_SIZE; j++)
+    {
+      if (table[j] != g_pagedarray_zeros)
+      {
+        pfree(a_array->m_pool, table[j]);
+      }
+    }
+
+    pfree(a_array->m_pool, table);
+  }
+
+  pfree(a_array->m_pool, a_array->m_table);
+  pfree(a_array->m_pool, a_array);
+}
+
+
+// get a pointer to an element to write
+void *_pagedarray_index(struct pagedarray *a_array, uint32 a_index, const char *a_file, int a_line)
+{
+  // locals
+  char **table;
+  char *page;
+  int i, size;
+
+  // checks
+  assert(a_array);
+
+  // give the table its own copy of the empty table when a page in it is first written to
+  table = a_array->m_table[a_index >> a_array->m_tableshift];
+
+  if (table == g_pagedarray_empty)
+  {
+    table = (char **) _palloc(a_file, a_line, a_array->m_pool, sizeof(char *) * PAGEDARRAY_TABLE_SIZE);
+    assert(table);
+
+    for (i = 0; i < PAGEDARRAY_TABLE_SIZE; i++)
+    {
+      table[i] = g_pagedarray_zeros;
+    }
+
+    a_array->m_table[a_index >> a_array->m_tableshift] = table;
+  }
+
+  // allocate the page when it is first written to
+  page = table[(a_index >> a_array->m_pageshift) & (PAGEDARRAY_TABLE_SIZE - 1)];
+
+  if (page == g_pagedarray_zeros)
+  {
+    size = a_array->m_elemsize << a_array->m_pageshift;
+
+    page = (char *) _palloc(a_file, a_line, a_array->m_pool, size);
+    assert(page);
+
+    memset(page, 0, size);
+    table[(a_index >> a_array->m_pageshift) & (PAGEDARRAY_TABLE_SIZE - 1)] = page;
+    a_array->m_pages++;
+  }
+
+  return page + (a_index & ((1 << a_array->m_pageshift) - 1)) * a_array->m_elemsize;
+}
+
+
+// fill the empty table on the first call. one thread fills the table while any others wait, so no thread
+// sees the table before every entry is set.
+void __pagedarray_init()
+{
+  // locals
+  int i;
+
+  if (g_pagedarray_ready == 2)
+  {
+    return;
+  }
+
+  if (InterlockedCompareExchange(&g_pagedarray_ready, 1, 0) == 0)
+  {
+    for (i = 0; i < PAGEDARRAY_TABLE_SIZE; i++)
+    {
+      g_pagedarray_empty[i] = g_pagedarray_zeros;
+    }
+
+    // the exchange is a full barrier, so the entries are written before the table is published
+    InterlockedExchange(&g_pagedarray_ready, 2);
+    return;
+  }
+
+  while (g_pagedarray_ready != 2)
+  {
+    YieldProcessor();
+  }
+}
+
+
+// -- EOF
+
@@ -0,0 +1,87 @@
+
+#ifndef __h_pagedarray
+#define __h_pagedarray
+
+#ifdef  __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "config.h"
+
+// forward declarations
+typedef struct memorypool;
+
+// the largest size of a page in bytes, which holds a power of two number of elements
+#define PAGEDARRAY_PAGE_SIZE    4096
+
+// the number of bits of the index that select a page in a second level table
+#define PAGEDARRAY_TABLE_BITS   10
+#define PAGEDARRAY_TABLE_SIZE   (1 << PAGEDARRAY_TABLE_BITS)
+
+// structure for the paged array, which is public so lookups can be inlined. the index is split into a
+// first level table entry, a second level table entry and an element in a page. tables and pages that
+// have not been written to point at a shared empty table and a shared page of zeros, so a lookup is
+// always two dependent loads with no branches, and memory is only used for pages that are written to.
+struct pagedarray
+{
+  char ***m_table;            // the first level table
+  int m_elemsize;             // the size of each element
+  int m_pageshift;            // the number of index bits for the element in a page
+  int m_tableshift;           // the number of index bits below the first level table entry
+  int m_pages;                // the number of pages that have been allocated
+  struct memorypool *m_pool;  // the memory allocator
+};
+
+// allocate a new paged array with an element for every 32 bit index, which are all zero
+// a_elemsize the size of each element, which must be no larger than PAGEDARRAY_PAGE_SIZE
+// a_pool the memory pool to allocate from
+// returns the newly allocated paged array
+#define pagedarray_alloc(a_elemsize, a_pool) _pagedarray_alloc(a_elemsize, a_pool, __FILE__, __LINE__)
+
+// free the paged array and all allocated memory
+// a_array the paged array to operate on
+#define pagedarray_free(a_array) _pagedarray_free(a_array)
+
+// get a pointer to an element to read, which does not allocate a page. the element must not be written
+// through the pointer, as it may be in the shared page of zeros.
+// a_array the paged array to operate on
+// a_index the index of the element
+// returns a pointer to the element
+#define pagedarray_get(a_array, a_index) _pagedarray_get(a_array, a_index)
+
+// get a pointer to an element to write, which allocates the page it is in if needed
+// a_array the paged array to operate on
+// a_index the index of the element
+// returns a pointer to the element
+#define pagedarray_index(a_array, a_index) _pagedarray_index(a_array, a_index, __FILE__, __LINE__)
+
+// get the number of pages that have been allocated
+// a_array the paged array to operate on
+// returns the number of pages
+#define pagedarray_pages(a_array) ((a_array)->m_pages)
+
+// get the number of elements in each page
+// a_array the paged array to operate on
+// returns the number of elements
+#define pagedarray_page_count(a_array) (1 << (a_array)->m_pageshift)
+
+// interface functions
+struct pagedarray *_pagedarray_alloc(int a_elemsize, struct memorypool *a_pool, const char *a_file, int a_line);
+void _pagedarray_free(struct pagedarray *a_array);
+void *_pagedarray_index(struct pagedarray *a_array, uint32 a_index, const char *a_file, int a_line);
+
+// inline functions
+static inline const void *_pagedarray_get(struct pagedarray *a_array, uint32 a_index)
+{
+  return a_array->m_table[a_index >> a_array->m_tableshift][(a_index >> a_array->m_pageshift) & (PAGEDARRAY_TABLE_SIZE - 1)] +
+    (a_index & ((1 << a_array->m_pageshift) - 1)) * a_array->m_elemsize;
+}
+
+#ifdef  __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __h_pagedarray
+
+// -- EOF
+
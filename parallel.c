@@ -0,0 +1,200 @@
+
+#include "parallel.h"
+
+#include <assert.h>
+#include <memory.h>
+#include <stdlib.h>
+
+#include "array.h"
+#include "arrayview.h"
+#include "memorypool.h"
+#include "threadpool.h"
+#include "vector.h"
+
+// the number of bytes of elements in a chunk by default, which is small enough to stay in the l2 cache
+// of the thread that runs it, but large enough that the cost of taking a job is not noticed
+#define PARALLEL_CHUNK_BYTES 65536
+
+// the state of a parallel for or reduce
+struct parallel
+{
+  const struct array_view *m_view;  // the elements to split into chunks
+  size_t m_grain;                   // the number of elements in each chunk
+  parallel_for_func m_for;          // the function for a parallel for
+  parallel_reduce_func m_reduce;    // the function for a parallel reduce
+  void *m_context;                  // the context to pass to the functions
+  const void *m_initial;            // the initial result of a reduce
+  char *m_partials;                 // the partial result of each chunk of a reduce
+  int m_resultsize;                 // the size of the result of a reduce
+};
+
+
+void __parallel_for_chunk(void *a_context, int a_index);
+void __parallel_reduce_chunk(void *a_context, int a_index);
+size_t __parallel_grain(const struct array_view *a_view, int a_grain);
+
+
+// call a function for each chunk of an array in parallel
+void _array_parallel_for(struct array *a_array, int a_grain, parallel_for_func a_func, void *a_context)
+{
+  // locals
+  struct array_view view;
+
+  array_view_array(&view, a_array, 0, array_count(a_array));
+  _array_view_parallel_for(&view, a_grain, a_func, a_context);
+}
+
+
+// reduce the chunks of an array in parallel
+void _array_parallel_reduce(struct array *a_array, int a_grain, parallel_reduce_func a_func, parallel_combine_func a_combine, void *a_context, void *a_result, int a_resultsize)
+{
+  // locals
+  struct array_view view;
+
+  array_view_array(&view, a_array, 0, array_count(a_array));
+  _array_view_parallel_reduce(&view, a_grain, a_func, a_combine, a_context, a_result, a_resultsize);
+}
+
+
+// call a function for each chunk of a vector in parallel
+void _vector_parallel_for(struct vector *a_vector, int a_grain, parallel_for_func a_func, void *a_context)
+{
+  // locals
+  struct array_view view;
+
+  array_view_vector(&view, a_vector, 0, vector_count(a_vector));
+  _array_view_parallel_for(&view, a_grain, a_func, a_context);
+}
+
+
+// reduce the chunks of a vector in parallel
+void _vector_parallel_reduce(struct vector *a_vector, int a_grain, parallel_reduce_func a_func, parallel_combine_func a_combine, void *a_context, void *a_result, int a_resultsize)
+{
+  // locals
+  struct array_view view;
+
+  array_view_vector(&view, a_vector, 0, vector_count(a_vector));
+  _array_view_parallel_reduce(&view, a_grain, a_func, a_combine, a_context, a_result, a_resultsize);
+}
+
+
+// call a function for each chunk of a view in parallel
+void _array_view_parallel_for(const struct array_view *a_view, int a_grain, parallel_for_func a_func, void *a_context)
+{
+  // locals
+  struct parallel parallel;
+
+  // checks
+  assert(a_view);
+  assert(a_func);
+
+  parallel.m_view = a_view;
+  parallel.m_grain = __parallel_grain(a_view, a_grain);
+  parallel.m_for = a_func;
+  parallel.m_reduce = 0;
+  parallel.m_context = a_context;
+  parallel.m_initial = 0;
+  parallel.m_partials = 0;
+  parallel.m_resultsize = 0;
+
+  threadpool_run(0, __parallel_for_chunk, &parallel, (int) (a_view->m_count / parallel.m_grain + (a_view->m_count % parallel.m_grain != 0)));
+}
+
+
+// reduce the chunks of a view in parallel
+void _array_view_parallel_reduce(const struct array_view *a_view, int a_grain, parallel_reduce_func a_func, parallel_combine_func a_combine, void *a_context, void *a_result, int a_resultsize)
+{
+  // locals
+  struct parallel parallel;
+  int chunks, i;
+
+  // checks
+  assert(a_view);
+  assert(a_func);
+  assert(a_combine);
+  assert(a_result);
+  assert(a_resultsize > 0);
+
+  parallel.m_view = a_view;
+  parallel.m_grain = __parallel_grain(a_view, a_grain);
+  parallel.m_for = 0;
+  parallel.m_reduce = a_func;
+  parallel.m_context = a_context;
+  parallel.m_initial = a_result;
+  parallel.m_resultsize = a_resultsize;
+
+  chunks = (int) (a_view->m_count / parallel.m_grain + (a_view->m_count % parallel.m_grain != 0));
+  if (chunks == 0)
+  {
+    return;
+  }
+
+  // the partial results are allocated up front, as the memory pools are not thread safe
+  parallel.m_partials = (char *) gpalloc(psize(chunks, a_resultsize));
+  assert(parallel.m_partials);
+
+  threadpool_run(0, __parallel_reduce_chunk, &parallel, chunks);
+
+  for (i = 0; i < chunks; i++)
+  {
+    a_combine(a_context, a_result, parallel.m_partials + (size_t) i * a_resultsize);
+  }
+
+  gpfree(parallel.m_partials);
+}
+
+
+// call the function for one chunk of a parallel for
+void __parallel_for_chunk(void *a_context, int a_index)
+{
+  // locals
+  struct parallel *parallel;
+  struct array_view range;
+  size_t start;
+
+  parallel = (struct parallel *) a_context;
+  start = (size_t) a_index * parallel->m_grain;
+
+  array_view_slice(&range, parallel->m_view, start, min(parallel->m_grain, parallel->m_view->m_count - start));
+  parallel->m_for(parallel->m_context, &range, start);
+}
+
+
+// call the function for one chunk of a parallel reduce
+void __parallel_reduce_chunk(void *a_context, int a_index)
+{
+  // locals
+  struct parallel *parallel;
+  struct array_view range;
+  char *partial;
+  size_t start;
+
+  parallel = (struct parallel *) a_context;
+  start = (size_t) a_index * parallel->m_grain;
+  partial = parallel->m_partials + (size_t) a_index * parallel->m_resultsize;
+
+  // each chunk starts from the initial result
+  memcpy(partial, parallel->m_initial, parallel->m_resultsize);
+
+  array_view_slice(&range, parallel->m_view, start, min(parallel->m_grain, parallel->m_view->m_count - start));
+  parallel->m_reduce(parallel->m_context, &range, start, partial);
+}
+
+
+// get the number of elements in each chunk, which is raised if needed so the number of chunks fits
+// in the int count of the thread pool
+size_t __parallel_grain(const struct array_view *a_view, int a_grain)
+{
+  // locals
+  size_t grain;
+
+  // checks
+  assert(a_grain >= 0);
+
+  grain = (a_grain > 0) ? (size_t) a_grain : max(1, PARALLEL_CHUNK_BYTES / a_view->m_stride);
+  return max(grain, a_view->m_count / 0x7fffffff + 1);
+}
+
+
+// -- EOF
+
@@ -0,0 +1,108 @@
+
+#ifndef __h_parallel
+#define __h_parallel
+
+#ifdef  __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "config.h"
+
+// forward declarations
+typedef struct array;
+typedef struct vector;
+typedef struct array_view;
+
+// the function that is called for each chunk of a parallel for
+// a_context the context passed to the parallel for
+// a_range a view of the elements in the chunk
+// a_start the index of the first element of the chunk
+typedef void (*parallel_for_func)(void *a_context, const struct array_view *a_range, size_t a_start);
+
+// the function that is called for each chunk of a parallel reduce
+// a_context the context passed to the parallel reduce
+// a_range a view of the elements in the chunk
+// a_start the index of the first element of the chunk
+// a_result the partial result for the chunk, which starts as a copy of the initial result
+typedef void (*parallel_reduce_func)(void *a_context, const struct array_view *a_range, size_t a_start, void *a_result);
+
+// the function that combines the partial result of a chunk into the result
+// a_context the context passed to the parallel reduce
+// a_result the result to combine into
+// a_partial the partial result of a chunk
+typedef void (*parallel_combine_func)(void *a_context, void *a_result, const void *a_partial);
+
+// the parallel functions split the elements into chunks and call the function for each chunk on the
+// global thread pool. a grain of 0 sizes the chunks to fit in the cache. the partial results of a
+// reduce are combined in chunk order on the calling thread, so the result is the same each time.
+
+// call a function for each chunk of an array in parallel
+// a_array the array to operate on
+// a_grain the number of elements in each chunk, or 0 for the default
+// a_func the function to call for each chunk
+// a_context the context to pass to each call
+#define array_parallel_for(a_array, a_grain, a_func, a_context) _array_parallel_for(a_array, a_grain, a_func, a_context)
+
+// reduce the chunks of an array in parallel
+// a_array the array to operate on
+// a_grain the number of elements in each chunk, or 0 for the default
+// a_func the function to call for each chunk
+// a_combine the function to combine the partial result of each chunk into the result
+// a_context the context to pass to each call
+// a_result the result, which must be set to the initial (identity) value for the reduce
+// a_resultsize the size of the result
+#define array_parallel_reduce(a_array, a_grain, a_func, a_combine, a_context, a_result, a_resultsize) \
+  _array_parallel_reduce(a_array, a_grain, a_func, a_combine, a_context, a_result, a_resultsize)
+
+// call a function for each chunk of a vector in parallel
+// a_vector the vector to operate on
+// a_grain the number of elements in each chunk, or 0 for the default
+// a_func the function to call for each chunk
+// a_context the context to pass to each call
+#define vector_parallel_for(a_vector, a_grain, a_func, a_context) _vector_parallel_for(a_vector, a_grain, a_func, a_context)
+
+// reduce the chunks of a vector in parallel
+// a_vector the vector to operate on
+// a_grain the number of elements in each chunk, or 0 for the default
+// a_func the function to call for each chunk
+// a_combine the function to combine the partial result of each chunk into the result
+// a_context the context to pass to each call
+// a_result the result, which must be set to the initial (identity) value for the reduce
+// a_resultsize the size of the result
+#define vector_parallel_reduce(a_vector, a_grain, a_func, a_combine, a_context, a_result, a_resultsize) \
+  _vector_parallel_reduce(a_vector, a_grain, a_func, a_combine, a_context, a_result, a_resultsize)
+
+// call a function for each chunk of a view in parallel
+// a_view the view to operate on
+// a_grain the number of elements in each chunk, or 0 for the default
+// a_func the function to call for each chunk
+// a_context the context to pass to each call
+#define array_view_parallel_for(a_view, a_grain, a_func, a_context) _array_view_parallel_for(a_view, a_grain, a_func, a_context)
+
+// reduce the chunks of a view in parallel
+// a_view the view to operate on
+// a_grain the number of elements in each chunk, or 0 for the default
+// a_func the function to call for each chunk
+// a_combine the function to combine the partial result of each chunk into the result
+// a_context the context to pass to each call
+// a_result the result, which must be set to the initial (identity) value for the reduce
+// a_resultsize the size of the result
+#define array_view_parallel_reduce(a_view, a_grain, a_func, a_combine, a_context, a_result, a_resultsize) \
+  _array_view_parallel_reduce(a_view, a_grain, a_func, a_combine, a_context, a_result, a_resultsize)
+
+// interface functions
+void _array_parallel_for(struct array *a_array, int a_grain, parallel_for_func a_func, void *a_context);
+void _array_parallel_reduce(struct array *a_array, int a_grain, parallel_reduce_func a_func, parallel_combine_func a_combine, void *a_context, void *a_result, int a_resultsize);
+void _vector_parallel_for(struct vector *a_vector, int a_grain, parallel_for_func a_func, void *a_context);
+void _vector_parallel_reduce(struct vector *a_vector, int a_grain, parallel_reduce_func a_func, parallel_combine_func a_combine, void *a_context, void *a_result, int a_resultsize);
+void _array_view_parallel_for(const struct array_view *a_view, int a_grain, parallel_for_func a_func, void *a_context);
+void _array_view_parallel_reduce(const struct array_view *a_view, int a_grain, parallel_reduce_func a_func, parallel_combine_func a_combine, void *a_context, void *a_result, int a_resultsize);
+
+#ifdef  __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __h_parallel
+
+// -- EOF
+
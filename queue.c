@@ -0,0 +1,385 @@
+
+#include "queue.h"
+
+#include <assert.h>
+#include <memory.h>
+#include <stdlib.h>
+#include <windows.h>
+
+#include "memorypool.h"
+
+// the size of a cache line, which separates the fields written by different threads
+#define QUEUE_CACHE_LINE 64
+
+// the size of the sequence number at the start of each mpmc slot. slots are a multiple of 8 bytes, so each
+// element has the alignment of the queue memory, which is only 4 bytes in 32 bit builds.
+#define QUEUE_SEQUENCE_SIZE 8
+
+// structure for the single producer single consumer queue. the positions count up forever and wrap
+// around at 2^32, the slot is the position masked by the capacity. each side keeps a copy of the
+// other side's position and only reads the shared one when its copy says the queue is full or empty.
+struct spscqueue
+{
+  struct memorypool *m_pool;  // the memory allocator
+  char *m_data;               // the slots
+  int m_elemsize;             // the size of each element
+  uint32 m_mask;              // the capacity minus one
+  char m_pad0[QUEUE_CACHE_LINE];
+  volatile LONG m_tail;       // the position of the next element to push, written by the producer
+  LONG m_headcache;           // the producer's copy of m_head
+  char m_pad1[QUEUE_CACHE_LINE];
+  volatile LONG m_head;       // the position of the next element to pop, written by the consumer
+  LONG m_tailcache;           // the consumer's copy of m_tail
+  char m_pad2[QUEUE_CACHE_LINE];
+};
+
+// structure for the multiple producer multiple consumer queue. each slot starts with a sequence number,
+// which is the position the slot can be pushed at when it is empty, and the position plus one when it
+// holds an element that can be popped. popping an element sets it to the position in the next lap.
+struct mpmcqueue
+{
+  struct memorypool *m_pool;  // the memory allocator
+  char *m_data;               // the slots
+  int m_elemsize;             // the size of each element
+  int m_slotsize;             // the size of each slot, including the sequence number
+  uint32 m_mask;              // the capacity minus one
+  char m_pad0[QUEUE_CACHE_LINE];
+  volatile LONG m_tail;       // the position of the next element to push
+  char m_pad1[QUEUE_CACHE_LINE];
+  volatile LONG m_head;       // the position of the next element to pop
+  char m_pad2[QUEUE_CACHE_LINE];
+};
+
+
+// get the capacity for a requested number of elements
+static uint32 __queue_capacity(int a_capacity)
+{
+  // locals
+  uint32 capacity;
+
+  // checks
+  assert(a_capacity > 0 && a_capacity <= 0x40000000);
+
+  for (capacity = 1; capacity < (uint32) a_capacity; capacity <<= 1)
+  {
+  }
+
+  return capacity;
+}
+
+
+// get the sequence number of an mpmc slot
+static inline volatile LONG *__mpmcqueue_sequence(struct mpmcqueue *a_queue, uint32 a_position)
+{
+  return (volatile LONG *) (a_queue->m_data + (a_position & a_queue->m_mask) * a_queue->m_slotsize);
+}
+
+
+// allocate a single producer single consumer queue
+struct spscqueue *_spscqueue_alloc(int a_elemsize, int a_capacity, struct memorypool *a_pool, const char *a_file, int a_line)
+{
+  // locals
+  struct spscqueue *ptr;
+  uint32 capacity;
+
+  // checks
+  assert(a_elemsize > 0);
+
+  capacity = __queue_capacity(a_capacity);
+
+  // allocate the queue structure memory
+  ptr = (struct spscqueue *) _palloc(a_file, a_line, a_pool, sizeof(struct spscqueue));
+  assert(ptr);
+
+  memset(ptr, 0, sizeof(struct spscqueue));
+  ptr->m_pool = a_pool;
+  ptr->m_elemsize = a_elemsize;
+  ptr->m_mask = capacity - 1;
+
+  ptr->m_data = (char *) _palloc(a_file, a_line, a_pool, psize(capacity, a_elemsize));
+  assert(ptr->m_data);
+
+  // return a pointer to the queue
+  return ptr;
+}
+
+
+// free a single producer single consumer queue
+void _spscqueue_free(struct spscqueue *a_queue)
+{
+  // checks
+  assert(a_queue);
+
+  pfree(a_queue->m_pool, a_queue->m_data);
+  pfree(a_queue->m_pool, a_queue);
+}
+
+
+// add elements to a single producer single consumer queue
+int _spscqueue_push_n(struct spscqueue *a_queue, const void *a_src, int a_count)
+{
+  // locals
+  uint32 tail, slot, space, first;
+
+  // checks
+  assert(a_queue);
+  assert(a_count >= 0);
+  assert(a_src || !a_count);
+
+  // only the producer writes the tail, so it can be read without a barrier
+  tail = (uint32) a_queue->m_tail;
+  space = a_queue->m_mask + 1 - (tail - (uint32) a_queue->m_headcache);
+
+  // read the head the consumer has written when the copy of it does not leave enough space
+  if (space < (uint32) a_count)
+  {
+    a_queue->m_headcache = InterlockedCompareExchange(&a_queue->m_head, 0, 0);
+    space = a_queue->m_mask + 1 - (tail - (uint32) a_queue->m_headcache);
+  }
+
+  a_count = (int) min((uint32) a_count, space);
+
+  if (!a_count)
+  {
+    return 0;
+  }
+
+  // copy the elements in at most two pieces, where the ring wraps around
+  slot = tail & a_queue->m_mask;
+  first = min((uint32) a_count, a_queue->m_mask + 1 - slot);
+
+  memcpy(a_queue->m_data + slot * a_queue->m_elemsize, a_src, first * a_queue->m_elemsize);
+  memcpy(a_queue->m_data, (const char *) a_src + first * a_queue->m_elemsize, (a_count - first) * a_queue->m_elemsize);
+
+  // publish the elements to the consumer, the exchange makes sure the copies are visible first
+  InterlockedExchange(&a_queue->m_tail, (LONG) (tail + a_count));
+
+  return a_count;
+}
+
+
+// remove elements from a single producer single consumer queue
+int _spscqueue_pop_n(struct spscqueue *a_queue, void *a_dst, int a_count)
+{
+  // locals
+  uint32 head, slot, available, first;
+
+  // checks
+  assert(a_queue);
+  assert(a_count >= 0);
+  assert(a_dst || !a_count);
+
+  // only the consumer writes the head, so it can be read without a barrier
+  head = (uint32) a_queue->m_head;
+  available = (uint32) a_queue->m_tailcache - head;
+
+  // read the tail the producer has written when the copy of it does not have enough elements
+  if (available < (uint32) a_count)
+  {
+    a_queue->m_tailcache = InterlockedCompareExchange(&a_queue->m_tail, 0, 0);
+    available = (uint32) a_queue->m_tailcache - head;
+  }
+
+  a_count = (int) min((uint32) a_count, available);
+
+  if (!a_count)
+  {
+    return 0;
+  }
+
+  // copy the elements in at most two pieces, where the ring wraps around
+  slot = head & a_queue->m_mask;
+  first = min((uint32) a_count, a_queue->m_mask + 1 - slot);
+
+  memcpy(a_dst, a_queue->m_data + slot * a_queue->m_elemsize, first * a_queue->m_elemsize);
+  memcpy((char *) a_dst + first * a_queue->m_elemsize, a_queue->m_data, (a_count - first) * a_queue->m_elemsize);
+
+  // give the slots back to the producer, the exchange makes sure the copies are done first
+  InterlockedExchange(&a_queue->m_head, (LONG) (head + a_count));
+
+  return a_count;
+}
+
+
+// allocate a multiple producer multiple consumer queue
+struct mpmcqueue *_mpmcqueue_alloc(int a_elemsize, int a_capacity, struct memorypool *a_pool, const char *a_file, int a_line)
+{
+  // locals
+  struct mpmcqueue *ptr;
+  uint32 capacity, i;
+
+  // checks
+  assert(a_elemsize > 0);
+
+  capacity = __queue_capacity(a_capacity);
+
+  // allocate the queue structure memory
+  ptr = (struct mpmcqueue *) _palloc(a_file, a_line, a_pool, sizeof(struct mpmcqueue));
+  assert(ptr);
+
+  memset(ptr, 0, sizeof(struct mpmcqueue));
+  ptr->m_pool = a_pool;
+  ptr->m_elemsize = a_elemsize;
+  ptr->m_slotsize = QUEUE_SEQUENCE_SIZE + ((a_elemsize + 7) & ~7);
+  ptr->m_mask = capacity - 1;
+
+  ptr->m_data = (char *) _palloc(a_file, a_line, a_pool, psize(capacity, ptr->m_slotsize));
+  assert(ptr->m_data);
+
+  // every slot is empty and can be pushed at its position in the first lap
+  for (i = 0; i < capacity; i++)
+  {
+    *__mpmcqueue_sequence(ptr, i) = (LONG) i;
+  }
+
+  // return a pointer to the queue
+  return ptr;
+}
+
+
+// free a multiple producer multiple consumer queue
+void _mpmcqueue_free(struct mpmcqueue *a_queue)
+{
+  // checks
+  assert(a_queue);
+
+  pfree(a_queue->m_pool, a_queue->m_data);
+  pfree(a_queue->m_pool, a_queue);
+}
+
+
+// add elements to a multiple producer multiple consumer queue
+int _mpmcqueue_push_n(struct mpmcqueue *a_queue, const void *a_src, int a_count)
+{
+  // locals
+  uint32 position, sequence;
+  int i, count;
+
+  // checks
+  assert(a_queue);
+  assert(a_count >= 0);
+  assert(a_src || !a_count);
+
+  if (!a_count)
+  {
+    return 0;
+  }
+
+  position = (uint32) a_queue->m_tail;
+
+  for (;;)
+  {
+    // count the empty slots from the tail, which can only be filled by the thread that claims them
+    for (count = 0; count < a_count; count++)
+    {
+      sequence = (uint32) *__mpmcqueue_sequence(a_queue, position + count);
+
+      if (sequence != position + count)
+      {
+        break;
+      }
+    }
+
+    if (count > 0)
+    {
+      // claim the slots, which fails if another producer claimed the tail first
+      if ((uint32) InterlockedCompareExchange(&a_queue->m_tail, (LONG) (position + count), (LONG) position) == position)
+      {
+        break;
+      }
+    }
+    else if ((int32) (sequence - position) < 0)
+    {
+      // the slot at the tail still holds an element from the last lap, so the queue is full
+      return 0;
+    }
+
+    position = (uint32) a_queue->m_tail;
+  }
+
+  // copy the elements into the claimed slots
+  for (i = 0; i < count; i++)
+  {
+    memcpy((char *) __mpmcqueue_sequence(a_queue, position + i) + QUEUE_SEQUENCE_SIZE, (const char *) a_src + i * a_queue->m_elemsize, a_queue->m_elemsize);
+  }
+
+  // make the copies visible before the sequence numbers say the slots are full
+  MemoryBarrier();
+
+  for (i = 0; i < count; i++)
+  {
+    *__mpmcqueue_sequence(a_queue, position + i) = (LONG) (position + i + 1);
+  }
+
+  return count;
+}
+
+
+// remove elements from a multiple producer multiple consumer queue
+int _mpmcqueue_pop_n(struct mpmcqueue *a_queue, void *a_dst, int a_count)
+{
+  // locals
+  uint32 position, sequence;
+  int i, count;
+
+  // checks
+  assert(a_queue);
+  assert(a_count >= 0);
+  assert(a_dst || !a_count);
+
+  if (!a_count)
+  {
+    return 0;
+  }
+
+  position = (uint32) a_queue->m_head;
+
+  for (;;)
+  {
+    // count the full slots from the head, which can only be emptied by the thread that claims them
+    for (count = 0; count < a_count; count++)
+    {
+      sequence = (uint32) *__mpmcqueue_sequence(a_queue, position + count);
+
+      if (sequence != position + count + 1)
+      {
+        break;
+      }
+    }
+
+    if (count > 0)
+    {
+      // claim the slots, which fails if another consumer claimed the head first
+      if ((uint32) InterlockedCompareExchange(&a_queue->m_head, (LONG) (position + count), (LONG) position) == position)
+      {
+        break;
+      }
+    }
+    else if ((int32) (sequence - (position + 1)) < 0)
+    {
+      // the slot at the head has not been pushed in this lap, so the queue is empty
+      return 0;
+    }
+
+    position = (uint32) a_queue->m_head;
+  }
+
+  // copy the elements out of the claimed slots
+  for (i = 0; i < count; i++)
+  {
+    memcpy((char *) a_dst + i * a_queue->m_elemsize, (char *) __mpmcqueue_sequence(a_queue, position + i) + QUEUE_SEQUENCE_SIZE, a_queue->m_elemsize);
+  }
+
+  // finish the copies before the sequence numbers give the slots to the producers of the next lap
+  MemoryBarrier();
+
+  for (i = 0; i < count; i++)
+  {
+    *__mpmcqueue_sequence(a_queue, position + i) = (LONG) (position + i + a_queue->m_mask + 1);
+  }
+
+  return count;
+}
+
+// -- EOF
+
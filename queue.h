@@ -0,0 +1,116 @@
+
+#ifndef __h_queue
+#define __h_queue
+
+#ifdef  __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "config.h"
+
+// forward declarations
+typedef struct spscqueue;
+typedef struct mpmcqueue;
+typedef struct memorypool;
+
+// bounded queues in a ring of pool memory for passing elements between threads without a lock. the
+// capacity is rounded up to a power of 2 and the queues do not grow, a push fails when a queue is full
+// and a pop fails when it is empty. the positions the producers and the consumers write to are kept on
+// separate cache lines, so the two sides do not take the same cache line from each other on every call.
+
+// allocate a queue for one producer thread and one consumer thread, where every call completes in a
+// bounded number of steps
+// a_elemsize the size of each element
+// a_capacity the number of elements the queue can hold
+// a_pool the memory pool to allocate from
+// returns the newly allocated queue
+#define spscqueue_alloc(a_elemsize, a_capacity, a_pool) _spscqueue_alloc(a_elemsize, a_capacity, a_pool, __FILE__, __LINE__)
+
+// free the queue and all allocated memory, which must only be done once no thread is using it
+// a_queue the queue to operate on
+#define spscqueue_free(a_queue) _spscqueue_free(a_queue)
+
+// add an element to the queue, which must only be called from the producer thread
+// a_queue the queue to operate on
+// a_src the element to copy into the queue
+// returns non-zero if the element was added, or 0 if the queue is full
+#define spscqueue_push(a_queue, a_src) _spscqueue_push_n(a_queue, a_src, 1)
+
+// add as many elements as fit to the queue, which must only be called from the producer thread
+// a_queue the queue to operate on
+// a_src the elements to copy into the queue
+// a_count the number of elements to add
+// returns the number of elements added
+#define spscqueue_push_n(a_queue, a_src, a_count) _spscqueue_push_n(a_queue, a_src, a_count)
+
+// remove an element from the queue, which must only be called from the consumer thread
+// a_queue the queue to operate on
+// a_dst the memory to copy the element to
+// returns non-zero if an element was removed, or 0 if the queue is empty
+#define spscqueue_pop(a_queue, a_dst) _spscqueue_pop_n(a_queue, a_dst, 1)
+
+// remove up to a number of elements from the queue, which must only be called from the consumer thread
+// a_queue the queue to operate on
+// a_dst the memory to copy the elements to
+// a_count the largest number of elements to remove
+// returns the number of elements removed
+#define spscqueue_pop_n(a_queue, a_dst, a_count) _spscqueue_pop_n(a_queue, a_dst, a_count)
+
+// allocate a queue for any number of producer and consumer threads. each slot has a sequence number
+// that says which lap of the ring it is ready for, so threads claim slots with a single compare and
+// swap on the shared position and never wait for a lock.
+// a_elemsize the size of each element
+// a_capacity the number of elements the queue can hold
+// a_pool the memory pool to allocate from
+// returns the newly allocated queue
+#define mpmcqueue_alloc(a_elemsize, a_capacity, a_pool) _mpmcqueue_alloc(a_elemsize, a_capacity, a_pool, __FILE__, __LINE__)
+
+// free the queue and all allocated memory, which must only be done once no thread is using it
+// a_queue the queue to operate on
+#define mpmcqueue_free(a_queue) _mpmcqueue_free(a_queue)
+
+// add an element to the queue
+// a_queue the queue to operate on
+// a_src the element to copy into the queue
+// returns non-zero if the element was added, or 0 if the queue is full
+#define mpmcqueue_push(a_queue, a_src) _mpmcqueue_push_n(a_queue, a_src, 1)
+
+// add up to a number of elements to the queue, which are claimed with one compare and swap and stay
+// together in the queue
+// a_queue the queue to operate on
+// a_src the elements to copy into the queue
+// a_count the number of elements to add
+// returns the number of elements added
+#define mpmcqueue_push_n(a_queue, a_src, a_count) _mpmcqueue_push_n(a_queue, a_src, a_count)
+
+// remove an element from the queue
+// a_queue the queue to operate on
+// a_dst the memory to copy the element to
+// returns non-zero if an element was removed, or 0 if the queue is empty
+#define mpmcqueue_pop(a_queue, a_dst) _mpmcqueue_pop_n(a_queue, a_dst, 1)
+
+// remove up to a number of elements from the queue, which are claimed with one compare and swap
+// a_queue the queue to operate on
+// a_dst the memory to copy the elements to
+// a_count the largest number of elements to remove
+// returns the number of elements removed
+#define mpmcqueue_pop_n(a_queue, a_dst, a_count) _mpmcqueue_pop_n(a_queue, a_dst, a_count)
+
+// interface functions
+struct spscqueue *_spscqueue_alloc(int a_elemsize, int a_capacity, struct memorypool *a_pool, const char *a_file, int a_line);
+void _spscqueue_free(struct spscqueue *a_queue);
+int _spscqueue_push_n(struct spscqueue *a_queue, const void *a_src, int a_count);
+int _spscqueue_pop_n(struct spscqueue *a_queue, void *a_dst, int a_count);
+struct mpmcqueue *_mpmcqueue_alloc(int a_elemsize, int a_capacity, struct memorypool *a_pool, const char *a_file, int a_line);
+void _mpmcqueue_free(struct mpmcqueue *a_queue);
+int _mpmcqueue_push_n(struct mpmcqueue *a_queue, const void *a_src, int a_count);
+int _mpmcqueue_pop_n(struct mpmcqueue *a_queue, void *a_dst, int a_count);
+
+#ifdef  __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __h_queue
+
+// -- EOF
+
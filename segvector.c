@@ -0,0 +1,174 @@
+
+#include "segvector.h"
+
+#include <assert.h>
+#include <memory.h>
+#include <stdlib.h>
+
+#include "arrayview.h"
+#include "memorypool.h"
+
+// the number of segments the table has space for when the first segment is allocated
+#define SEGVECTOR_MIN_TABLE 16
+
+
+// allocate a new segmented vector
+struct segvector *_segvector_alloc(int a_elemsize, struct memorypool *a_pool, const char *a_file, int a_line)
+{
+  // locals
+  struct segvector *ptr;
+
+  // checks
+  assert(a_elemsize > 0);
+
+  // allocate the segmented vector structure memory
+  ptr = (struct segvector *) _palloc(a_file, a_line, a_pool, sizeof(struct segvector));
+  assert(ptr);
+
+  memset(ptr, 0, sizeof(struct segvector));
+  ptr->m_elemsize = a_elemsize;
+  ptr->m_pool = a_pool;
+
+  // fit as many elements in a segment as possible, as a power of two
+  for (ptr->m_shift = 0; (a_elemsize << (ptr->m_shift + 1)) <= SEGVECTOR_SEGMENT_SIZE; ptr->m_shift++)
+  {
+  }
+
+  // return a pointer to the segmented vector
+  return ptr;
+}
+
+
+// free a segmented vector
+void _segvector_free(struct segvector *a_vector)
+{
+  // locals
+  int i;
+
+  // checks
+  assert(a_vector);
+
+  for (i = 0; i < a_vector->m_segmentcount; i++)
+  {
+    pfree(a_vector->m_pool, a_vector->m_segments[i]);
+  }
+
+  if (a_vector->m_segments)
+  {
+    pfree(a_vector->m_pool, a_vector->m_segments);
+  }
+
+  pfree(a_vector->m_pool, a_vector);
+}
+
+
+// set the number of elements
+void _segvector_resize(struct segvector *a_vector, int a_count, const char *a_file, int a_line)
+{
+  // locals
+  int segments, tablesize;
+
+  // checks
+  assert(a_vector);
+  assert(a_count >= 0);
+
+  segments = (int) (((int64) a_count + (1 << a_vector->m_shift) - 1) >> a_vector->m_shift);
+
+  if (segments > a_vector->m_segmentcount)
+  {
+    // grow the table of segments, which is the only memory that moves
+    if (segments > a_vector->m_tablesize)
+    {
+      for (tablesize = max(a_vector->m_tablesize, SEGVECTOR_MIN_TABLE); tablesize < segments; tablesize <<= 1)
+      {
+      }
+
+      a_vector->m_segments = (char **) _prealloc(a_file, a_line, a_vector->m_pool, a_vector->m_segments, sizeof(char *) * tablesize);
+      assert(a_vector->m_segments);
+
+      a_vector->m_tablesize = tablesize;
+    }
+
+    // allocate the new segments
+    while (a_vector->m_segmentcount < segments)
+    {
+      a_vector->m_segments[a_vector->m_segmentcount] = (char *) _palloc(a_file, a_line, a_vector->m_pool, a_vector->m_elemsize << a_vector->m_shift);
+      assert(a_vector->m_segments[a_vector->m_segmentcount]);
+
+      a_vector->m_segmentcount++;
+    }
+  }
+
+  a_vector->m_count = a_count;
+}
+
+
+// add an element to the end
+void *_segvector_push(struct segvector *a_vector, const char *a_file, int a_line)
+{
+  // checks
+  assert(a_vector);
+
+  // a new segment is only needed when the last one is full
+  if (a_vector->m_count < (a_vector->m_segmentcount << a_vector->m_shift))
+  {
+    a_vector->m_count++;
+  }
+  else
+  {
+    _segvector_resize(a_vector, a_vector->m_count + 1, a_file, a_line);
+  }
+
+  return _segvector_index(a_vector, a_vector->m_count - 1);
+}
+
+
+// add copies of elements to the end
+void _segvector_push_n(struct segvector *a_vector, const void *a_src, int a_count, const char *a_file, int a_line)
+{
+  // locals
+  const char *src;
+  int index, count, segmentcount;
+
+  // checks
+  assert(a_vector);
+  assert(a_count >= 0);
+  assert(a_src || !a_count);
+
+  index = a_vector->m_count;
+  _segvector_resize(a_vector, index + a_count, a_file, a_line);
+
+  // copy the elements a segment at a time
+  src = (const char *) a_src;
+  segmentcount = 1 << a_vector->m_shift;
+
+  while (a_count > 0)
+  {
+    count = min(a_count, segmentcount - (index & (segmentcount - 1)));
+
+    memcpy(_segvector_index(a_vector, index), src, a_vector->m_elemsize * count);
+
+    src += a_vector->m_elemsize * count;
+    index += count;
+    a_count -= count;
+  }
+}
+
+
+// make a view of the elements in a segment
+void _segvector_segment(struct segvector *a_vector, int a_segment, struct array_view *a_view)
+{
+  // locals
+  int start;
+
+  // checks
+  assert(a_vector);
+  assert(a_view);
+  assert(a_segment >= 0 && a_segment < segvector_segments(a_vector));
+
+  start = a_segment << a_vector->m_shift;
+  array_view_memory(a_view, a_vector->m_segments[a_segment], a_vector->m_elemsize, min(a_vector->m_count - start, 1 << a_vector->m_shift));
+}
+
+// -- EOF
+
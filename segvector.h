@@ -0,0 +1,105 @@
+
+#ifndef __h_segvector
+#define __h_segvector
+
+#ifdef  __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "config.h"
+
+#include <assert.h>
+
+// forward declarations
+typedef struct array_view;
+typedef struct memorypool;
+
+// the largest size of a segment in bytes, which holds a power of two number of elements
+#define SEGVECTOR_SEGMENT_SIZE 16384
+
+// structure for the segmented vector, which is public so lookups can be inlined. the elements are stored
+// in fixed size segments that are allocated as the vector grows and are never moved, so pointers to the
+// elements stay valid until the vector is freed or shrunk past them. only the table of segment pointers
+// is reallocated when it is full.
+struct segvector
+{
+  char **m_segments;          // the table of segments
+  int m_elemsize;             // the size of each element
+  int m_count;                // the number of elements in the vector
+  int m_shift;                // the number of index bits for the element in a segment
+  int m_segmentcount;         // the number of segments that have been allocated
+  int m_tablesize;            // the number of segments the table has space for
+  struct memorypool *m_pool;  // the memory allocator
+};
+
+// allocate a new segmented vector
+// a_elemsize the size of each element
+// a_pool the memory pool to allocate from
+// returns the newly allocated segmented vector
+#define segvector_alloc(a_elemsize, a_pool) _segvector_alloc(a_elemsize, a_pool, __FILE__, __LINE__)
+
+// free the segmented vector and all allocated memory
+// a_vector the segmented vector to operate on
+#define segvector_free(a_vector) _segvector_free(a_vector)
+
+// set the number of elements, allocating segments when it grows. the segments are kept when it shrinks.
+// a_vector the segmented vector to operate on
+// a_count the number of elements
+#define segvector_resize(a_vector, a_count) _segvector_resize(a_vector, a_count, __FILE__, __LINE__)
+
+// add an element to the end of the segmented vector
+// a_vector the segmented vector to operate on
+// returns a pointer to the new element, which stays valid as more elements are added
+#define segvector_push(a_vector) _segvector_push(a_vector, __FILE__, __LINE__)
+
+// add copies of elements to the end of the segmented vector
+// a_vector the segmented vector to operate on
+// a_src the elements to copy
+// a_count the number of elements to copy
+#define segvector_push_n(a_vector, a_src, a_count) _segvector_push_n(a_vector, a_src, a_count, __FILE__, __LINE__)
+
+// get the number of elements in the segmented vector
+// a_vector the segmented vector to operate on
+// returns the number of elements
+#define segvector_count(a_vector) ((a_vector)->m_count)
+
+// get a pointer to an element
+// a_vector the segmented vector to operate on
+// a_index the index of the element
+// returns a pointer to the element
+#define segvector_index(a_vector, a_index) _segvector_index(a_vector, a_index)
+
+// get the number of segments that hold elements, for iterating over the elements a segment at a time
+// a_vector the segmented vector to operate on
+// returns the number of segments
+#define segvector_segments(a_vector) (((a_vector)->m_count + (1 << (a_vector)->m_shift) - 1) >> (a_vector)->m_shift)
+
+// make a view of the elements in a segment, which are contiguous
+// a_vector the segmented vector to operate on
+// a_segment the index of the segment
+// a_view the view to set
+#define segvector_segment(a_vector, a_segment, a_view) _segvector_segment(a_vector, a_segment, a_view)
+
+// interface functions
+struct segvector *_segvector_alloc(int a_elemsize, struct memorypool *a_pool, const char *a_file, int a_line);
+void _segvector_free(struct segvector *a_vector);
+void _segvector_resize(struct segvector *a_vector, int a_count, const char *a_file, int a_line);
+void *_segvector_push(struct segvector *a_vector, const char *a_file, int a_line);
+void _segvector_push_n(struct segvector *a_vector, const void *a_src, int a_count, const char *a_file, int a_line);
+void _segvector_segment(struct segvector *a_vector, int a_segment, struct array_view *a_view);
+
+// inline functions
+static inline void *_segvector_index(struct segvector *a_vector, int a_index)
+{
+  assert(a_index >= 0 && a_index < a_vector->m_count);
+  return a_vector->m_segments[a_index >> a_vector->m_shift] + (a_index & ((1 << a_vector->m_shift) - 1)) * a_vector->m_elemsize;
+}
+
+#ifdef  __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __h_segvector
+
+// -- EOF
+
@@ -0,0 +1,210 @@
+
+#include "soatable.h"
+
+#include <assert.h>
+#include <memory.h>
+#include <stdlib.h>
+
+#include "array.h"
+#include "arrayview.h"
+#include "memorypool.h"
+
+// the number of rows reserved when rows are first added to a table
+#define SOA_TABLE_MIN_CAPACITY 16
+
+// structure for the table
+struct soa_table
+{
+  struct memorypool *m_pool;  // the memory allocator
+  int m_columns;              // the number of columns
+  int m_count;                // the number of rows in the table
+  int m_capacity;             // the number of rows the columns have space for
+  struct array **m_column;    // the column arrays, which hold m_capacity elements each
+};
+
+
+// allocate a new table
+struct soa_table *_soa_table_alloc(int a_columns, const int *a_elemsizes, struct memorypool *a_pool, const char *a_file, int a_line)
+{
+  // locals
+  struct soa_table *ptr;
+  int i;
+
+  // checks
+  assert(a_columns > 0);
+  assert(a_elemsizes);
+
+  // allocate the table structure memory
+  ptr = (struct soa_table *) _palloc(a_file, a_line, a_pool, sizeof(struct soa_table));
+  assert(ptr);
+
+  ptr->m_pool = a_pool;
+  ptr->m_columns = a_columns;
+  ptr->m_count = 0;
+  ptr->m_capacity = 0;
+
+  // allocate an empty array for each column
+  ptr->m_column = (struct array **) _palloc(a_file, a_line, a_pool, sizeof(struct array *) * a_columns);
+  assert(ptr->m_column);
+
+  for (i = 0; i < a_columns; i++)
+  {
+    ptr->m_column[i] = _array_alloc(a_elemsizes[i], 0, a_pool, a_file, a_line);
+  }
+
+  // return a pointer to the table
+  return ptr;
+}
+
+
+// free a table
+void _soa_table_free(struct soa_table *a_table)
+{
+  // locals
+  int i;
+
+  // checks
+  assert(a_table);
+
+  for (i = 0; i < a_table->m_columns; i++)
+  {
+    array_free(a_table->m_column[i]);
+  }
+
+  pfree(a_table->m_pool, a_table->m_column);
+  pfree(a_table->m_pool, a_table);
+}
+
+
+// reserve space in all columns
+void _soa_table_reserve(struct soa_table *a_table, int a_capacity, const char *a_file, int a_line)
+{
+  // locals
+  int i;
+
+  // checks
+  assert(a_table);
+
+  if (a_capacity <= a_table->m_capacity)
+  {
+    return;
+  }
+
+  for (i = 0; i < a_table->m_columns; i++)
+  {
+    _array_resize(a_table->m_column[i], a_capacity, a_file, a_line);
+  }
+
+  a_table->m_capacity = a_capacity;
+}
+
+
+// add rows to the end of the table
+int _soa_table_append(struct soa_table *a_table, int a_count, const char *a_file, int a_line)
+{
+  // locals
+  int start, i;
+
+  // checks
+  assert(a_table);
+  assert(a_count > 0);
+
+  start = a_table->m_count;
+
+  // grow the columns by at least double, so appending one row at a time is not quadratic
+  if (start + a_count > a_table->m_capacity)
+  {
+    _soa_table_reserve(a_table, max(start + a_count, max(a_table->m_capacity * 2, SOA_TABLE_MIN_CAPACITY)), a_file, a_line);
+  }
+
+  for (i = 0; i < a_table->m_columns; i++)
+  {
+    memset(array_index(a_table->m_column[i], start), 0, array_elemsize(a_table->m_column[i]) * a_count);
+  }
+
+  a_table->m_count += a_count;
+  return start;
+}
+
+
+// remove rows from the table
+void _soa_table_remove(struct soa_table *a_table, int a_start, int a_count)
+{
+  // locals
+  char *data;
+  size_t elemsize;
+  int i;
+
+  // checks
+  assert(a_table);
+  assert(a_start >= 0 && a_count >= 0 && a_start + a_count <= a_table->m_count);
+
+  // move the rows after the removed rows down in each column
+  for (i = 0; i < a_table->m_columns; i++)
+  {
+    data = (char *) array_data(a_table->m_column[i]);
+    elemsize = array_elemsize(a_table->m_column[i]);
+
+    memmove(data + a_start * elemsize, data + (a_start + a_count) * elemsize, (a_table->m_count - a_start - a_count) * elemsize);
+  }
+
+  a_table->m_count -= a_count;
+}
+
+
+// get the number of rows in the table
+int _soa_table_count(struct soa_table *a_table)
+{
+  // checks
+  assert(a_table);
+
+  return a_table->m_count;
+}
+
+
+// get the number of columns in the table
+int _soa_table_columns(struct soa_table *a_table)
+{
+  // checks
+  assert(a_table);
+
+  return a_table->m_columns;
+}
+
+
+// get a pointer to the data for a column
+void *_soa_table_column(struct soa_table *a_table, int a_column)
+{
+  // checks
+  assert(a_table);
+  assert(a_column >= 0 && a_column < a_table->m_columns);
+
+  return array_data(a_table->m_column[a_column]);
+}
+
+
+// make a view of all rows in a column
+void _soa_table_view(struct soa_table *a_table, int a_column, struct array_view *a_view)
+{
+  // checks
+  assert(a_table);
+  assert(a_column >= 0 && a_column < a_table->m_columns);
+
+  array_view_array(a_view, a_table->m_column[a_column], 0, a_table->m_count);
+}
+
+
+// get a pointer to the element for a row in a column
+void *_soa_table_index(struct soa_table *a_table, int a_row, int a_column)
+{
+  // checks
+  assert(a_table);
+  assert(a_row >= 0 && a_row < a_table->m_count);
+  assert(a_column >= 0 && a_column < a_table->m_columns);
+
+  return array_index(a_table->m_column[a_column], a_row);
+}
+
+
+// -- EOF
+
@@ -0,0 +1,96 @@
+
+#ifndef __h_soatable
+#define __h_soatable
+
+#ifdef  __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "config.h"
+
+// forward declarations
+typedef struct soa_table;
+typedef struct array_view;
+typedef struct memorypool;
+
+// a table of rows that stores each field in its own column array, so a scan of one field only reads
+// that field. all columns have the same number of rows, and rows are added and removed from all columns
+// at once. pointers to the column data are no longer valid once rows are added.
+
+// allocate a new table
+// a_columns the number of columns
+// a_elemsizes the size of the element in each column
+// a_pool the memory pool to allocate from
+// returns the newly allocated table
+#define soa_table_alloc(a_columns, a_elemsizes, a_pool) _soa_table_alloc(a_columns, a_elemsizes, a_pool, __FILE__, __LINE__)
+
+// free the table and all allocated memory
+// a_table the table to operate on
+#define soa_table_free(a_table) _soa_table_free(a_table)
+
+// reserve space in all columns so rows can be added without reallocating
+// a_table the table to operate on
+// a_capacity the number of rows to reserve space for
+#define soa_table_reserve(a_table, a_capacity) _soa_table_reserve(a_table, a_capacity, __FILE__, __LINE__)
+
+// add rows to the end of the table, the new rows are zeroed
+// a_table the table to operate on
+// a_count the number of rows to add
+// returns the index of the first new row
+#define soa_table_append(a_table, a_count) _soa_table_append(a_table, a_count, __FILE__, __LINE__)
+
+// remove rows from the table, keeping the order of the rows after them
+// a_table the table to operate on
+// a_start the index of the first row to remove
+// a_count the number of rows to remove
+#define soa_table_remove(a_table, a_start, a_count) _soa_table_remove(a_table, a_start, a_count)
+
+// get the number of rows in the table
+// a_table the table to operate on
+// returns the number of rows
+#define soa_table_count(a_table) _soa_table_count(a_table)
+
+// get the number of columns in the table
+// a_table the table to operate on
+// returns the number of columns
+#define soa_table_columns(a_table) _soa_table_columns(a_table)
+
+// get a pointer to the data for a column
+// a_table the table to operate on
+// a_column the index of the column
+// returns a pointer to the element in the first row
+#define soa_table_column(a_table, a_column) _soa_table_column(a_table, a_column)
+
+// make a view of all rows in a column, which can be scanned with the array view operations
+// a_table the table to operate on
+// a_column the index of the column
+// a_view the view to set
+#define soa_table_view(a_table, a_column, a_view) _soa_table_view(a_table, a_column, a_view)
+
+// get a pointer to the element for a row in a column
+// a_table the table to operate on
+// a_row the index of the row
+// a_column the index of the column
+// returns a pointer to the element
+#define soa_table_index(a_table, a_row, a_column) _soa_table_index(a_table, a_row, a_column)
+
+// interface functions
+struct soa_table *_soa_table_alloc(int a_columns, const int *a_elemsizes, struct memorypool *a_pool, const char *a_file, int a_line);
+void _soa_table_free(struct soa_table *a_table);
+void _soa_table_reserve(struct soa_table *a_table, int a_capacity, const char *a_file, int a_line);
+int _soa_table_append(struct soa_table *a_table, int a_count, const char *a_file, int a_line);
+void _soa_table_remove(struct soa_table *a_table, int a_start, int a_count);
+int _soa_table_count(struct soa_table *a_table);
+int _soa_table_columns(struct soa_table *a_table);
+void *_soa_table_column(struct soa_table *a_table, int a_column);
+void _soa_table_view(struct soa_table *a_table, int a_column, struct array_view *a_view);
+void *_soa_table_index(struct soa_table *a_table, int a_row, int a_column);
+
+#ifdef  __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __h_soatable
+
+// -- EOF
+
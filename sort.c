@@ -0,0 +1,510 @@
+
+#include "sort.h"
+
+#include <assert.h>
+#include <memory.h>
+#include <stdlib.h>
+
+#include "array.h"
+#include "memorypool.h"
+#include "threadpool.h"
+#include "vector.h"
+
+// the length of the runs that are sorted with an insertion sort before they are merged
+#define SORT_RUN            16
+
+// the fewest elements to split across threads, below this the sort runs on the calling thread
+#define SORT_PARALLEL_MIN   65536
+
+// the number of jobs to give each thread in a merge round, so threads that finish early can help out
+#define SORT_PARTS          4
+
+// the state of a parallel merge sort
+struct mergesort
+{
+  char *m_data;                 // the data to sort
+  char *m_temp;                 // a buffer the size of the data
+  size_t m_count;               // the number of elements
+  size_t m_elemsize;            // the size of each element
+  sort_compare_func m_compare;  // the compare function
+  int m_chunks;                 // the number of chunks the data is split into
+  int m_width;                  // the number of chunks in each run for the current merge round
+  int m_parts;                  // the number of jobs each pair of runs is merged with
+  char *m_src;                  // the runs to merge in the current round
+  char *m_dst;                  // where the merged runs are written in the current round
+};
+
+// the state of a parallel radix sort
+struct radixsort
+{
+  char *m_src;                  // the elements to scatter in the current pass
+  char *m_dst;                  // where the elements are scattered to in the current pass
+  size_t m_count;               // the number of elements
+  size_t m_elemsize;            // the size of each element
+  int m_key;                    // the type of the key
+  int m_offset;                 // the offset of the key in each element
+  int m_shift;                  // the shift of the digit for the current pass
+  int m_blocks;                 // the number of blocks the elements are split into
+  size_t *m_counts;             // 256 digit counts (then offsets) for each block
+};
+
+
+void __merge_sort(char *a_data, size_t a_count, size_t a_elemsize, sort_compare_func a_compare);
+void __merge_sort_chunk(void *a_context, int a_index);
+void __merge_sort_round(void *a_context, int a_index);
+void __merge(const char *a_left, size_t a_nleft, const char *a_right, size_t a_nright, char *a_dst, size_t a_start, size_t a_count, size_t a_elemsize, sort_compare_func a_compare);
+size_t __merge_split(const char *a_left, size_t a_nleft, const char *a_right, size_t a_nright, size_t a_index, size_t a_elemsize, sort_compare_func a_compare);
+void __insertion_sort(char *a_data, size_t a_count, size_t a_elemsize, sort_compare_func a_compare);
+void __radix_sort(char *a_data, size_t a_count, size_t a_elemsize, int a_key, int a_offset);
+void __radix_count(void *a_context, int a_index);
+void __radix_scatter(void *a_context, int a_index);
+uint64 __radix_key(const char *a_elem, int a_key);
+size_t __split_start(size_t a_count, int a_parts, int a_part);
+void __swap(char *a_left, char *a_right, size_t a_elemsize);
+
+
+// sort an array with a merge sort
+void _array_sort(struct array *a_array, sort_compare_func a_compare)
+{
+  // checks
+  assert(a_array);
+  assert(a_compare);
+
+  __merge_sort((char *) array_data(a_array), array_count(a_array), array_elemsize(a_array), a_compare);
+}
+
+
+// sort a vector with a merge sort
+void _vector_sort(struct vector *a_vector, sort_compare_func a_compare)
+{
+  // checks
+  assert(a_vector);
+  assert(a_compare);
+
+  __merge_sort((char *) vector_data(a_vector), vector_count(a_vector), vector_elemsize(a_vector), a_compare);
+}
+
+
+// sort an array with a radix sort
+void _array_radix_sort(struct array *a_array, int a_key, int a_offset)
+{
+  // checks
+  assert(a_array);
+
+  __radix_sort((char *) array_data(a_array), array_count(a_array), array_elemsize(a_array), a_key, a_offset);
+}
+
+
+// sort a vector with a radix sort
+void _vector_radix_sort(struct vector *a_vector, int a_key, int a_offset)
+{
+  // checks
+  assert(a_vector);
+
+  __radix_sort((char *) vector_data(a_vector), vector_count(a_vector), vector_elemsize(a_vector), a_key, a_offset);
+}
+
+
+// sort elements with a merge sort. the data is split into a chunk for each thread, which are sorted
+// in parallel and then merged in rounds. each merge is split into parts at the points where the
+// output would be divided evenly, so every thread has work in the last rounds too.
+void __merge_sort(char *a_data, size_t a_count, size_t a_elemsize, sort_compare_func a_compare)
+{
+  // locals
+  struct mergesort sort;
+  char *swap;
+  int pairs;
+
+  // checks
+  assert(a_data || a_count == 0);
+  assert(a_elemsize > 0);
+
+  if (a_count < 2)
+  {
+    return;
+  }
+
+  sort.m_data = a_data;
+  sort.m_temp = (char *) gpalloc(psize(a_count, a_elemsize));
+  sort.m_count = a_count;
+  sort.m_elemsize = a_elemsize;
+  sort.m_compare = a_compare;
+  sort.m_chunks = (a_count < SORT_PARALLEL_MIN) ? 1 : threadpool_threads(0);
+  assert(sort.m_temp);
+
+  // sort each chunk, the sorted chunks are left in the data
+  threadpool_run(0, __merge_sort_chunk, &sort, sort.m_chunks);
+
+  // merge pairs of runs of chunks until there is one run
+  sort.m_src = a_data;
+  sort.m_dst = sort.m_temp;
+
+  for (sort.m_width = 1; sort.m_width < sort.m_chunks; sort.m_width *= 2)
+  {
+    pairs = (sort.m_chunks + sort.m_width * 2 - 1) / (sort.m_width * 2);
+    sort.m_parts = max(1, (sort.m_chunks * SORT_PARTS) / pairs);
+
+    threadpool_run(0, __merge_sort_round, &sort, pairs * sort.m_parts);
+
+    swap = sort.m_src;
+    sort.m_src = sort.m_dst;
+    sort.m_dst = swap;
+  }
+
+  if (sort.m_src != a_data)
+  {
+    memcpy(a_data, sort.m_src, a_count * a_elemsize);
+  }
+
+  gpfree(sort.m_temp);
+}
+
+
+// sort one chunk of the data, with insertion sorted runs that are merged between the data and the buffer
+void __merge_sort_chunk(void *a_context, int a_index)
+{
+  // locals
+  struct mergesort *sort;
+  char *src, *dst, *swap;
+  size_t start, count, width, i, left, right;
+
+  sort = (struct mergesort *) a_context;
+  start = __split_start(sort->m_count, sort->m_chunks, a_index);
+  count = __split_start(sort->m_count, sort->m_chunks, a_index + 1) - start;
+
+  src = sort->m_data + start * sort->m_elemsize;
+  dst = sort->m_temp + start * sort->m_elemsize;
+
+  for (i = 0; i < count; i += SORT_RUN)
+  {
+    __insertion_sort(src + i * sort->m_elemsize, min(SORT_RUN, count - i), sort->m_elemsize, sort->m_compare);
+  }
+
+  for (width = SORT_RUN; width < count; width *= 2)
+  {
+    for (i = 0; i < count; i += width * 2)
+    {
+      left = min(width, count - i);
+      right = min(width, count - i - left);
+      __merge(src + i * sort->m_elemsize, left, src + (i + left) * sort->m_elemsize, right, dst + i * sort->m_elemsize, 0, left + right, sort->m_elemsize, sort->m_compare);
+    }
+
+    swap = src;
+    src = dst;
+    dst = swap;
+  }
+
+  if (src != sort->m_data + start * sort->m_elemsize)
+  {
+    memcpy(sort->m_data + start * sort->m_elemsize, src, count * sort->m_elemsize);
+  }
+}
+
+
+// merge one part of a pair of runs in a merge round
+void __merge_sort_round(void *a_context, int a_index)
+{
+  // locals
+  struct mergesort *sort;
+  int pair, part;
+  size_t start, middle, end, first, last;
+
+  sort = (struct mergesort *) a_context;
+  pair = a_index / sort->m_parts;
+  part = a_index % sort->m_parts;
+
+  // the element range of the two runs, the last run may not have a pair
+  start = __split_start(sort->m_count, sort->m_chunks, pair * sort->m_width * 2);
+  middle = __split_start(sort->m_count, sort->m_chunks, min(pair * sort->m_width * 2 + sort->m_width, sort->m_chunks));
+  end = __split_start(sort->m_count, sort->m_chunks, min(pair * sort->m_width * 2 + sort->m_width * 2, sort->m_chunks));
+
+  // the part of the merged output this job writes
+  first = __split_start(end - start, sort->m_parts, part);
+  last = __split_start(end - start, sort->m_parts, part + 1);
+
+  __merge(sort->m_src + start * sort->m_elemsize, middle - start, sort->m_src + middle * sort->m_elemsize, end - middle,
+    sort->m_dst + (start + first) * sort->m_elemsize, first, last - first, sort->m_elemsize, sort->m_compare);
+}
+
+
+// merge two sorted runs, writing a range of the merged output. elements from the left run come first
+// when they compare equal, which keeps the sort stable.
+// a_dst where to write the range of the output
+// a_start the index in the merged output of the first element to write
+// a_count the number of elements to write
+void __merge(const char *a_left, size_t a_nleft, const char *a_right, size_t a_nright, char *a_dst, size_t a_start, size_t a_count, size_t a_elemsize, sort_compare_func a_compare)
+{
+  // locals
+  size_t i, j;
+
+  i = __merge_split(a_left, a_nleft, a_right, a_nright, a_start, a_elemsize, a_compare);
+  j = a_start - i;
+
+  for (; a_count > 0 && i < a_nleft && j < a_nright; a_count--, a_dst += a_elemsize)
+  {
+    if (a_compare(a_right + j * a_elemsize, a_left + i * a_elemsize) < 0)
+    {
+      memcpy(a_dst, a_right + j++ * a_elemsize, a_elemsize);
+    }
+    else
+    {
+      memcpy(a_dst, a_left + i++ * a_elemsize, a_elemsize);
+    }
+  }
+
+  // copy what is left of the range from whichever run has elements left
+  if (a_count > 0 && i < a_nleft)
+  {
+    memcpy(a_dst, a_left + i * a_elemsize, a_count * a_elemsize);
+  }
+  else if (a_count > 0)
+  {
+    memcpy(a_dst, a_right + j * a_elemsize, a_count * a_elemsize);
+  }
+}
+
+
+// find how many elements of the left run are in the first a_index elements of the merged output
+size_t __merge_split(const char *a_left, size_t a_nleft, const char *a_right, size_t a_nright, size_t a_index, size_t a_elemsize, sort_compare_func a_compare)
+{
+  // locals
+  size_t low, high, i, j;
+
+  low = (a_index > a_nright) ? a_index - a_nright : 0;
+  high = min(a_index, a_nleft);
+
+  // find the fewest left elements where the last right element taken comes before the next left element
+  while (low < high)
+  {
+    i = (low + high) / 2;
+    j = a_index - i;
+
+    if (a_compare(a_right + (j - 1) * a_elemsize, a_left + i * a_elemsize) >= 0)
+    {
+      low = i + 1;
+    }
+    else
+    {
+      high = i;
+    }
+  }
+
+  return low;
+}
+
+
+// sort a short run of elements
+void __insertion_sort(char *a_data, size_t a_count, size_t a_elemsize, sort_compare_func a_compare)
+{
+  // locals
+  char *elem;
+  size_t i;
+
+  for (i = 1; i < a_count; i++)
+  {
+    for (elem = a_data + i * a_elemsize; elem > a_data && a_compare(elem - a_elemsize, elem) > 0; elem -= a_elemsize)
+    {
+      __swap(elem - a_elemsize, elem, a_elemsize);
+    }
+  }
+}
+
+
+// sort elements by a key with a least significant digit radix sort, one byte at a time. the elements
+// are split into a block for each thread. each pass counts the digits in each block, so the blocks
+// can be scattered in parallel to their own ranges of the output. passes where every key has the same
+// digit are skipped.
+void __radix_sort(char *a_data, size_t a_count, size_t a_elemsize, int a_key, int a_offset)
+{
+  // locals
+  struct radixsort sort;
+  char *temp, *swap;
+  int keysize, digit, block;
+  size_t total, count;
+
+  // checks
+  assert(a_data || a_count == 0);
+  assert(a_key >= SORT_KEY_I32 && a_key <= SORT_KEY_F64);
+
+  keysize = (a_key == SORT_KEY_I32 || a_key == SORT_KEY_U32 || a_key == SORT_KEY_F32) ? 4 : 8;
+  assert(a_offset >= 0 && (size_t) (a_offset + keysize) <= a_elemsize);
+
+  if (a_count < 2)
+  {
+    return;
+  }
+
+  temp = (char *) gpalloc(psize(a_count, a_elemsize));
+  assert(temp);
+
+  sort.m_src = a_data;
+  sort.m_dst = temp;
+  sort.m_count = a_count;
+  sort.m_elemsize = a_elemsize;
+  sort.m_key = a_key;
+  sort.m_offset = a_offset;
+  sort.m_blocks = (a_count < SORT_PARALLEL_MIN) ? 1 : threadpool_threads(0);
+  sort.m_counts = (size_t *) gpalloc(psize(sort.m_blocks * 256, sizeof(size_t)));
+  assert(sort.m_counts);
+
+  for (sort.m_shift = 0; sort.m_shift < keysize * 8; sort.m_shift += 8)
+  {
+    threadpool_run(0, __radix_count, &sort, sort.m_blocks);
+
+    // turn the counts into the offset each block starts writing each digit at
+    for (digit = 0, total = 0; digit < 256; digit++)
+    {
+      for (block = 0; block < sort.m_blocks; block++)
+      {
+        count = sort.m_counts[block * 256 + digit];
+        sort.m_counts[block * 256 + digit] = total;
+        total += count;
+      }
+
+      // the pass is skipped if every key has this digit
+      if (total == a_count && sort.m_counts[digit] == 0)
+      {
+        break;
+      }
+    }
+
+    if (digit < 256)
+    {
+      continue;
+    }
+
+    threadpool_run(0, __radix_scatter, &sort, sort.m_blocks);
+
+    swap = sort.m_src;
+    sort.m_src = sort.m_dst;
+    sort.m_dst = swap;
+  }
+
+  if (sort.m_src != a_data)
+  {
+    memcpy(a_data, sort.m_src, a_count * a_elemsize);
+  }
+
+  gpfree(sort.m_counts);
+  gpfree(temp);
+}
+
+
+// count the digits in a block for the current pass
+void __radix_count(void *a_context, int a_index)
+{
+  // locals
+  struct radixsort *sort;
+  const char *elem, *end;
+  size_t *counts;
+
+  sort = (struct radixsort *) a_context;
+  counts = sort->m_counts + a_index * 256;
+  memset(counts, 0, 256 * sizeof(size_t));
+
+  elem = sort->m_src + __split_start(sort->m_count, sort->m_blocks, a_index) * sort->m_elemsize + sort->m_offset;
+  end = sort->m_src + __split_start(sort->m_count, sort->m_blocks, a_index + 1) * sort->m_elemsize + sort->m_offset;
+
+  for (; elem < end; elem += sort->m_elemsize)
+  {
+    counts[(__radix_key(elem, sort->m_key) >> sort->m_shift) & 0xff]++;
+  }
+}
+
+
+// scatter a block to the offsets of its digits for the current pass
+void __radix_scatter(void *a_context, int a_index)
+{
+  // locals
+  struct radixsort *sort;
+  const char *elem, *end;
+  size_t *offsets;
+  size_t size;
+  int digit;
+
+  sort = (struct radixsort *) a_context;
+  offsets = sort->m_counts + a_index * 256;
+  size = sort->m_elemsize;
+
+  elem = sort->m_src + __split_start(sort->m_count, sort->m_blocks, a_index) * size;
+  end = sort->m_src + __split_start(sort->m_count, sort->m_blocks, a_index + 1) * size;
+
+  for (; elem < end; elem += size)
+  {
+    digit = (int) (__radix_key(elem + sort->m_offset, sort->m_key) >> sort->m_shift) & 0xff;
+
+    // the common element sizes are copied without a call
+    if (size == 4)
+    {
+      ((uint32 *) sort->m_dst)[offsets[digit]++] = *(const uint32 *) elem;
+    }
+    else if (size == 8)
+    {
+      ((uint64 *) sort->m_dst)[offsets[digit]++] = *(const uint64 *) elem;
+    }
+    else
+    {
+      memcpy(sort->m_dst + offsets[digit]++ * size, elem, size);
+    }
+  }
+}
+
+
+// get a key as an unsigned int that sorts in the same order as the key. signed ints have the sign bit
+// flipped, and floats have all bits flipped if they are negative, otherwise just the sign bit.
+uint64 __radix_key(const char *a_elem, int a_key)
+{
+  // locals
+  uint32 key32;
+  uint64 key64;
+
+  switch (a_key)
+  {
+  case SORT_KEY_I32:
+    return *(const uint32 *) a_elem ^ 0x80000000;
+
+  case SORT_KEY_U32:
+    return *(const uint32 *) a_elem;
+
+  case SORT_KEY_F32:
+    key32 = *(const uint32 *) a_elem;
+    return key32 ^ ((key32 & 0x80000000) ? 0xffffffff : 0x80000000);
+
+  case SORT_KEY_I64:
+    return *(const uint64 *) a_elem ^ ((uint64) 1 << 63);
+
+  case SORT_KEY_U64:
+    return *(const uint64 *) a_elem;
+
+  default:
+    key64 = *(const uint64 *) a_elem;
+    return key64 ^ ((key64 >> 63) ? ~(uint64) 0 : (uint64) 1 << 63);
+  }
+}
+
+
+// get the index of the first element of one of a number of near equal parts
+size_t __split_start(size_t a_count, int a_parts, int a_part)
+{
+  return (size_t) (((uint64) a_count * a_part) / a_parts);
+}
+
+
+// swap two elements
+void __swap(char *a_left, char *a_right, size_t a_elemsize)
+{
+  // locals
+  char temp;
+  size_t i;
+
+  for (i = 0; i < a_elemsize; i++)
+  {
+    temp = a_left[i];
+    a_left[i] = a_right[i];
+    a_right[i] = temp;
+  }
+}
+
+
+// -- EOF
+
@@ -0,0 +1,69 @@
+
+#ifndef __h_sort
+#define __h_sort
+
+#ifdef  __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "config.h"
+
+// forward declarations
+typedef struct array;
+typedef struct vector;
+
+// the types of keys for the radix sorts
+#define SORT_KEY_I32  0   // a 32 bit signed int
+#define SORT_KEY_U32  1   // a 32 bit unsigned int
+#define SORT_KEY_I64  2   // a 64 bit signed int
+#define SORT_KEY_U64  3   // a 64 bit unsigned int
+#define SORT_KEY_F32  4   // a float, nans are sorted by their bits
+#define SORT_KEY_F64  5   // a double, nans are sorted by their bits
+
+// compare two elements, which is the same as the qsort compare function
+// a_left the first element to compare
+// a_right the second element to compare
+// returns less than 0 if a_left comes first, more than 0 if a_right comes first, otherwise 0
+typedef int (*sort_compare_func)(const void *a_left, const void *a_right);
+
+// the sorts are stable, and use the global thread pool to sort large arrays on all threads. they
+// allocate a buffer the size of the data from the global memory pool.
+
+// sort the elements in an array with a merge sort
+// a_array the array to sort
+// a_compare the function to compare the elements with
+#define array_sort(a_array, a_compare) _array_sort(a_array, a_compare)
+
+// sort the elements in a vector with a merge sort
+// a_vector the vector to sort
+// a_compare the function to compare the elements with
+#define vector_sort(a_vector, a_compare) _vector_sort(a_vector, a_compare)
+
+// sort the elements in an array by a key with a radix sort. the element can be just the key, or a
+// record with the key at an offset, in which case the whole record is moved with the key.
+// a_array the array to sort
+// a_key the type of the key, one of the SORT_KEY_ values
+// a_offset the offset of the key in each element in bytes
+#define array_radix_sort(a_array, a_key, a_offset) _array_radix_sort(a_array, a_key, a_offset)
+
+// sort the elements in a vector by a key with a radix sort. the element can be just the key, or a
+// record with the key at an offset, in which case the whole record is moved with the key.
+// a_vector the vector to sort
+// a_key the type of the key, one of the SORT_KEY_ values
+// a_offset the offset of the key in each element in bytes
+#define vector_radix_sort(a_vector, a_key, a_offset) _vector_radix_sort(a_vector, a_key, a_offset)
+
+// interface functions
+void _array_sort(struct array *a_array, sort_compare_func a_compare);
+void _vector_sort(struct vector *a_vector, sort_compare_func a_compare);
+void _array_radix_sort(struct array *a_array, int a_key, int a_offset);
+void _vector_radix_sort(struct vector *a_vector, int a_key, int a_offset);
+
+#ifdef  __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __h_sort
+
+// -- EOF
+
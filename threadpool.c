@@ -0,0 +1,253 @@
+
+#include "threadpool.h"
+
+#include <assert.h>
+#include <process.h>
+#include <stdlib.h>
+#include <windows.h>
+
+#include "memorypool.h"
+
+// structure for the thread pool
+struct threadpool
+{
+  struct memorypool *m_pool;  // the memory allocator
+  HANDLE *m_threads;          // the worker threads
+  int m_count;                // the number of worker threads (not including the calling thread)
+  HANDLE m_start;             // a semaphore that wakes a worker thread for each count released
+  HANDLE m_done;              // an event that is set when the last thread runs out of jobs
+  CRITICAL_SECTION m_lock;    // allows one run at a time when the pool is shared between threads
+  threadpool_func m_func;     // the function for the current run
+  void *m_context;            // the context for the current run
+  int m_jobs;                 // the number of jobs in the current run
+  volatile LONG m_next;       // the index of the next job to take
+  volatile LONG m_busy;       // the number of threads that are still taking jobs in the current run
+  volatile LONG m_quit;       // set when the worker threads should exit
+};
+
+// the global thread pool
+static struct threadpool *g_global_threadpool = 0;
+
+// set on the worker threads, and on the calling thread during a run, so nested runs are not queued
+// behind the run they are part of
+static __declspec(thread) int g_threadpool_depth = 0;
+
+
+unsigned __stdcall __threadpool_worker(void *a_param);
+void __threadpool_work(struct threadpool *a_threadpool);
+
+
+// allocate a thread pool
+struct threadpool *_threadpool_alloc(int a_threads, struct memorypool *a_pool, const char *a_file, int a_line)
+{
+  // locals
+  struct threadpool *ptr;
+  SYSTEM_INFO info;
+  int i;
+
+  // checks
+  assert(a_threads >= 0);
+
+  // use a thread for each cpu by default
+  if (a_threads == 0)
+  {
+    GetSystemInfo(&info);
+    a_threads = (int) info.dwNumberOfProcessors;
+  }
+
+  // allocate the thread pool structure memory
+  ptr = (struct threadpool *) _palloc(a_file, a_line, a_pool, sizeof(struct threadpool));
+  assert(ptr);
+
+  ptr->m_pool = a_pool;
+  ptr->m_count = max(a_threads - 1, 0);
+  ptr->m_threads = 0;
+  ptr->m_func = 0;
+  ptr->m_context = 0;
+  ptr->m_jobs = 0;
+  ptr->m_next = 0;
+  ptr->m_busy = 0;
+  ptr->m_quit = 0;
+
+  ptr->m_start = CreateSemaphoreA(0, 0, max(ptr->m_count, 1), 0);
+  ptr->m_done = CreateEventA(0, FALSE, FALSE, 0);
+  assert(ptr->m_start && ptr->m_done);
+  InitializeCriticalSection(&ptr->m_lock);
+
+  // start the worker threads, the calling thread is the last thread
+  if (ptr->m_count > 0)
+  {
+    ptr->m_threads = (HANDLE *) _palloc(a_file, a_line, a_pool, sizeof(HANDLE) * ptr->m_count);
+    assert(ptr->m_threads);
+
+    for (i = 0; i < ptr->m_count; i++)
+    {
+      ptr->m_threads[i] = (HANDLE) _beginthreadex(0, 0, __threadpool_worker, ptr, 0, 0);
+      assert(ptr->m_threads[i]);
+    }
+  }
+
+  // return a pointer to the thread pool
+  return ptr;
+}
+
+
+// free a thread pool
+void _threadpool_free(struct threadpool *a_threadpool)
+{
+  // locals
+  int i;
+
+  // checks
+  assert(a_threadpool);
+
+  if (a_threadpool == g_global_threadpool)
+  {
+    g_global_threadpool = 0;
+  }
+
+  // wake all the worker threads and wait for them to exit
+  if (a_threadpool->m_count > 0)
+  {
+    InterlockedExchange(&a_threadpool->m_quit, 1);
+    ReleaseSemaphore(a_threadpool->m_start, a_threadpool->m_count, 0);
+
+    for (i = 0; i < a_threadpool->m_count; i++)
+    {
+      WaitForSingleObject(a_threadpool->m_threads[i], INFINITE);
+      CloseHandle(a_threadpool->m_threads[i]);
+    }
+
+    pfree(a_threadpool->m_pool, a_threadpool->m_threads);
+  }
+
+  DeleteCriticalSection(&a_threadpool->m_lock);
+  CloseHandle(a_threadpool->m_done);
+  CloseHandle(a_threadpool->m_start);
+
+  pfree(a_threadpool->m_pool, a_threadpool);
+}
+
+
+// set the global thread pool
+void _threadpool_global(struct threadpool *a_threadpool)
+{
+  g_global_threadpool = a_threadpool;
+}
+
+
+// get the number of threads that run the jobs
+int _threadpool_threads(struct threadpool *a_threadpool)
+{
+  if (!a_threadpool)
+  {
+    a_threadpool = g_global_threadpool;
+  }
+
+  return a_threadpool ? a_threadpool->m_count + 1 : 1;
+}
+
+
+// run a number of jobs on the thread pool
+void _threadpool_run(struct threadpool *a_threadpool, threadpool_func a_func, void *a_context, int a_count)
+{
+  // locals
+  int i, wake;
+
+  // checks
+  assert(a_func);
+  assert(a_count >= 0);
+
+  if (!a_threadpool)
+  {
+    a_threadpool = g_global_threadpool;
+  }
+
+  // run the jobs on this thread if there are no other threads to run them on, or if this is a nested run
+  if (!a_threadpool || a_threadpool->m_count == 0 || a_count <= 1 || g_threadpool_depth)
+  {
+    for (i = 0; i < a_count; i++)
+    {
+      a_func(a_context, i);
+    }
+
+    return;
+  }
+
+  EnterCriticalSection(&a_threadpool->m_lock);
+
+  // only wake as many threads as there are jobs for, this thread takes jobs too
+  wake = min(a_count - 1, a_threadpool->m_count);
+
+  a_threadpool->m_func = a_func;
+  a_threadpool->m_context = a_context;
+  a_threadpool->m_jobs = a_count;
+  a_threadpool->m_next = 0;
+  a_threadpool->m_busy = wake + 1;
+
+  // releasing the semaphore is a full barrier, so the workers see the run set up above
+  ReleaseSemaphore(a_threadpool->m_start, wake, 0);
+
+  g_threadpool_depth++;
+  __threadpool_work(a_threadpool);
+  g_threadpool_depth--;
+
+  // wait for the jobs that are still running on the other threads
+  WaitForSingleObject(a_threadpool->m_done, INFINITE);
+
+  LeaveCriticalSection(&a_threadpool->m_lock);
+}
+
+
+// the entry point for the worker threads
+unsigned __stdcall __threadpool_worker(void *a_param)
+{
+  // locals
+  struct threadpool *threadpool;
+
+  threadpool = (struct threadpool *) a_param;
+  g_threadpool_depth = 1;
+
+  for (;;)
+  {
+    WaitForSingleObject(threadpool->m_start, INFINITE);
+
+    if (threadpool->m_quit)
+    {
+      break;
+    }
+
+    __threadpool_work(threadpool);
+  }
+
+  return 0;
+}
+
+
+// take jobs from the current run until there are none left
+void __threadpool_work(struct threadpool *a_threadpool)
+{
+  // locals
+  LONG index;
+
+  for (;;)
+  {
+    index = InterlockedIncrement(&a_threadpool->m_next) - 1;
+    if (index >= a_threadpool->m_jobs)
+    {
+      break;
+    }
+
+    a_threadpool->m_func(a_threadpool->m_context, (int) index);
+  }
+
+  // the last thread to run out of jobs wakes the calling thread
+  if (InterlockedDecrement(&a_threadpool->m_busy) == 0)
+  {
+    SetEvent(a_threadpool->m_done);
+  }
+}
+
+
+// -- EOF
+
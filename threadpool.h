@@ -0,0 +1,66 @@
+
+#ifndef __h_threadpool
+#define __h_threadpool
+
+#ifdef  __cplusplus
+extern "C" {
+#endif // __cplusplus
+
+#include "config.h"
+
+// forward declarations
+typedef struct threadpool;
+typedef struct memorypool;
+
+// the function that is called for each job in threadpool_run
+// a_context the context passed to threadpool_run
+// a_index the index of the job, from 0 to the job count
+typedef void (*threadpool_func)(void *a_context, int a_index);
+
+// allocate a pool of worker threads. the threads wait for work from threadpool_run and use no cpu
+// while they are idle.
+// a_threads the number of threads to run the jobs on (including the thread that calls threadpool_run),
+// or 0 to use one thread for each cpu
+// a_pool the memory pool to allocate from
+// returns the newly allocated thread pool
+#define threadpool_alloc(a_threads, a_pool) _threadpool_alloc(a_threads, a_pool, __FILE__, __LINE__)
+
+// stop the worker threads and free the thread pool
+// a_threadpool the thread pool to free
+#define threadpool_free(a_threadpool) _threadpool_free(a_threadpool)
+
+// set the global thread pool, which is used if 0 is specified as a thread pool. if there is no global
+// thread pool then the jobs are run on the calling thread.
+// a_threadpool the thread pool to use
+#define threadpool_global(a_threadpool) _threadpool_global(a_threadpool)
+
+// get the number of threads that run the jobs, including the thread that calls threadpool_run
+// a_threadpool the thread pool to operate on, otherwise the global thread pool is used if 0 is specified
+// returns the number of threads
+#define threadpool_threads(a_threadpool) _threadpool_threads(a_threadpool)
+
+// run a number of jobs on the thread pool and the calling thread, and wait for all of them to finish.
+// the jobs are taken in index order, but may finish in any order. calls from inside a job run the
+// jobs on the calling thread. memory pools are not thread safe, so jobs must not allocate from a pool
+// that another job uses.
+// a_threadpool the thread pool to operate on, otherwise the global thread pool is used if 0 is specified
+// a_func the function to call for each job
+// a_context the context to pass to each call
+// a_count the number of jobs to run
+#define threadpool_run(a_threadpool, a_func, a_context, a_count) _threadpool_run(a_threadpool, a_func, a_context, a_count)
+
+// interface functions
+struct threadpool *_threadpool_alloc(int a_threads, struct memorypool *a_pool, const char *a_file, int a_line);
+void _threadpool_free(struct threadpool *a_threadpool);
+void _threadpool_global(struct threadpool *a_threadpool);
+int _threadpool_threads(struct threadpool *a_threadpool);
+void _threadpool_run(struct threadpool *a_threadpool, threadpool_func a_func, void *a_context, int a_count);
+
+#ifdef  __cplusplus
+}
+#endif // __cplusplus
+
+#endif // __h_threadpool
+
+// -- EOF
+
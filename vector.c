@@ -15,34 +15,60 @@
 // structure for the vector
 struct vector
 {
-  int m_elemsize;             // the size of each element in the vector
-  int m_count;                // the number of elements in the vector
-  int m_capacity;             // the number of elements that can fit in the reserved memory
-  struct memorypool *m_pool;  // the memory allocator
-  void *m_data;               // a pointer to the vector data
+  VECTOR_FIELDS(void)
 };
+
+// the offset of the inline storage from the start of the vector, which keeps the elements aligned
+#define VECTOR_INLINE_OFFSET ((sizeof(struct vector) + 7) & ~7)
+
+// check if the elements of a vector are in its inline storage
+// a_vector the vector to check
+// returns non-zero if the elements are in the inline storage
+static inline int __vector_inline(struct vector *a_vector)
+{
+  return a_vector->m_inline && a_vector->m_data == a_vector->m_inline;
+}
   
 
 // allocate a new vector
-struct vector *_vector_alloc(int a_elemsize, struct memorypool *a_pool, const char *a_file, int a_line)
+struct vector *_vector_alloc(size_t a_elemsize, struct memorypool *a_pool, const char *a_file, int a_line)
+{
+  return _vector_alloc_inline(a_elemsize, 0, a_pool, a_file, a_line);
+}
+
+
+// allocate a new vector with inline storage
+struct vector *_vector_alloc_inline(size_t a_elemsize, size_t a_inline, struct memorypool *a_pool, const char *a_file, int a_line)
 {
   // locals
   struct vector *ptr;
 
   // checks
   assert(a_elemsize);
+  assert(psize(a_elemsize, a_inline) <= ((size_t) ~0) - VECTOR_INLINE_OFFSET);
 
-  // allocate the vector structure memory
-  ptr = (struct vector *) _palloc(a_file, a_line, a_pool, sizeof(struct vector));
+  // allocate the vector structure memory, followed by the inline storage
+  ptr = (struct vector *) _palloc(a_file, a_line, a_pool, VECTOR_INLINE_OFFSET + psize(a_elemsize, a_inline));
   assert(ptr);
 
   // set the default values
   memset(ptr, 0, sizeof(struct vector));
   ptr->m_elemsize = a_elemsize;
+  ptr->m_growth = VECTOR_GROWTH;
   ptr->m_pool = a_pool;
 
-  // reserve the initial capacity space
-  _vector_reserve(ptr, VECTOR_INITIAL_CAPACITY, a_file, a_line);
+  // use the inline storage, otherwise reserve the initial capacity space
+  if (a_inline)
+  {
+    ptr->m_inline = (char *) ptr + VECTOR_INLINE_OFFSET;
+    ptr->m_inlinecapacity = a_inline;
+    ptr->m_data = ptr->m_inline;
+    ptr->m_capacity = a_inline;
+  }
+  else
+  {
+    _vector_reserve(ptr, VECTOR_INITIAL_CAPACITY, a_file, a_line);
+  }
 
   // return the vector
   return ptr;
@@ -55,14 +81,18 @@ void _vector_free(struct vector *a_vector)
   // checks
   assert(a_vector);
 
-  // free the data and the vector
-  pfree(a_vector->m_pool, a_vector->m_data);
+  // free the data, which is 0 if the vector was shrunk while empty, and the vector
+  if (a_vector->m_data && !__vector_inline(a_vector))
+  {
+    pfree(a_vector->m_pool, a_vector->m_data);
+  }
+
   pfree(a_vector->m_pool, a_vector);
 }
 
 
 // reserve space for a number of elements
-void _vector_reserve(struct vector *a_vector, int a_capacity, const char *a_file, int a_line)
+void _vector_reserve(struct vector *a_vector, size_t a_capacity, const char *a_file, int a_line)
 {
   // locals
   void *ptr;
@@ -71,10 +101,27 @@ void _vector_reserve(struct vector *a_vector, int a_capacity, const char *a_file
   assert(a_vector);
   assert(a_capacity >= a_vector->m_count);
 
-  // reallocate the requested space, which results in the old data being copied to the new data if 
-  // the old data is not 0.
-  ptr = _prealloc(a_file, a_line, a_vector->m_pool, a_vector->m_data, a_vector->m_elemsize * a_capacity);
-  assert(ptr);
+  if (__vector_inline(a_vector))
+  {
+    // the inline storage is never released, so the capacity does not drop below it
+    if (a_capacity <= a_vector->m_inlinecapacity)
+    {
+      return;
+    }
+
+    // move the elements out of the inline storage
+    ptr = _palloc(a_file, a_line, a_vector->m_pool, psize(a_vector->m_elemsize, a_capacity));
+    assert(ptr);
+
+    memcpy(ptr, a_vector->m_data, a_vector->m_elemsize * a_vector->m_count);
+  }
+  else
+  {
+    // reallocate the requested space, which results in the old data being copied to the new data if 
+    // the old data is not 0.
+    ptr = _prealloc(a_file, a_line, a_vector->m_pool, a_vector->m_data, psize(a_vector->m_elemsize, a_capacity));
+    assert(ptr);
+  }
 
   // assign the data pointer and update the capacity
   a_vector->m_data = ptr;
@@ -83,15 +130,20 @@ void _vector_reserve(struct vector *a_vector, int a_capacity, const char *a_file
 
 
 // set the number of elements in the vector
-void _vector_resize(struct vector *a_vector, int a_count, const char *a_file, int a_line)
+void _vector_resize(struct vector *a_vector, size_t a_count, const char *a_file, int a_line)
 {
+  // locals
+  double capacity;
+
   // checks
   assert(a_vector);
   
-  // if the required number of elements is greater than the capacity then reserve enough space
+  // if the required number of elements is greater than the capacity then grow the capacity by the
+  // growth factor, or to the count if that is more
   if (a_count > a_vector->m_capacity)
   {
-    _vector_reserve(a_vector, a_count, a_file, a_line);
+    capacity = (double) a_vector->m_capacity * a_vector->m_growth;
+    _vector_reserve(a_vector, (capacity > a_count && capacity < (double) ((size_t) ~0)) ? (size_t) capacity : a_count, a_file, a_line);
   }
 
   // update the count
@@ -99,6 +151,63 @@ void _vector_resize(struct vector *a_vector, int a_count, const char *a_file, in
 }
 
 
+// release the reserved memory that is not used
+void _vector_shrink_to_fit(struct vector *a_vector, const char *a_file, int a_line)
+{
+  // locals
+  void *ptr;
+
+  // checks
+  assert(a_vector);
+
+  if (a_vector->m_capacity == a_vector->m_count || __vector_inline(a_vector))
+  {
+    return;
+  }
+
+  // move the elements back to the inline storage if they fit
+  if (a_vector->m_inline && a_vector->m_count <= a_vector->m_inlinecapacity)
+  {
+    memcpy(a_vector->m_inline, a_vector->m_data, a_vector->m_elemsize * a_vector->m_count);
+    pfree(a_vector->m_pool, a_vector->m_data);
+
+    a_vector->m_data = a_vector->m_inline;
+    a_vector->m_capacity = a_vector->m_inlinecapacity;
+    return;
+  }
+
+  // reallocating to a smaller size keeps the same memory, so the elements are copied to a new allocation
+  ptr = 0;
+
+  if (a_vector->m_count > 0)
+  {
+    ptr = _palloc(a_file, a_line, a_vector->m_pool, a_vector->m_elemsize * a_vector->m_count);
+    assert(ptr);
+
+    memcpy(ptr, a_vector->m_data, a_vector->m_elemsize * a_vector->m_count);
+  }
+
+  if (a_vector->m_data)
+  {
+    pfree(a_vector->m_pool, a_vector->m_data);
+  }
+
+  a_vector->m_data = ptr;
+  a_vector->m_capacity = a_vector->m_count;
+}
+
+
+// set the growth factor
+void _vector_set_growth(struct vector *a_vector, float a_growth)
+{
+  // checks
+  assert(a_vector);
+  assert(a_growth > 1.0f);
+
+  a_vector->m_growth = a_growth;
+}
+
+
 // null the memory of all used elements in the vector
 void _vector_zero(struct vector *a_vector)
 {
@@ -122,7 +231,7 @@ void *_vector_data(struct vector *a_vector)
 
 
 // get a pointer to a specific element in the vector
-void *_vector_index(struct vector *a_vector, int a_index)
+void *_vector_index(struct vector *a_vector, size_t a_index)
 {
   // locals
   char *ptr;
@@ -138,7 +247,7 @@ void *_vector_index(struct vector *a_vector, int a_index)
 
 
 // get the number of elements in the vector
-int _vector_count(struct vector *a_vector)
+size_t _vector_count(struct vector *a_vector)
 {
   // checks
   assert(a_vector);
@@ -149,7 +258,7 @@ int _vector_count(struct vector *a_vector)
 
 
 // get the number of elements tha could fit in the allocated space in the vector
-int _vector_capacity(struct vector *a_vector)
+size_t _vector_capacity(struct vector *a_vector)
 {
   // checks
   assert(a_vector);
@@ -160,7 +269,7 @@ int _vector_capacity(struct vector *a_vector)
 
 
 // get the size of each element in the vector
-int _vector_elemsize(struct vector *a_vector)
+size_t _vector_elemsize(struct vector *a_vector)
 {
   // checks
   assert(a_vector);
@@ -171,7 +280,7 @@ int _vector_elemsize(struct vector *a_vector)
 
 
 // append an element to the vector
-void *_vector_append(struct vector *a_vector, int a_count, const char *a_file, int a_line)
+void *_vector_append(struct vector *a_vector, size_t a_count, const char *a_file, int a_line)
 {
   // locals
   void *data;
@@ -179,6 +288,7 @@ void *_vector_append(struct vector *a_vector, int a_count, const char *a_file, i
   // checks
   assert(a_count > 0);
   assert(a_vector);
+  assert(a_count <= ((size_t) ~0) - a_vector->m_count);
 
   // resize (and possible reallocate) the vector to the requested size
   _vector_resize(a_vector, a_vector->m_count + a_count, a_file, a_line);
@@ -189,19 +299,142 @@ void *_vector_append(struct vector *a_vector, int a_count, const char *a_file, i
 }
 
 
-void *_vector_insert(struct vector *a_vector, int a_start, int a_count, const char *a_file, int a_line)
+// append copies of elements to the vector
+void _vector_push_n(struct vector *a_vector, const void *a_src, size_t a_count, const char *a_file, int a_line)
+{
+  // locals
+  size_t start;
+
+  // checks
+  assert(a_vector);
+  assert(a_src || !a_count);
+  assert(a_count <= ((size_t) ~0) - a_vector->m_count);
+
+  if (!a_count)
+  {
+    return;
+  }
+
+  // grow the vector once and copy all the elements after the current ones
+  start = a_vector->m_count;
+  _vector_resize(a_vector, start + a_count, a_file, a_line);
+
+  memcpy((char *) a_vector->m_data + a_vector->m_elemsize * start, a_src, a_vector->m_elemsize * a_count);
+}
+
+
+// append copies of the elements of another vector
+void _vector_extend(struct vector *a_dst, struct vector *a_src, const char *a_file, int a_line)
+{
+  // locals
+  size_t start, count;
+
+  // checks
+  assert(a_dst);
+  assert(a_src);
+  assert(a_dst->m_elemsize == a_src->m_elemsize);
+  assert(a_src->m_count <= ((size_t) ~0) - a_dst->m_count);
+
+  // the source data is read after the resize, as it moves if the source is the destination
+  start = a_dst->m_count;
+  count = a_src->m_count;
+
+  if (!count)
+  {
+    return;
+  }
+
+  _vector_resize(a_dst, start + count, a_file, a_line);
+
+  memcpy((char *) a_dst->m_data + a_dst->m_elemsize * start, a_src->m_data, a_dst->m_elemsize * count);
+}
+
+
+// replace the elements of the vector
+void _vector_assign(struct vector *a_vector, const void *a_src, size_t a_count, const char *a_file, int a_line)
+{
+  // checks
+  assert(a_vector);
+  assert(a_src || !a_count);
+
+  // the old elements are discarded, so release the memory rather than copy them to a larger allocation
+  if (a_count > a_vector->m_capacity && a_vector->m_data && !__vector_inline(a_vector))
+  {
+    pfree(a_vector->m_pool, a_vector->m_data);
+
+    a_vector->m_data = a_vector->m_inline;
+    a_vector->m_capacity = a_vector->m_inlinecapacity;
+  }
+
+  a_vector->m_count = 0;
+  _vector_resize(a_vector, a_count, a_file, a_line);
+
+  if (a_count)
+  {
+    memcpy(a_vector->m_data, a_src, a_vector->m_elemsize * a_count);
+  }
+}
+
+
+// append elements filled by a callback
+size_t _vector_append_from(struct vector *a_vector, vector_fill_func a_func, void *a_ctx, size_t a_chunk, const char *a_file, int a_line)
+{
+  // locals
+  size_t start, count, total;
+
+  // checks
+  assert(a_vector);
+  assert(a_func);
+  assert(a_chunk > 0);
+
+  total = 0;
+
+  do
+  {
+    // make space for a chunk and drop the part of it the callback did not fill
+    start = a_vector->m_count;
+    assert(a_chunk <= ((size_t) ~0) - start);
+    _vector_resize(a_vector, start + a_chunk, a_file, a_line);
+
+    count = a_func(a_ctx, (char *) a_vector->m_data + a_vector->m_elemsize * start, a_chunk);
+    assert(count <= a_chunk);
+
+    a_vector->m_count = start + count;
+    total += count;
+  }
+  while (count == a_chunk);
+
+  return total;
+}
+
+
+// copy a range of elements out of the vector
+void _vector_copy_range(struct vector *a_vector, size_t a_start, size_t a_count, void *a_dst)
+{
+  // checks
+  assert(a_vector);
+  assert(a_start <= a_vector->m_count && a_count <= a_vector->m_count - a_start);
+  assert(a_dst || !a_count);
+
+  if (a_count)
+  {
+    memcpy(a_dst, (char *) a_vector->m_data + a_vector->m_elemsize * a_start, a_vector->m_elemsize * a_count);
+  }
+}
+
+
+void *_vector_insert(struct vector *a_vector, size_t a_start, size_t a_count, const char *a_file, int a_line)
 {
   // locals
   void *src, *dst;
-  int movesize;
+  size_t movesize;
 
   // checks
   assert(a_count > 0);
-  assert(a_start >= 0);
   assert(a_vector);
   assert(a_vector->m_count > 0);
   assert(a_start < a_vector->m_count);
-  assert(a_start + a_count <= a_vector->m_count);
+  assert(a_count <= a_vector->m_count - a_start);
 
   // calculate the amount of memory after the insertion point
   movesize = a_vector->m_elemsize * (a_vector->m_count - a_start);
@@ -221,27 +454,26 @@ void *_vector_insert(struct vector *a_vector, int a_start, int a_count, const ch
 
 
 // remove elements from the vector
-void _vector_remove(struct vector *a_vector, int a_start, int a_count)
+void _vector_remove(struct vector *a_vector, size_t a_start, size_t a_count)
 {
   // locals
   void *src, *dst;
-  int movesize, src_idx, dst_idx;
+  size_t movesize, src_idx, dst_idx;
 
   // checks
   assert(a_count > 0);
-  assert(a_start >= 0);
   assert(a_vector);
   assert(a_vector->m_count > 0);
   assert(a_start < a_vector->m_count);
-  assert(a_start + a_count <= a_vector->m_count);
+  assert(a_count <= a_vector->m_count - a_start);
 
   // get the index of the elements after deletion range and the index to copy them to
   src_idx = a_start + a_count;
   dst_idx = a_start;
 
-  // get pointers for the indexes
-  src = vector_index(a_vector, src_idx);
-  dst = vector_index(a_vector, dst_idx);
+  // get pointers for the indexes, where the source is the end of the data when removing the last elements
+  src = (char *) a_vector->m_data + a_vector->m_elemsize * src_idx;
+  dst = (char *) a_vector->m_data + a_vector->m_elemsize * dst_idx;
 
   // calculate the size of the data to move
   movesize = a_vector->m_elemsize * (a_vector->m_count - src_idx);
@@ -254,5 +486,106 @@ void _vector_remove(struct vector *a_vector, int a_start, int a_count)
 }
 
 
+// remove the elements that match a predicate
+size_t _vector_remove_if(struct vector *a_vector, vector_predicate_func a_func, void *a_ctx)
+{
+  // locals
+  char *data;
+  size_t elemsize, count, read, write, start;
+
+  // checks
+  assert(a_vector);
+  assert(a_func);
+
+  data = (char *) a_vector->m_data;
+  elemsize = a_vector->m_elemsize;
+  count = a_vector->m_count;
+  write = 0;
+  start = 0;
+
+  // test each element exactly once, as the predicate may free or count the elements it removes. the
+  // run of kept elements before each removed element is moved down with one memmove, so every element
+  // moves at most once.
+  for (read = 0; read < count; read++)
+  {
+    if (a_func(a_ctx, data + elemsize * read))
+    {
+      if (write != start)
+      {
+        memmove(data + elemsize * write, data + elemsize * start, elemsize * (read - start));
+      }
+
+      write += read - start;
+      start = read + 1;
+    }
+  }
+
+  // move the run of kept elements after the last removed element
+  if (write != start)
+  {
+    memmove(data + elemsize * write, data + elemsize * start, elemsize * (count - start));
+  }
+
+  write += count - start;
+  a_vector->m_count = write;
+
+  return count - write;
+}
+
+
+// remove elements by index
+void _vector_remove_indices(struct vector *a_vector, const size_t *a_indices, size_t a_count)
+{
+  // locals
+  char *data;
+  size_t elemsize, i, start, end, count;
+
+  // checks
+  assert(a_vector);
+  assert(a_indices || !a_count);
+
+  if (!a_count)
+  {
+    return;
+  }
+
+  data = (char *) a_vector->m_data;
+  elemsize = a_vector->m_elemsize;
+  count = a_indices[0];
+
+  // move the run of kept elements after each removed index down over the removed ones
+  for (i = 0; i < a_count; i++)
+  {
+    assert(a_indices[i] < a_vector->m_count);
+    assert(i == 0 || a_indices[i] > a_indices[i - 1]);
+
+    start = a_indices[i] + 1;
+    end = (i + 1 < a_count) ? a_indices[i + 1] : a_vector->m_count;
+
+    memmove(data + elemsize * count, data + elemsize * start, elemsize * (end - start));
+    count += end - start;
+  }
+
+  a_vector->m_count = count;
+}
+
+
+// remove an element by replacing it with the last element
+void _vector_swap_remove(struct vector *a_vector, size_t a_index)
+{
+  // checks
+  assert(a_vector);
+  assert(a_index < a_vector->m_count);
+
+  a_vector->m_count--;
+
+  if (a_index != a_vector->m_count)
+  {
+    memcpy((char *) a_vector->m_data + a_vector->m_elemsize * a_index,
+      (char *) a_vector->m_data + a_vector->m_elemsize * a_vector->m_count, a_vector->m_elemsize);
+  }
+}
+
+
 // -- EOF
 
@@ -8,16 +8,145 @@ extern "C" {
 
 #include "config.h"
 
+#include <assert.h>
+
 // forward declarations
 typedef struct vector;
 typedef struct memorypool;
 
+// the fields of a vector, which are shared by struct vector and the typed vectors from VECTOR_DEFINE
+// a_type the element type
+#define VECTOR_FIELDS(a_type) \
+  size_t m_elemsize;          /* the size of each element in the vector */ \
+  size_t m_count;             /* the number of elements in the vector */ \
+  size_t m_capacity;          /* the number of elements that can fit in the reserved memory */ \
+  float m_growth;             /* the factor the capacity is multiplied by when the vector grows */ \
+  struct memorypool *m_pool;  /* the memory allocator */ \
+  a_type *m_data;             /* a pointer to the vector data */ \
+  a_type *m_inline;           /* the storage allocated with the vector, or 0 if it has none */ \
+  size_t m_inlinecapacity;    /* the number of elements that fit in the inline storage */
+
+// declare a typed vector, with inline functions that access the elements with the size of the type
+// known at compile time. the typed vector is a struct vector and can be used with the vector functions
+// through a_name_vector. allocations made through the typed functions are tracked against this line.
+// a_name the name of the typed vector struct, and the prefix for its functions
+// a_type the element type
+#define VECTOR_DEFINE(a_name, a_type) VECTOR_DEFINE_INLINE(a_name, a_type, 0)
+
+// declare a typed vector that stores its first elements in the same allocation as the vector, so a
+// small vector costs a single allocation. it behaves the same as a vector from VECTOR_DEFINE.
+// a_name the name of the typed vector struct, and the prefix for its functions
+// a_type the element type
+// a_inline the number of elements stored inline, or 0 for none
+#define VECTOR_DEFINE_INLINE(a_name, a_type, a_inline) \
+  struct a_name { VECTOR_FIELDS(a_type) }; \
+  \
+  static inline struct a_name *a_name##_alloc(struct memorypool *a_pool) \
+  { \
+    return (struct a_name *) _vector_alloc_inline(sizeof(a_type), a_inline, a_pool, __FILE__, __LINE__); \
+  } \
+  \
+  static inline void a_name##_free(struct a_name *a_vector) \
+  { \
+    _vector_free((struct vector *) a_vector); \
+  } \
+  \
+  static inline void a_name##_resize(struct a_name *a_vector, size_t a_count) \
+  { \
+    _vector_resize((struct vector *) a_vector, a_count, __FILE__, __LINE__); \
+  } \
+  \
+  static inline struct a_name *a_name##_cast(struct vector *a_vector) \
+  { \
+    assert(_vector_elemsize(a_vector) == sizeof(a_type)); \
+    return (struct a_name *) a_vector; \
+  } \
+  \
+  static inline struct vector *a_name##_vector(struct a_name *a_vector) \
+  { \
+    return (struct vector *) a_vector; \
+  } \
+  \
+  static inline size_t a_name##_count(struct a_name *a_vector) \
+  { \
+    return a_vector->m_count; \
+  } \
+  \
+  static inline size_t a_name##_capacity(struct a_name *a_vector) \
+  { \
+    return a_vector->m_capacity; \
+  } \
+  \
+  static inline a_type *a_name##_data(struct a_name *a_vector) \
+  { \
+    return a_vector->m_data; \
+  } \
+  \
+  static inline a_type *a_name##_index(struct a_name *a_vector, size_t a_index) \
+  { \
+    assert(a_index < a_vector->m_count); \
+    return a_vector->m_data + a_index; \
+  } \
+  \
+  static inline a_type a_name##_get(struct a_name *a_vector, size_t a_index) \
+  { \
+    assert(a_index < a_vector->m_count); \
+    return a_vector->m_data[a_index]; \
+  } \
+  \
+  static inline void a_name##_set(struct a_name *a_vector, size_t a_index, a_type a_value) \
+  { \
+    assert(a_index < a_vector->m_count); \
+    a_vector->m_data[a_index] = a_value; \
+  } \
+  \
+  static inline void a_name##_push(struct a_name *a_vector, a_type a_value) \
+  { \
+    if (a_vector->m_count < a_vector->m_capacity) \
+    { \
+      a_vector->m_data[a_vector->m_count++] = a_value; \
+    } \
+    else \
+    { \
+      *(a_type *) _vector_append((struct vector *) a_vector, 1, __FILE__, __LINE__) = a_value; \
+    } \
+  } \
+  \
+  static inline void a_name##_push_n(struct a_name *a_vector, const a_type *a_src, size_t a_count) \
+  { \
+    _vector_push_n((struct vector *) a_vector, a_src, a_count, __FILE__, __LINE__); \
+  }
+
+// fill elements appended to a vector by vector_append_from
+// a_ctx the context passed to vector_append_from
+// a_dst the memory for the elements to fill
+// a_count the number of elements that fit at a_dst
+// returns the number of elements filled, where less than a_count ends the append
+typedef size_t (*vector_fill_func)(void *a_ctx, void *a_dst, size_t a_count);
+
+// select elements for vector_remove_if to remove
+// a_ctx the context passed to vector_remove_if
+// a_elem the element to test
+// returns non-zero to remove the element
+typedef int (*vector_predicate_func)(void *a_ctx, const void *a_elem);
+
+// the factor the capacity of a vector is multiplied by when it grows, unless it is set with vector_set_growth
+#define VECTOR_GROWTH 2.0f
+
 // allocate a new vector
 // a_elemsize the size of each element in the vector
 // a_pool the memory pool to allocate from
 // returns the newly allocated vector
 #define vector_alloc(a_elemsize, a_pool) _vector_alloc(a_elemsize, a_pool, __FILE__, __LINE__)
 
+// allocate a new vector that stores its first elements inline, in the same allocation as the vector.
+// the elements move to memory from the pool when the vector grows past the inline capacity.
+// a_elemsize the size of each element in the vector
+// a_inline the number of elements to store inline, or 0 to allocate the elements separately
+// a_pool the memory pool to allocate from
+// returns the newly allocated vector
+#define vector_alloc_inline(a_elemsize, a_inline, a_pool) _vector_alloc_inline(a_elemsize, a_inline, a_pool, __FILE__, __LINE__)
+
 // free the vector and all allocated memory
 // a_vector the vector to operate on
 #define vector_free(a_vector) _vector_free(a_vector)
@@ -27,7 +156,18 @@ typedef struct memorypool;
 // a_capacity the number of elements to reserve memory for
 #define vector_reserve(a_vector, a_capacity) _vector_reserve(a_vector, a_capacity, __FILE__, __LINE__)
 
-// resize the vector
+// release the reserved memory that is not used by the elements, moving them back to the inline storage
+// if they fit
+// a_vector the vector to operate on
+#define vector_shrink_to_fit(a_vector) _vector_shrink_to_fit(a_vector, __FILE__, __LINE__)
+
+// set the factor the capacity is multiplied by when the vector grows past its capacity, so that adding
+// elements one at a time takes amortised constant time
+// a_vector the vector to operate on
+// a_growth the growth factor, which must be more than 1
+#define vector_set_growth(a_vector, a_growth) _vector_set_growth(a_vector, a_growth)
+
+// resize the vector, growing the capacity by the growth factor if the count does not fit
 // a_vector the vector to operate on
 // a_count the number of elements to insert into the vector
 #define vector_resize(a_vector, a_count) _vector_resize(a_vector, a_count, __FILE__, __LINE__)
@@ -57,6 +197,38 @@ typedef struct memorypool;
 // returns a pointer to the memory at start of the first element
 #define vector_append(a_vector, a_count) _vector_append(a_vector, a_count, __FILE__, __LINE__)
 
+// append copies of elements to the end of the vector
+// a_vector the vector to operate on
+// a_src the elements to copy, which must not be in the vector
+// a_count the number of elements to copy
+#define vector_push_n(a_vector, a_src, a_count) _vector_push_n(a_vector, a_src, a_count, __FILE__, __LINE__)
+
+// append copies of all elements of a vector to the end of another vector
+// a_dst the vector to append to
+// a_src the vector to copy the elements from, which can be a_dst
+#define vector_extend(a_dst, a_src) _vector_extend(a_dst, a_src, __FILE__, __LINE__)
+
+// replace the elements of the vector with copies of other elements
+// a_vector the vector to operate on
+// a_src the elements to copy, which must not be in the vector
+// a_count the number of elements to copy
+#define vector_assign(a_vector, a_src, a_count) _vector_assign(a_vector, a_src, a_count, __FILE__, __LINE__)
+
+// append elements filled by a callback, a chunk at a time, until the callback fills less than a chunk
+// a_vector the vector to operate on
+// a_func the function that fills each chunk
+// a_ctx the context to pass to a_func
+// a_chunk the number of elements to ask a_func to fill at a time
+// returns the number of elements appended
+#define vector_append_from(a_vector, a_func, a_ctx, a_chunk) _vector_append_from(a_vector, a_func, a_ctx, a_chunk, __FILE__, __LINE__)
+
+// copy a range of elements out of the vector
+// a_vector the vector to operate on
+// a_start the index of the first element to copy
+// a_count the number of elements to copy
+// a_dst the memory to copy the elements to
+#define vector_copy_range(a_vector, a_start, a_count, a_dst) _vector_copy_range(a_vector, a_start, a_count, a_dst)
+
 // insert an element into the vector
 // a_vector the vector to operate on
 // a_start the index to insert the elements after in the vector
@@ -70,6 +242,24 @@ typedef struct memorypool;
 // a_count the number of elements to remove
 #define vector_remove(a_vector, a_start, a_count) _vector_remove(a_vector, a_start, a_count)
 
+// removes the elements that match a predicate in a single pass, keeping the order of the other elements
+// a_vector the vector to operate on
+// a_func the predicate that selects the elements to remove
+// a_ctx the context to pass to a_func
+// returns the number of elements removed
+#define vector_remove_if(a_vector, a_func, a_ctx) _vector_remove_if(a_vector, a_func, a_ctx)
+
+// removes elements by index in a single pass, keeping the order of the other elements
+// a_vector the vector to operate on
+// a_indices the indices of the elements to remove, in ascending order without duplicates
+// a_count the number of indices
+#define vector_remove_indices(a_vector, a_indices, a_count) _vector_remove_indices(a_vector, a_indices, a_count)
+
+// removes an element by moving the last element into its place, which does not keep the order
+// a_vector the vector to operate on
+// a_index the index of the element to remove
+#define vector_swap_remove(a_vector, a_index) _vector_swap_remove(a_vector, a_index)
+
 // gets a pointer to the memory for the vector
 // a_vector the vector to operate on
 // returns a pointer to the first element
@@ -82,19 +272,30 @@ typedef struct memorypool;
 #define vector_index(a_vector, a_index) _vector_index(a_vector, a_index)
 
 // interface functions
-struct vector *_vector_alloc(int a_elemsize, struct memorypool *a_pool, const char *a_file, int a_line);
+struct vector *_vector_alloc(size_t a_elemsize, struct memorypool *a_pool, const char *a_file, int a_line);
+struct vector *_vector_alloc_inline(size_t a_elemsize, size_t a_inline, struct memorypool *a_pool, const char *a_file, int a_line);
 void _vector_free(struct vector *a_vector);
-void _vector_reserve(struct vector *a_vector, int a_capacity, const char *a_file, int a_line);
-void _vector_resize(struct vector *a_vector, int a_count, const char *a_file, int a_line);
-int _vector_count(struct vector *a_vector);
-int _vector_capacity(struct vector *a_vector);
-int _vector_elemsize(struct vector *a_vector);
+void _vector_reserve(struct vector *a_vector, size_t a_capacity, const char *a_file, int a_line);
+void _vector_shrink_to_fit(struct vector *a_vector, const char *a_file, int a_line);
+void _vector_set_growth(struct vector *a_vector, float a_growth);
+void _vector_resize(struct vector *a_vector, size_t a_count, const char *a_file, int a_line);
+size_t _vector_count(struct vector *a_vector);
+size_t _vector_capacity(struct vector *a_vector);
+size_t _vector_elemsize(struct vector *a_vector);
 void _vector_zero(struct vector *a_vector);
-void *_vector_append(struct vector *a_vector, int a_count, const char *a_file, int a_line);
-void *_vector_insert(struct vector *a_vector, int a_start, int a_count, const char *a_file, int a_line);
-void _vector_remove(struct vector *a_vector, int a_start, int a_count);
+void *_vector_append(struct vector *a_vector, size_t a_count, const char *a_file, int a_line);
+void _vector_push_n(struct vector *a_vector, const void *a_src, size_t a_count, const char *a_file, int a_line);
+void _vector_extend(struct vector *a_dst, struct vector *a_src, const char *a_file, int a_line);
+void _vector_assign(struct vector *a_vector, const void *a_src, size_t a_count, const char *a_file, int a_line);
+size_t _vector_append_from(struct vector *a_vector, vector_fill_func a_func, void *a_ctx, size_t a_chunk, const char *a_file, int a_line);
+void _vector_copy_range(struct vector *a_vector, size_t a_start, size_t a_count, void *a_dst);
+void *_vector_insert(struct vector *a_vector, size_t a_start, size_t a_count, const char *a_file, int a_line);
+void _vector_remove(struct vector *a_vector, size_t a_start, size_t a_count);
+size_t _vector_remove_if(struct vector *a_vector, vector_predicate_func a_func, void *a_ctx);
+void _vector_remove_indices(struct vector *a_vector, const size_t *a_indices, size_t a_count);
+void _vector_swap_remove(struct vector *a_vector, size_t a_index);
 void *_vector_data(struct vector *a_vector);
-void *_vector_index(struct vector *a_vector, int a_index);
+void *_vector_index(struct vector *a_vector, size_t a_index);
 
 #ifdef  __cplusplus
 }